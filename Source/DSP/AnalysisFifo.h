@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// Wait-free single-producer/single-consumer ring of samples for analysis on another
+// thread. The audio thread pushes; the reader pops whatever has arrived. A full ring drops
+// the newest samples rather than blocking, so a reader that falls behind loses audio, never
+// the audio thread.
+class AnalysisFifo
+{
+public:
+    static constexpr juce::uint32 capacity = 8192; // power of two
+
+    // Producer side. Returns how many samples fitted.
+    int push (const float* samples, int numSamples) noexcept
+    {
+        const auto write = writeIndex.load (std::memory_order_relaxed);
+        const auto space = capacity - (write - readIndex.load (std::memory_order_acquire));
+        const auto count = juce::jmin (static_cast<juce::uint32> (juce::jmax (0, numSamples)), space);
+
+        for (juce::uint32 i = 0; i < count; ++i)
+            buffer[(write + i) & (capacity - 1)] = samples[i];
+
+        writeIndex.store (write + count, std::memory_order_release);
+        return static_cast<int> (count);
+    }
+
+    // Consumer side. Copies up to maxSamples of the oldest pending samples.
+    int pop (float* destination, int maxSamples) noexcept
+    {
+        const auto read = readIndex.load (std::memory_order_relaxed);
+        const auto available = writeIndex.load (std::memory_order_acquire) - read;
+        const auto count = juce::jmin (static_cast<juce::uint32> (juce::jmax (0, maxSamples)), available);
+
+        for (juce::uint32 i = 0; i < count; ++i)
+            destination[i] = buffer[(read + i) & (capacity - 1)];
+
+        readIndex.store (read + count, std::memory_order_release);
+        return static_cast<int> (count);
+    }
+
+    // Consumer side: forgets everything pending, e.g. when a new reader attaches.
+    void discardPending() noexcept
+    {
+        readIndex.store (writeIndex.load (std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    static_assert ((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+    std::array<float, capacity> buffer {};
+    alignas (64) std::atomic<juce::uint32> writeIndex { 0 };
+    alignas (64) std::atomic<juce::uint32> readIndex { 0 };
+};
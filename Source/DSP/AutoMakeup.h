@@ -0,0 +1,95 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+// Slow makeup gain that tracks the average gain reduction. Updated every
+// controlIntervalSamples on an interval counter that carries across blocks, and ramped
+// linearly between updates, so the gain for any sample depends only on the signal and
+// never on how the host happens to split it into blocks.
+class AutoMakeup
+{
+public:
+    void prepare (double newSampleRate)
+    {
+        const auto sampleRate = juce::jmax (1.0, newSampleRate);
+        const auto intervalSeconds = static_cast<double> (controlIntervalSamples) / sampleRate;
+
+        const auto coeffForSeconds = [intervalSeconds] (double tauSeconds)
+        {
+            return static_cast<float> (std::exp (-intervalSeconds / tauSeconds));
+        };
+
+        grAttackCoeff = coeffForSeconds (0.005);
+        grReleaseCoeff = coeffForSeconds (0.4);
+        averageAttackCoeff = coeffForSeconds (0.8);
+        averageReleaseCoeff = coeffForSeconds (1.8);
+        appliedCoeff = coeffForSeconds (1.2);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        grBallisticsDb = 0.0f;
+        averageGrDb = 0.0f;
+        appliedDb = 0.0f;
+        gain = 1.0f;
+        gainIncrement = 0.0f;
+        samplesUntilUpdate = 0;
+    }
+
+    // gainReductionDb is the compressor's envelope for this sample (positive dB).
+    // Returns the linear makeup gain for the same sample.
+    float processSample (float gainReductionDb) noexcept
+    {
+        if (--samplesUntilUpdate < 0)
+        {
+            update (juce::jmax (0.0f, gainReductionDb));
+            samplesUntilUpdate = controlIntervalSamples - 1;
+        }
+
+        gain += gainIncrement;
+        return gain;
+    }
+
+    float getAppliedDb() const noexcept
+    {
+        return appliedDb;
+    }
+
+private:
+    void update (float gainReductionDb) noexcept
+    {
+        // Same chain the block-rate version ran: GR meter ballistics (5 / 400 ms), an
+        // asymmetric average (0.8 / 1.8 s), 72% compensation capped at 18 dB, then a
+        // 1.2 s glide.
+        const auto grCoeff = gainReductionDb > grBallisticsDb ? grAttackCoeff : grReleaseCoeff;
+        grBallisticsDb = grCoeff * grBallisticsDb + (1.0f - grCoeff) * gainReductionDb;
+
+        const auto averageCoeff = grBallisticsDb > averageGrDb ? averageAttackCoeff : averageReleaseCoeff;
+        averageGrDb = averageCoeff * averageGrDb + (1.0f - averageCoeff) * grBallisticsDb;
+
+        constexpr auto compensationRatio = 0.72f;
+        const auto targetDb = juce::jlimit (0.0f, 18.0f, averageGrDb * compensationRatio);
+        appliedDb = appliedCoeff * appliedDb + (1.0f - appliedCoeff) * targetDb;
+
+        const auto nextGain = juce::Decibels::decibelsToGain (appliedDb);
+        gainIncrement = (nextGain - gain) / static_cast<float> (controlIntervalSamples);
+    }
+
+    static constexpr int controlIntervalSamples = 32;
+
+    float grAttackCoeff = 0.0f;
+    float grReleaseCoeff = 0.0f;
+    float averageAttackCoeff = 0.0f;
+    float averageReleaseCoeff = 0.0f;
+    float appliedCoeff = 0.0f;
+
+    float grBallisticsDb = 0.0f;
+    float averageGrDb = 0.0f;
+    float appliedDb = 0.0f;
+    float gain = 1.0f;
+    float gainIncrement = 0.0f;
+    int samplesUntilUpdate = 0;
+};
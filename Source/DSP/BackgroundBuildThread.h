@@ -0,0 +1,23 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// One low-priority worker shared by every instance in the process (via
+// juce::SharedResourcePointer). Instances register a TimeSliceClient that builds any
+// expensive DSP objects they have been asked for and frees the ones they retired.
+class BackgroundBuildThread : public juce::TimeSliceThread
+{
+public:
+    BackgroundBuildThread()
+        : juce::TimeSliceThread ("2C-Compressor DSP builder")
+    {
+        startThread (juce::Thread::Priority::low);
+    }
+
+    ~BackgroundBuildThread() override
+    {
+        stopThread (2000);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BackgroundBuildThread)
+};
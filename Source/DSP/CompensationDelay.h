@@ -0,0 +1,125 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+
+#include "ScratchArena.h"
+
+// Plain multichannel delay that lines the dry signal up with the processor's reported
+// latency, so bypassing never shifts the track against its neighbours. The ring lives in
+// the scratch arena; a delay of zero makes every call a no-op.
+class CompensationDelay
+{
+public:
+    // Reserves room for up to maxDelaySamples; attachScratch() follows once the arena has
+    // been allocated.
+    void prepare (int newNumChannels, int maxDelaySamples, ScratchArena& arena)
+    {
+        numChannels = juce::jlimit (1, ScratchArena::maxChannels, newNumChannels);
+        maxDelay = juce::jmax (0, maxDelaySamples);
+        ringRegion = arena.reserveChannels (numChannels, maxDelay);
+    }
+
+    void attachScratch (const ScratchArena& arena)
+    {
+        arena.referTo (ring, ringRegion, numChannels, maxDelay);
+        delaySamples = juce::jmin (delaySamples, maxDelay);
+        reset();
+    }
+
+    // Changing the delay restarts the line from silence.
+    void setDelay (int newDelaySamples) noexcept
+    {
+        const auto clamped = juce::jlimit (0, maxDelay, newDelaySamples);
+
+        if (clamped == delaySamples)
+            return;
+
+        delaySamples = clamped;
+        reset();
+    }
+
+    int getDelay() const noexcept
+    {
+        return delaySamples;
+    }
+
+    void reset() noexcept
+    {
+        ring.clear();
+        position = 0;
+    }
+
+    // Replaces the buffer's contents with themselves delayed.
+    void process (juce::AudioBuffer<float>& buffer, int channelsToProcess) noexcept
+    {
+        if (delaySamples <= 0)
+            return;
+
+        const auto channels = juce::jmin (channelsToProcess, numChannels, buffer.getNumChannels());
+        const auto numSamples = buffer.getNumSamples();
+        auto endPosition = position;
+
+        for (auto channel = 0; channel < channels; ++channel)
+        {
+            auto* data = buffer.getWritePointer (channel);
+            auto* delayed = ring.getWritePointer (channel);
+            auto channelPosition = position;
+            auto done = 0;
+
+            while (done < numSamples)
+            {
+                const auto chunk = juce::jmin (numSamples - done, delaySamples - channelPosition);
+                std::swap_ranges (delayed + channelPosition, delayed + channelPosition + chunk, data + done);
+                done += chunk;
+                channelPosition = channelPosition + chunk < delaySamples ? channelPosition + chunk : 0;
+            }
+
+            endPosition = channelPosition;
+        }
+
+        position = endPosition;
+    }
+
+    // Feeds the line without producing output, leaving it exactly as process() would.
+    // Only the last delaySamples of the block are written.
+    void push (const juce::AudioBuffer<float>& buffer, int channelsToProcess) noexcept
+    {
+        if (delaySamples <= 0)
+            return;
+
+        const auto channels = juce::jmin (channelsToProcess, numChannels, buffer.getNumChannels());
+        const auto numSamples = buffer.getNumSamples();
+        const auto skipped = juce::jmax (0, numSamples - delaySamples);
+        const auto startPosition = (position + skipped) % delaySamples;
+        auto endPosition = startPosition;
+
+        for (auto channel = 0; channel < channels; ++channel)
+        {
+            const auto* input = buffer.getReadPointer (channel);
+            auto* delayed = ring.getWritePointer (channel);
+            auto channelPosition = startPosition;
+            auto done = skipped;
+
+            while (done < numSamples)
+            {
+                const auto chunk = juce::jmin (numSamples - done, delaySamples - channelPosition);
+                std::copy (input + done, input + done + chunk, delayed + channelPosition);
+                done += chunk;
+                channelPosition = channelPosition + chunk < delaySamples ? channelPosition + chunk : 0;
+            }
+
+            endPosition = channelPosition;
+        }
+
+        position = endPosition;
+    }
+
+private:
+    juce::AudioBuffer<float> ring;
+    ScratchArena::Region ringRegion;
+    int numChannels = 1;
+    int maxDelay = 0;
+    int delaySamples = 0;
+    int position = 0;
+};
@@ -3,7 +3,9 @@
 #include <JuceHeader.h>
 #include <array>
 #include <cmath>
+#include <limits>
 
+#include "AutoMakeup.h"
 #include "MeterBallistics.h"
 
 class CompressorDSP
@@ -34,6 +36,7 @@ public:
         float scHpfHz = 0.0f;
         bool scHpfEnabled = true;
         float kneeDb = 6.0f;
+        bool autoMakeup = false;
     };
 
     void init (double newSampleRate, int /*maxBlockSize*/)
@@ -41,6 +44,7 @@ public:
         sampleRate = juce::jmax (1.0, newSampleRate);
         reset();
         grMeterBallistics.prepare (sampleRate, 5.0f, 400.0f);
+        autoMakeup.prepare (sampleRate);
         updateTimeConstants();
         updateDetectorHpfConfig();
     }
@@ -52,16 +56,29 @@ public:
         hpfPrevOutput.fill (0.0f);
 
         gainReductionEnvelopeDb = 0.0f;
+        targetGainLinear = 1.0f;
         smoothedGainLinear = 1.0f;
+        samplesUntilControlUpdate = 0;
         lastGainReductionDb = 0.0f;
+        lastMinGainReductionDb = 0.0f;
+        lastBlockDetectorDb = -120.0f;
         grMeterBallistics.reset (0.0f);
         meterGainReductionDb = 0.0f;
+        autoMakeup.reset();
 
+        // setParameters() only touches the HPF when its settings change, so snap the
+        // coefficient back onto its target here.
         hpfCurrentAlpha = 0.0f;
+        updateDetectorHpfConfig();
     }
 
     void setParameters (const Parameters& newParameters)
     {
+        // Switching auto makeup on glides up from 0 dB rather than resuming a stale value.
+        if (newParameters.autoMakeup && ! parameters.autoMakeup)
+            autoMakeup.reset();
+
+        const auto previous = parameters;
         parameters = newParameters;
         parameters.ratio = juce::jmax (1.0f, parameters.ratio);
         parameters.timingMode = juce::jlimit (0, 3, parameters.timingMode);
@@ -71,8 +88,16 @@ public:
         parameters.kneeDb = juce::jmax (0.0f, parameters.kneeDb);
         parameters.scHpfHz = parameters.scHpfHz <= 0.0f ? 0.0f : juce::jlimit (20.0f, 250.0f, parameters.scHpfHz);
 
-        updateTimeConstants();
-        updateDetectorHpfConfig();
+        // Coefficients are only rebuilt from the inputs that feed them, so a threshold
+        // sweep or a preset morph that leaves the times alone costs no exp() calls.
+        if (parameters.timingMode != previous.timingMode
+            || parameters.characterMode != previous.characterMode
+            || parameters.attackMs != previous.attackMs
+            || parameters.releaseMs != previous.releaseMs)
+            updateTimeConstants();
+
+        if (parameters.scHpfEnabled != previous.scHpfEnabled || parameters.scHpfHz != previous.scHpfHz)
+            updateDetectorHpfConfig();
     }
 
     void processBlock (juce::AudioBuffer<float>& buffer)
@@ -83,18 +108,21 @@ public:
         if (numChannels <= 0 || numSamples <= 0)
         {
             lastGainReductionDb = 0.0f;
+            lastMinGainReductionDb = 0.0f;
             return;
         }
 
         const auto useDetectorHpf = detectorHpfEnabled;
         auto peakGainReductionInBlock = 0.0f;
+        auto minGainReductionInBlock = std::numeric_limits<float>::max();
+        auto peakLinkedState = 0.0f;
 
         for (auto sample = 0; sample < numSamples; ++sample)
         {
             if (useDetectorHpf)
                 hpfCurrentAlpha = hpfCoeffSmoothingCoeff * hpfCurrentAlpha + (1.0f - hpfCoeffSmoothingCoeff) * hpfTargetAlpha;
 
-            auto linkedRms = 0.0f;
+            auto linkedState = 0.0f;
 
             for (auto channel = 0; channel < numChannels; ++channel)
             {
@@ -116,80 +144,75 @@ public:
                 auto& state = rmsState[static_cast<size_t> (channel)];
                 state = rmsCoeff * state + (1.0f - rmsCoeff) * squared;
 
-                linkedRms = juce::jmax (linkedRms, std::sqrt (state));
+                linkedState = juce::jmax (linkedState, state);
             }
 
-            const auto detectorDb = juce::Decibels::gainToDecibels (linkedRms, -120.0f);
-            const auto targetGainReductionDb = computeGainReductionDb (detectorDb);
-
-            float grCoeff = attackCoeff;
+            peakLinkedState = juce::jmax (peakLinkedState, linkedState);
 
-            if (targetGainReductionDb <= gainReductionEnvelopeDb)
+            // The level-to-gain chain runs every controlInterval samples; in between, the
+            // envelope holds and the 2 ms gain smoother interpolates.
+            if (--samplesUntilControlUpdate < 0)
             {
-                auto releaseBlend = smoothstep ((gainReductionEnvelopeDb - smallGrDb) / (largeGrDb - smallGrDb));
+                samplesUntilControlUpdate = controlInterval - 1;
 
-                if (parameters.characterMode == Parameters::opto)
-                {
-                    // Keep faster recovery at high GR while extending the tail for smoother leveling.
-                    releaseBlend = std::pow (releaseBlend, optoReleaseTailPower);
-                }
+                const auto detectorDb = juce::jmax (juce::Decibels::gainToDecibels (std::sqrt (linkedState), -120.0f),
+                                                    externalDetectorDb);
+                const auto targetGainReductionDb = computeGainReductionDb (parameters, detectorDb);
 
-                grCoeff = juce::jmap (releaseBlend, releaseSlowCoeff, releaseFastCoeff);
+                const auto grCoeff = getEnvelopeCoeff (targetGainReductionDb, controlInterval > 1 ? controlRateCoeffs : sampleRateCoeffs);
+                gainReductionEnvelopeDb = grCoeff * gainReductionEnvelopeDb + (1.0f - grCoeff) * targetGainReductionDb;
+                targetGainLinear = juce::Decibels::decibelsToGain (-gainReductionEnvelopeDb);
             }
 
-            gainReductionEnvelopeDb = grCoeff * gainReductionEnvelopeDb + (1.0f - grCoeff) * targetGainReductionDb;
-            meterGainReductionDb = grMeterBallistics.processSample (gainReductionEnvelopeDb);
+            if (meteringEnabled)
+                meterGainReductionDb = grMeterBallistics.processSample (gainReductionEnvelopeDb);
 
-            const auto targetGainLinear = juce::Decibels::decibelsToGain (-gainReductionEnvelopeDb);
             smoothedGainLinear = gainSmoothCoeff * smoothedGainLinear + (1.0f - gainSmoothCoeff) * targetGainLinear;
 
+            const auto makeupGain = parameters.autoMakeup ? autoMakeup.processSample (gainReductionEnvelopeDb) : 1.0f;
+            const auto outputGain = smoothedGainLinear * makeupGain;
+
             for (auto channel = 0; channel < numChannels; ++channel)
-                buffer.setSample (channel, sample, buffer.getSample (channel, sample) * smoothedGainLinear);
+                buffer.setSample (channel, sample, buffer.getSample (channel, sample) * outputGain);
 
             peakGainReductionInBlock = juce::jmax (peakGainReductionInBlock, gainReductionEnvelopeDb);
+            minGainReductionInBlock = juce::jmin (minGainReductionInBlock, gainReductionEnvelopeDb);
         }
 
         lastGainReductionDb = juce::jmax (0.0f, peakGainReductionInBlock);
+        lastMinGainReductionDb = juce::jmax (0.0f, minGainReductionInBlock);
+        lastBlockDetectorDb = juce::Decibels::gainToDecibels (std::sqrt (peakLinkedState), -120.0f);
     }
 
-    float getLastGainReductionDb() const noexcept
+    // Detector level (dB) from outside this instance, e.g. a link group; the gain computer
+    // follows whichever of it and the own detector is higher. -120 means none.
+    void setExternalDetectorLevelDb (float levelDb) noexcept
     {
-        return lastGainReductionDb;
+        externalDetectorDb = levelDb;
     }
 
-    float getMeterGainReductionDb() const noexcept
+    // Peak of the instance's own detector over the last processed block.
+    float getLastBlockDetectorDb() const noexcept
     {
-        return meterGainReductionDb;
+        return lastBlockDetectorDb;
     }
 
-private:
-    static float coefficientFromMs (float timeMs, double sr)
+    // What the gain computer saw at its peak last block: the own detector or the link
+    // group's level, whichever was higher.
+    float getLastBlockGainComputerInputDb() const noexcept
     {
-        const auto seconds = juce::jmax (0.00001, static_cast<double> (timeMs) * 0.001);
-        return std::exp (-1.0f / static_cast<float> (seconds * sr));
-    }
-
-    static float smoothstep (float x) noexcept
-    {
-        const auto t = juce::jlimit (0.0f, 1.0f, x);
-        return t * t * (3.0f - 2.0f * t);
+        return juce::jmax (lastBlockDetectorDb, externalDetectorDb);
     }
 
-    static float makeHpfAlpha (float cutoffHz, double sr)
+    // The static curve: gain reduction (dB, positive) for a detector level, from threshold,
+    // ratio and knee, with Opto's wider knee. Shared with the editor's transfer curve.
+    static float computeGainReductionDb (const Parameters& settings, float inputDb) noexcept
     {
-        const auto freq = juce::jlimit (20.0f, 250.0f, cutoffHz);
-        const auto dt = 1.0 / sr;
-        const auto rc = 1.0 / (2.0 * juce::MathConstants<double>::pi * static_cast<double> (freq));
-        return static_cast<float> (rc / (rc + dt));
-    }
+        const auto threshold = settings.thresholdDb;
+        const auto ratio = juce::jmax (1.0f, settings.ratio);
+        auto knee = juce::jmax (0.0f, settings.kneeDb);
 
-    float computeGainReductionDb (float inputDb) const
-    {
-        const auto threshold = parameters.thresholdDb;
-        const auto ratio = juce::jmax (1.0f, parameters.ratio);
-        auto knee = juce::jmax (0.0f, parameters.kneeDb);
-
-        if (parameters.characterMode == Parameters::opto)
+        if (settings.characterMode == Parameters::opto)
             knee = juce::jlimit (0.0f, 12.0f, knee + 2.0f);
 
         auto outputDb = inputDb;
@@ -223,6 +246,137 @@ private:
         return juce::jmax (0.0f, inputDb - outputDb);
     }
 
+    // Stand-in for processBlock while the plugin is bypassed: moves the detector and the
+    // envelope across the whole block in closed form from its mean power (the detector HPF
+    // is skipped), so the gain is close to right when processing resumes. The audio is
+    // left untouched; inputGain is the trim the wet path would have applied.
+    void trackIdle (const juce::AudioBuffer<float>& buffer, float inputGain) noexcept
+    {
+        const auto numChannels = juce::jmin (2, buffer.getNumChannels());
+        const auto numSamples = buffer.getNumSamples();
+
+        if (numChannels <= 0 || numSamples <= 0)
+            return;
+
+        const auto blockLength = static_cast<float> (numSamples);
+        const auto rmsDecay = std::pow (rmsCoeff, blockLength);
+        auto linkedRms = 0.0f;
+
+        for (auto channel = 0; channel < numChannels; ++channel)
+        {
+            const auto rms = buffer.getRMSLevel (channel, 0, numSamples) * inputGain;
+
+            auto& state = rmsState[static_cast<size_t> (channel)];
+            state = rmsDecay * state + (1.0f - rmsDecay) * rms * rms;
+
+            linkedRms = juce::jmax (linkedRms, std::sqrt (state));
+        }
+
+        const auto targetGainReductionDb = computeGainReductionDb (parameters, juce::Decibels::gainToDecibels (linkedRms, -120.0f));
+        const auto envelopeDecay = std::pow (getEnvelopeCoeff (targetGainReductionDb, sampleRateCoeffs), blockLength);
+        gainReductionEnvelopeDb = targetGainReductionDb + envelopeDecay * (gainReductionEnvelopeDb - targetGainReductionDb);
+
+        targetGainLinear = juce::Decibels::decibelsToGain (-gainReductionEnvelopeDb);
+        smoothedGainLinear = targetGainLinear;
+        lastGainReductionDb = juce::jmax (0.0f, gainReductionEnvelopeDb);
+        lastMinGainReductionDb = lastGainReductionDb;
+    }
+
+    // Runs the level-to-gain chain (log, gain computer, envelope, exp) once every
+    // samplesPerUpdate samples instead of every sample; the RMS detector and the gain
+    // smoother stay at full rate. 1 is the normal full-rate mode.
+    void setControlInterval (int samplesPerUpdate) noexcept
+    {
+        const auto interval = juce::jlimit (1, maxControlInterval, samplesPerUpdate);
+
+        if (interval == controlInterval)
+            return;
+
+        controlInterval = interval;
+        samplesUntilControlUpdate = 0;
+        updateTimeConstants();
+    }
+
+    static constexpr int maxControlInterval = 16;
+
+    float getLastGainReductionDb() const noexcept
+    {
+        return lastGainReductionDb;
+    }
+
+    // Least gain reduction over the last processed block; with the above, the block's range.
+    float getLastMinGainReductionDb() const noexcept
+    {
+        return lastMinGainReductionDb;
+    }
+
+    // Turns the GR meter ballistics on or off. On re-enable the meter restarts from the
+    // current envelope rather than from wherever it stopped.
+    void setMeteringEnabled (bool shouldMeter) noexcept
+    {
+        if (shouldMeter && ! meteringEnabled)
+        {
+            grMeterBallistics.reset (gainReductionEnvelopeDb);
+            meterGainReductionDb = gainReductionEnvelopeDb;
+        }
+
+        meteringEnabled = shouldMeter;
+    }
+
+    float getMeterGainReductionDb() const noexcept
+    {
+        return meterGainReductionDb;
+    }
+
+    float getAutoMakeupDb() const noexcept
+    {
+        return parameters.autoMakeup ? autoMakeup.getAppliedDb() : 0.0f;
+    }
+
+private:
+    static float coefficientFromMs (float timeMs, double sr)
+    {
+        const auto seconds = juce::jmax (0.00001, static_cast<double> (timeMs) * 0.001);
+        return std::exp (-1.0f / static_cast<float> (seconds * sr));
+    }
+
+    static float smoothstep (float x) noexcept
+    {
+        const auto t = juce::jlimit (0.0f, 1.0f, x);
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    static float makeHpfAlpha (float cutoffHz, double sr)
+    {
+        const auto freq = juce::jlimit (20.0f, 250.0f, cutoffHz);
+        const auto dt = 1.0 / sr;
+        const auto rc = 1.0 / (2.0 * juce::MathConstants<double>::pi * static_cast<double> (freq));
+        return static_cast<float> (rc / (rc + dt));
+    }
+
+    struct EnvelopeCoeffs
+    {
+        float attack = 0.0f;
+        float releaseFast = 0.0f;
+        float releaseSlow = 0.0f;
+    };
+
+    float getEnvelopeCoeff (float targetGainReductionDb, const EnvelopeCoeffs& coeffs) const noexcept
+    {
+        if (targetGainReductionDb > gainReductionEnvelopeDb)
+            return coeffs.attack;
+
+        auto releaseBlend = smoothstep ((gainReductionEnvelopeDb - smallGrDb) / (largeGrDb - smallGrDb));
+
+        if (parameters.characterMode == Parameters::opto)
+        {
+            // Keep faster recovery at high GR while extending the tail for smoother leveling.
+            releaseBlend = std::pow (releaseBlend, optoReleaseTailPower);
+        }
+
+        return juce::jmap (releaseBlend, coeffs.releaseSlow, coeffs.releaseFast);
+    }
+
     void updateTimeConstants()
     {
         auto effectiveAttackMs = parameters.attackMs;
@@ -244,14 +398,19 @@ private:
             effectiveReleaseMs = fixedSlowReleaseMidMs;
         }
 
-        attackCoeff = coefficientFromMs (effectiveAttackMs, sampleRate);
-
         constexpr auto releaseScale = 4.0f;
         const auto releaseFastMs = juce::jlimit (5.0f, 2000.0f, effectiveReleaseMs / releaseScale);
         const auto releaseSlowMs = juce::jlimit (5.0f, 2000.0f, effectiveReleaseMs * releaseScale);
 
-        releaseFastCoeff = coefficientFromMs (releaseFastMs, sampleRate);
-        releaseSlowCoeff = coefficientFromMs (releaseSlowMs, sampleRate);
+        sampleRateCoeffs.attack = coefficientFromMs (effectiveAttackMs, sampleRate);
+        sampleRateCoeffs.releaseFast = coefficientFromMs (releaseFastMs, sampleRate);
+        sampleRateCoeffs.releaseSlow = coefficientFromMs (releaseSlowMs, sampleRate);
+
+        // The same time constants for an envelope stepped once per control interval.
+        const auto controlRate = sampleRate / static_cast<double> (controlInterval);
+        controlRateCoeffs.attack = coefficientFromMs (effectiveAttackMs, controlRate);
+        controlRateCoeffs.releaseFast = coefficientFromMs (releaseFastMs, controlRate);
+        controlRateCoeffs.releaseSlow = coefficientFromMs (releaseSlowMs, controlRate);
 
         const auto rmsWindowMs = parameters.characterMode == Parameters::opto ? optoRmsWindowMs : cleanRmsWindowMs;
         rmsCoeff = coefficientFromMs (rmsWindowMs, sampleRate);
@@ -286,9 +445,10 @@ private:
 
     double sampleRate = 44100.0;
 
-    float attackCoeff = 0.0f;
-    float releaseFastCoeff = 0.0f;
-    float releaseSlowCoeff = 0.0f;
+    EnvelopeCoeffs sampleRateCoeffs;
+    EnvelopeCoeffs controlRateCoeffs;
+    int controlInterval = 1;
+    int samplesUntilControlUpdate = 0;
     float rmsCoeff = 0.0f;
     float gainSmoothCoeff = 0.0f;
 
@@ -302,10 +462,16 @@ private:
     std::array<float, 2> hpfPrevOutput { 0.0f, 0.0f };
 
     float gainReductionEnvelopeDb = 0.0f;
+    float targetGainLinear = 1.0f;
     float smoothedGainLinear = 1.0f;
     float lastGainReductionDb = 0.0f;
+    float lastMinGainReductionDb = 0.0f;
+    float externalDetectorDb = -120.0f;
+    float lastBlockDetectorDb = -120.0f;
     MeterBallistics grMeterBallistics;
     float meterGainReductionDb = 0.0f;
+    bool meteringEnabled = true;
+    AutoMakeup autoMakeup;
 
     static constexpr float smallGrDb = 3.0f;
     static constexpr float largeGrDb = 10.0f;
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Linear gain ramp across one block, starting where the previous block ended so
+// parameter moves never step mid-signal.
+class BlockGainRamp
+{
+public:
+    void reset (float gain) noexcept
+    {
+        start = gain;
+        increment = 0.0f;
+        target = gain;
+    }
+
+    void setTarget (float newTarget, int numSamples) noexcept
+    {
+        start = target;
+        increment = numSamples > 0 ? (newTarget - start) / static_cast<float> (numSamples) : 0.0f;
+        target = newTarget;
+    }
+
+    bool isConstant (float value) const noexcept
+    {
+        return start == value && increment == 0.0f;
+    }
+
+    float getGain (int sample) const noexcept
+    {
+        return start + increment * static_cast<float> (sample);
+    }
+
+    float getTarget() const noexcept
+    {
+        return target;
+    }
+
+private:
+    float start = 1.0f;
+    float increment = 0.0f;
+    float target = 1.0f;
+};
+
+// Single-pass gain and blend loops for the processor's trim, makeup and wet/dry stages.
+// Each returns how many float streams it read or wrote (a load or store of the whole
+// channel counts as one), so callers can account for memory traffic.
+class GainMixKernel
+{
+public:
+    // samples *= gain; when dry is given it receives the untrimmed input in the same pass.
+    static int trimAndCaptureDry (float* samples, float* dry, int numSamples, const BlockGainRamp& gain) noexcept
+    {
+        if (dry == nullptr)
+            return applyGain (samples, numSamples, gain);
+
+        if (gain.isConstant (1.0f))
+        {
+            juce::FloatVectorOperations::copy (dry, samples, numSamples);
+            return 2;
+        }
+
+        for (auto sample = 0; sample < numSamples; ++sample)
+        {
+            const auto x = samples[sample];
+            dry[sample] = x;
+            samples[sample] = x * gain.getGain (sample);
+        }
+
+        return 3;
+    }
+
+    static int applyGain (float* samples, int numSamples, const BlockGainRamp& gain) noexcept
+    {
+        if (gain.isConstant (1.0f))
+            return 0;
+
+        for (auto sample = 0; sample < numSamples; ++sample)
+            samples[sample] *= gain.getGain (sample);
+
+        return 2;
+    }
+
+    // wet = (wet * wetGain * mix + dry * (1 - mix)) * output. wetGain and dry may be null;
+    // without a dry signal to blend in there is nothing to mix, so it runs fully wet.
+    static int mixAndTrim (float* wet,
+                           const float* dry,
+                           int numSamples,
+                           const BlockGainRamp* wetGain,
+                           const BlockGainRamp& mix,
+                           const BlockGainRamp& output) noexcept
+    {
+        static const BlockGainRamp unity;
+        const auto& wetRamp = wetGain != nullptr ? *wetGain : unity;
+
+        if (dry == nullptr)
+        {
+            if (wetRamp.isConstant (1.0f) && output.isConstant (1.0f))
+                return 0;
+
+            for (auto sample = 0; sample < numSamples; ++sample)
+                wet[sample] *= wetRamp.getGain (sample) * output.getGain (sample);
+
+            return 2;
+        }
+
+        for (auto sample = 0; sample < numSamples; ++sample)
+        {
+            const auto mixAmount = mix.getGain (sample);
+            const auto outputGain = output.getGain (sample);
+            const auto wetCoeff = wetRamp.getGain (sample) * mixAmount * outputGain;
+            const auto dryCoeff = (1.0f - mixAmount) * outputGain;
+            wet[sample] = wet[sample] * wetCoeff + dry[sample] * dryCoeff;
+        }
+
+        return 3;
+    }
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// Process-wide registry through which instances compress as a linked group (shared via
+// juce::SharedResourcePointer). Each member owns one cache-line slot and is its only
+// writer; after every block it publishes the peak of its detector level there. Before
+// processing, a member reads the loudest fresh level among the other slots carrying its
+// group key and lets its own gain computer follow whichever is higher.
+//
+// Skew: a member sees each peer's most recently finished block. Hosts that process
+// instances in sequence hand it the peer's current block, hosts that run them in parallel
+// the previous one, so a peer's level arrives at most one block late. Levels not refreshed
+// within staleAfterMs (bypassed or stopped peers) are ignored.
+//
+// Joining and renaming happen on the message thread. The audio thread only loads and
+// stores atomics in a fixed array: no locks, no allocation, and a scan of maxMembers
+// slots costs the same however many of them are in use.
+class LinkBus
+{
+public:
+    static constexpr int maxMembers = 64;
+    static constexpr juce::uint32 staleAfterMs = 250;
+    static constexpr float silenceDb = -120.0f;
+
+    // Returns a slot to keep while the owner is linked, or -1 when all are taken.
+    int acquireSlot() noexcept
+    {
+        for (auto index = 0; index < maxMembers; ++index)
+        {
+            auto& slot = slots[static_cast<size_t> (index)];
+            auto expected = false;
+
+            if (slot.occupied.compare_exchange_strong (expected, true, std::memory_order_acq_rel))
+            {
+                slot.levelDb.store (silenceDb, std::memory_order_relaxed);
+                slot.groupKey.store (0, std::memory_order_release);
+                return index;
+            }
+        }
+
+        return -1;
+    }
+
+    // A block already under way may still publish to the slot once after this. A later
+    // owner overwrites that level with its own first block, and it goes stale regardless.
+    void releaseSlot (int index) noexcept
+    {
+        if (! juce::isPositiveAndBelow (index, maxMembers))
+            return;
+
+        auto& slot = slots[static_cast<size_t> (index)];
+        slot.groupKey.store (0, std::memory_order_release);
+        slot.occupied.store (false, std::memory_order_release);
+    }
+
+    // Key 0 leaves every group while keeping the slot.
+    void setGroup (int index, juce::uint64 groupKey) noexcept
+    {
+        if (juce::isPositiveAndBelow (index, maxMembers))
+            slots[static_cast<size_t> (index)].groupKey.store (groupKey, std::memory_order_release);
+    }
+
+    void publish (int index, float levelDb, juce::uint32 nowMs) noexcept
+    {
+        auto& slot = slots[static_cast<size_t> (index)];
+        slot.levelDb.store (levelDb, std::memory_order_relaxed);
+        slot.stampMs.store (nowMs, std::memory_order_release);
+    }
+
+    // Loudest fresh level among the other members of index's group.
+    float getGroupLevelDb (int index, juce::uint32 nowMs) const noexcept
+    {
+        const auto groupKey = slots[static_cast<size_t> (index)].groupKey.load (std::memory_order_acquire);
+        auto groupLevelDb = silenceDb;
+
+        if (groupKey == 0)
+            return groupLevelDb;
+
+        for (auto other = 0; other < maxMembers; ++other)
+        {
+            const auto& slot = slots[static_cast<size_t> (other)];
+
+            if (other == index || slot.groupKey.load (std::memory_order_acquire) != groupKey)
+                continue;
+
+            if (nowMs - slot.stampMs.load (std::memory_order_acquire) <= staleAfterMs)
+                groupLevelDb = juce::jmax (groupLevelDb, slot.levelDb.load (std::memory_order_relaxed));
+        }
+
+        return groupLevelDb;
+    }
+
+    int countMembers (juce::uint64 groupKey) const noexcept
+    {
+        if (groupKey == 0)
+            return 0;
+
+        auto members = 0;
+
+        for (const auto& slot : slots)
+            if (slot.groupKey.load (std::memory_order_acquire) == groupKey)
+                ++members;
+
+        return members;
+    }
+
+    // FNV-1a over the trimmed name; an empty name is 0 (not linked).
+    static juce::uint64 makeGroupKey (const juce::String& name)
+    {
+        const auto trimmed = name.trim();
+
+        if (trimmed.isEmpty())
+            return 0;
+
+        auto hash = static_cast<juce::uint64> (14695981039346656037ull);
+
+        for (const auto* c = trimmed.toRawUTF8(); *c != 0; ++c)
+        {
+            hash ^= static_cast<juce::uint8> (*c);
+            hash *= static_cast<juce::uint64> (1099511628211ull);
+        }
+
+        return hash != 0 ? hash : 1;
+    }
+
+private:
+    struct alignas (64) Slot
+    {
+        std::atomic<juce::uint64> groupKey { 0 };
+        std::atomic<float> levelDb { silenceDb };
+        std::atomic<juce::uint32> stampMs { 0 };
+        std::atomic<bool> occupied { false };
+    };
+
+    static_assert (std::atomic<juce::uint64>::is_always_lock_free, "link slots must be lock-free");
+
+    std::array<Slot, maxMembers> slots;
+};
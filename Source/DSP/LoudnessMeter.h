@@ -0,0 +1,272 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+// EBU R128 loudness (ITU-R BS.1770-4) of up to four channels: momentary (400 ms),
+// short-term (3 s) and gated integrated LUFS.
+//
+// The two K-weighting biquads run once per sample for all channels together, one channel
+// per SIMD lane. Their squared output is summed into 100 ms hops; a ring of the last 30
+// hops gives both sliding windows, and every hop closes one 75%-overlapped 400 ms gating
+// block. Gating blocks land in a fixed histogram of 0.1 LU bins, each keeping its count and
+// summed energy, so integration over hours of program needs no more memory or time per
+// hop than over seconds.
+class LoudnessMeter
+{
+public:
+    static constexpr int maxChannels = 4;
+    static constexpr float minimumLufs = -100.0f; // reported when there is no energy at all
+
+    void prepare (double newSampleRate)
+    {
+        sampleRate = juce::jmax (1.0, newSampleRate);
+        samplesPerHop = juce::jmax (1, static_cast<int> (std::lround (0.1 * sampleRate)));
+        designKWeighting();
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        preFilter.reset();
+        rlbFilter.reset();
+        hopEnergy = Lanes::expand (0.0f);
+        hopSamples = 0;
+        hopRing.fill (0.0);
+        hopRingPosition = 0;
+        hopsFilled = 0;
+        momentaryLufs = minimumLufs;
+        shortTermLufs = minimumLufs;
+        resetIntegrated();
+    }
+
+    // Restarts the integrated measurement only; the sliding windows carry on.
+    void resetIntegrated() noexcept
+    {
+        gatingCounts.fill (0);
+        gatingEnergies.fill (0.0);
+        gatedCount = 0;
+        gatedEnergy = 0.0;
+        integratedLufs = minimumLufs;
+    }
+
+    void process (const juce::AudioBuffer<float>& buffer, int numChannels) noexcept
+    {
+        numChannels = juce::jmin (numChannels, buffer.getNumChannels(), maxChannels);
+        const auto numSamples = buffer.getNumSamples();
+
+        if (numChannels <= 0 || numSamples <= 0)
+            return;
+
+        std::array<const float*, maxChannels> channels {};
+
+        for (auto channel = 0; channel < numChannels; ++channel)
+            channels[static_cast<size_t> (channel)] = buffer.getReadPointer (channel);
+
+        alignas (Lanes::SIMDRegisterSize) std::array<float, Lanes::SIMDNumElements> frame {};
+
+        for (auto start = 0; start < numSamples;)
+        {
+            const auto chunk = juce::jmin (numSamples - start, samplesPerHop - hopSamples);
+
+            for (auto sample = start; sample < start + chunk; ++sample)
+            {
+                for (auto channel = 0; channel < numChannels; ++channel)
+                    frame[static_cast<size_t> (channel)] = channels[static_cast<size_t> (channel)][sample];
+
+                const auto weighted = rlbFilter.process (preFilter.process (Lanes::fromRawArray (frame.data())));
+                hopEnergy += weighted * weighted;
+            }
+
+            start += chunk;
+            hopSamples += chunk;
+
+            if (hopSamples >= samplesPerHop)
+                finishHop (numChannels);
+        }
+    }
+
+    float getMomentaryLufs() const noexcept { return momentaryLufs; }
+    float getShortTermLufs() const noexcept { return shortTermLufs; }
+    float getIntegratedLufs() const noexcept { return integratedLufs; }
+
+private:
+    using Lanes = juce::dsp::SIMDRegister<float>;
+
+    static_assert (Lanes::SIMDNumElements >= maxChannels, "one SIMD lane per channel");
+
+    // Transposed direct form II, the same coefficients in every lane.
+    struct Biquad
+    {
+        Lanes b0, b1, b2, a1, a2;
+        Lanes z1, z2;
+
+        void setCoefficients (double nb0, double nb1, double nb2, double na1, double na2) noexcept
+        {
+            b0 = Lanes::expand (static_cast<float> (nb0));
+            b1 = Lanes::expand (static_cast<float> (nb1));
+            b2 = Lanes::expand (static_cast<float> (nb2));
+            a1 = Lanes::expand (static_cast<float> (na1));
+            a2 = Lanes::expand (static_cast<float> (na2));
+        }
+
+        void reset() noexcept
+        {
+            z1 = Lanes::expand (0.0f);
+            z2 = Lanes::expand (0.0f);
+        }
+
+        Lanes process (Lanes x) noexcept
+        {
+            const auto y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+
+    // BS.1770 pre-filter (high shelf) and RLB high-pass, redesigned for the sample rate
+    // rather than taken from the 48 kHz table.
+    void designKWeighting() noexcept
+    {
+        {
+            const auto f0 = 1681.974450955533;
+            const auto gainDb = 3.999843853973347;
+            const auto q = 0.7071752369554196;
+            const auto k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const auto vh = std::pow (10.0, gainDb / 20.0);
+            const auto vb = std::pow (vh, 0.4996667741545416);
+            const auto a0 = 1.0 + k / q + k * k;
+
+            preFilter.setCoefficients ((vh + vb * k / q + k * k) / a0,
+                                       2.0 * (k * k - vh) / a0,
+                                       (vh - vb * k / q + k * k) / a0,
+                                       2.0 * (k * k - 1.0) / a0,
+                                       (1.0 - k / q + k * k) / a0);
+        }
+
+        {
+            const auto f0 = 38.13547087602444;
+            const auto q = 0.5003270373238773;
+            const auto k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const auto a0 = 1.0 + k / q + k * k;
+
+            rlbFilter.setCoefficients (1.0, -2.0, 1.0,
+                                       2.0 * (k * k - 1.0) / a0,
+                                       (1.0 - k / q + k * k) / a0);
+        }
+    }
+
+    static float toLufs (double energy) noexcept
+    {
+        return energy > 0.0 ? static_cast<float> (-0.691 + 10.0 * std::log10 (energy)) : minimumLufs;
+    }
+
+    void finishHop (int numChannels) noexcept
+    {
+        // Every channel here is a front channel, weighted 1.0.
+        auto energy = 0.0;
+
+        for (auto channel = 0; channel < numChannels; ++channel)
+            energy += static_cast<double> (hopEnergy.get (static_cast<size_t> (channel)));
+
+        energy /= static_cast<double> (hopSamples);
+        hopEnergy = Lanes::expand (0.0f);
+        hopSamples = 0;
+
+        // A NaN or infinity fed to the filters would stick in their state; start them over.
+        if (! std::isfinite (energy))
+        {
+            preFilter.reset();
+            rlbFilter.reset();
+            energy = 0.0;
+        }
+
+        hopRing[static_cast<size_t> (hopRingPosition)] = energy;
+        hopRingPosition = (hopRingPosition + 1) % hopsPerShortTerm;
+        hopsFilled = juce::jmin (hopsFilled + 1, hopsPerShortTerm);
+
+        const auto momentaryEnergy = averageLastHops (hopsPerMomentary);
+        momentaryLufs = toLufs (momentaryEnergy);
+        shortTermLufs = toLufs (averageLastHops (hopsPerShortTerm));
+
+        if (hopsFilled >= hopsPerMomentary)
+            addGatingBlock (momentaryEnergy);
+    }
+
+    double averageLastHops (int count) const noexcept
+    {
+        count = juce::jmin (count, hopsFilled);
+
+        if (count <= 0)
+            return 0.0;
+
+        auto sum = 0.0;
+
+        for (auto back = 1; back <= count; ++back)
+            sum += hopRing[static_cast<size_t> ((hopRingPosition - back + hopsPerShortTerm) % hopsPerShortTerm)];
+
+        return sum / static_cast<double> (count);
+    }
+
+    static int toGatingBin (float lufs) noexcept
+    {
+        return juce::jlimit (0, numGatingBins - 1, static_cast<int> ((lufs - absoluteGateLufs) * binsPerLu));
+    }
+
+    // Absolute gate at -70 LUFS, then a relative gate 10 LU under the mean of what passed.
+    // The relative gate is resolved to its bin, so blocks up to 0.1 LU under it still count.
+    void addGatingBlock (double energy) noexcept
+    {
+        const auto lufs = toLufs (energy);
+
+        if (lufs < absoluteGateLufs)
+            return;
+
+        const auto bin = static_cast<size_t> (toGatingBin (lufs));
+        ++gatingCounts[bin];
+        gatingEnergies[bin] += energy;
+        ++gatedCount;
+        gatedEnergy += energy;
+
+        const auto relativeGateBin = static_cast<size_t> (toGatingBin (toLufs (gatedEnergy / static_cast<double> (gatedCount)) - 10.0f));
+        juce::uint64 count = 0;
+        auto sum = 0.0;
+
+        for (auto index = relativeGateBin; index < gatingCounts.size(); ++index)
+        {
+            count += gatingCounts[index];
+            sum += gatingEnergies[index];
+        }
+
+        integratedLufs = count > 0 ? toLufs (sum / static_cast<double> (count)) : minimumLufs;
+    }
+
+    static constexpr int hopsPerMomentary = 4;  // 400 ms
+    static constexpr int hopsPerShortTerm = 30; // 3 s
+    static constexpr float absoluteGateLufs = -70.0f;
+    static constexpr float binsPerLu = 10.0f;
+    static constexpr int numGatingBins = 800;   // -70 to +10 LUFS; louder blocks share the top bin
+
+    double sampleRate = 44100.0;
+    int samplesPerHop = 4410;
+
+    Biquad preFilter;
+    Biquad rlbFilter;
+    Lanes hopEnergy = Lanes::expand (0.0f);
+    int hopSamples = 0;
+
+    std::array<double, hopsPerShortTerm> hopRing {};
+    int hopRingPosition = 0;
+    int hopsFilled = 0;
+
+    std::array<juce::uint32, numGatingBins> gatingCounts {};
+    std::array<double, numGatingBins> gatingEnergies {};
+    juce::uint64 gatedCount = 0; // blocks over the absolute gate, and their summed energy
+    double gatedEnergy = 0.0;
+
+    float momentaryLufs = minimumLufs;
+    float shortTermLufs = minimumLufs;
+    float integratedLufs = minimumLufs;
+};
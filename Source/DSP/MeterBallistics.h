@@ -20,11 +20,15 @@ public:
 
         attackCoeff = makeCoeff (attackMs);
         releaseCoeff = makeCoeff (releaseMs);
+        decimatedAttackCoeff = std::pow (attackCoeff, static_cast<float> (decimationFactor));
+        decimatedReleaseCoeff = std::pow (releaseCoeff, static_cast<float> (decimationFactor));
     }
 
     void reset (float initialDb = -100.0f) noexcept
     {
         stateDb = initialDb;
+        stridePeak = 0.0f;
+        strideFill = 0;
     }
 
     float processSample (float targetDb) noexcept
@@ -34,11 +38,74 @@ public:
         return stateDb;
     }
 
+    // Meters a buffer in strides of decimationFactor samples: the peak across channels and
+    // the whole stride drives one closed-form ballistics step, so no short peak is missed
+    // and the log and coefficient work runs once per stride. The attack spans hundreds of
+    // samples, so this reads like the per-sample meter. Strides continue across blocks.
+    // The same pass leaves the block's own peak for getBlockPeak(), and with measureRms its
+    // RMS for getBlockRms() (0 otherwise); only the level history shows the RMS.
+    float processBuffer (const juce::AudioBuffer<float>& buffer, int numChannels, bool measureRms) noexcept
+    {
+        const auto numSamples = buffer.getNumSamples();
+        numChannels = juce::jmin (numChannels, buffer.getNumChannels());
+        blockPeak = 0.0f;
+        blockRms = 0.0f;
+
+        if (numChannels <= 0 || numSamples <= 0)
+            return processSample (-100.0f);
+
+        for (auto start = 0; start < numSamples;)
+        {
+            const auto length = juce::jmin (decimationFactor - strideFill, numSamples - start);
+
+            for (auto channel = 0; channel < numChannels; ++channel)
+            {
+                const auto range = juce::FloatVectorOperations::findMinAndMax (buffer.getReadPointer (channel, start), length);
+                const auto segmentPeak = juce::jmax (-range.getStart(), range.getEnd());
+
+                stridePeak = juce::jmax (stridePeak, segmentPeak);
+                blockPeak = juce::jmax (blockPeak, segmentPeak);
+            }
+
+            start += length;
+            strideFill += length;
+
+            if (strideFill < decimationFactor)
+                break;
+
+            // Closed form of decimationFactor processSample calls with a constant target,
+            // which the state approaches without crossing.
+            const auto targetDb = juce::Decibels::gainToDecibels (stridePeak, -100.0f);
+            const auto coeff = targetDb > stateDb ? decimatedAttackCoeff : decimatedReleaseCoeff;
+            stateDb = targetDb + coeff * (stateDb - targetDb);
+
+            stridePeak = 0.0f;
+            strideFill = 0;
+        }
+
+        if (measureRms)
+        {
+            auto sumOfSquares = 0.0;
+
+            for (auto channel = 0; channel < numChannels; ++channel)
+                sumOfSquares += juce::square (static_cast<double> (buffer.getRMSLevel (channel, 0, numSamples)));
+
+            blockRms = static_cast<float> (std::sqrt (sumOfSquares / static_cast<double> (numChannels)));
+        }
+
+        return stateDb;
+    }
+
     float getCurrentDb() const noexcept
     {
         return stateDb;
     }
 
+    // Linear peak across channels and RMS over all channels together, of the buffer the
+    // last processBuffer() call metered.
+    float getBlockPeak() const noexcept { return blockPeak; }
+    float getBlockRms() const noexcept { return blockRms; }
+
 private:
     float makeCoeff (float timeMs) const noexcept
     {
@@ -52,4 +119,12 @@ private:
     float attackCoeff = 0.0f;
     float releaseCoeff = 0.0f;
     float stateDb = -100.0f;
+    float decimatedAttackCoeff = 0.0f;
+    float decimatedReleaseCoeff = 0.0f;
+
+    static constexpr int decimationFactor = 8;
+    float stridePeak = 0.0f;
+    int strideFill = 0;
+    float blockPeak = 0.0f;
+    float blockRms = 0.0f;
 };
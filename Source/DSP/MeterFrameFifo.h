@@ -0,0 +1,109 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+
+// Levels of one processed block, all measured on that same block.
+struct MeterFrame
+{
+    float inputPeak = 0.0f;  // linear, highest across channels
+    float inputRms = 0.0f;   // linear, over all channels together
+    float outputPeak = 0.0f;
+    float outputRms = 0.0f;
+    float minGainReductionDb = 0.0f;
+    float maxGainReductionDb = 0.0f;
+    int numSamples = 0;
+
+    // Folds a following block into this one: peaks and the GR range widen, RMS stays the
+    // RMS of both blocks together.
+    void merge (const MeterFrame& next) noexcept
+    {
+        const auto total = numSamples + next.numSamples;
+
+        if (total <= 0)
+            return;
+
+        const auto weight = static_cast<float> (numSamples) / static_cast<float> (total);
+        const auto blendRms = [weight] (float a, float b)
+        {
+            return std::sqrt (weight * a * a + (1.0f - weight) * b * b);
+        };
+
+        inputPeak = juce::jmax (inputPeak, next.inputPeak);
+        inputRms = blendRms (inputRms, next.inputRms);
+        outputPeak = juce::jmax (outputPeak, next.outputPeak);
+        outputRms = blendRms (outputRms, next.outputRms);
+        minGainReductionDb = juce::jmin (minGainReductionDb, next.minGainReductionDb);
+        maxGainReductionDb = juce::jmax (maxGainReductionDb, next.maxGainReductionDb);
+        numSamples = total;
+    }
+};
+
+// Wait-free single-producer/single-consumer ring of MeterFrames, one per block, so a reader
+// polling at screen rate still sees every block's peaks. The indices sit on separate cache
+// lines so the writer and reader never share one. If the reader falls behind, the writer
+// folds new blocks into a frame it holds back until there is room: peaks survive, only
+// their timing coarsens.
+class MeterFrameFifo
+{
+public:
+    static constexpr juce::uint32 capacity = 512; // power of two; seconds of small blocks
+
+    // Producer side.
+    void push (const MeterFrame& frame) noexcept
+    {
+        if (hasHeldFrame)
+            heldFrame.merge (frame);
+        else
+            heldFrame = frame;
+
+        const auto write = writeIndex.load (std::memory_order_relaxed);
+
+        if (write - readIndex.load (std::memory_order_acquire) >= capacity)
+        {
+            hasHeldFrame = true;
+            return;
+        }
+
+        frames[write & (capacity - 1)] = heldFrame;
+        hasHeldFrame = false;
+        writeIndex.store (write + 1, std::memory_order_release);
+    }
+
+    // Producer side: drops a held-back frame, e.g. when metering restarts.
+    void resetProducer() noexcept
+    {
+        hasHeldFrame = false;
+    }
+
+    // Consumer side. Copies up to maxFrames of the oldest pending frames.
+    int pop (MeterFrame* destination, int maxFrames) noexcept
+    {
+        const auto read = readIndex.load (std::memory_order_relaxed);
+        const auto available = writeIndex.load (std::memory_order_acquire) - read;
+        const auto count = juce::jmin (static_cast<juce::uint32> (juce::jmax (0, maxFrames)), available);
+
+        for (juce::uint32 i = 0; i < count; ++i)
+            destination[i] = frames[(read + i) & (capacity - 1)];
+
+        readIndex.store (read + count, std::memory_order_release);
+        return static_cast<int> (count);
+    }
+
+    // Consumer side: forgets everything pending, e.g. when a new reader attaches.
+    void discardPending() noexcept
+    {
+        readIndex.store (writeIndex.load (std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    static_assert ((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+    std::array<MeterFrame, capacity> frames {};
+    MeterFrame heldFrame;
+    bool hasHeldFrame = false;
+    alignas (64) std::atomic<juce::uint32> writeIndex { 0 };
+    alignas (64) std::atomic<juce::uint32> readIndex { 0 };
+};
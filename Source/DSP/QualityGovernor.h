@@ -0,0 +1,109 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+// Eco mode's load governor. Each block's processing time is compared with the block's
+// real-time budget (its length at the current sample rate). When the smoothed share stays
+// above stepDownLoad for stepDownHoldSeconds, processing drops one tier; when it stays
+// below stepUpLoad for stepUpHoldSeconds, it climbs one back. Load is always measured on
+// the tier that is running, so the gap between the thresholds and the much longer climb
+// hold keep it from bouncing between neighbouring tiers.
+//
+// One insert taking a tenth of the deadline on its own means either the machine is
+// saturated or this thread keeps getting preempted; either way the block is at risk.
+class QualityGovernor
+{
+public:
+    enum Tier
+    {
+        full = 0,
+        oversamplingCapped2x,
+        oversamplingOff,      // saturation at 1x through its antiderivative-antialiased shaper
+        controlRateDetection
+    };
+
+    static constexpr int numTiers = 4;
+
+    // Samples per compressor gain update in the controlRateDetection tier.
+    static constexpr int controlInterval = 8;
+
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = juce::jmax (1.0, newSampleRate);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        tier = full;
+        smoothedLoad = 0.0;
+        overloadSeconds = 0.0;
+        headroomSeconds = 0.0;
+    }
+
+    // elapsedSeconds is the wall time spent processing numSamples. Returns the tier for
+    // the next block.
+    int update (double elapsedSeconds, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return tier;
+
+        const auto budgetSeconds = static_cast<double> (numSamples) / sampleRate;
+        const auto load = elapsedSeconds / budgetSeconds;
+        const auto smoothing = std::exp (-budgetSeconds / loadSmoothingSeconds);
+        smoothedLoad = smoothing * smoothedLoad + (1.0 - smoothing) * load;
+
+        if (smoothedLoad > stepDownLoad)
+        {
+            overloadSeconds += budgetSeconds;
+            headroomSeconds = 0.0;
+        }
+        else if (smoothedLoad < stepUpLoad)
+        {
+            headroomSeconds += budgetSeconds;
+            overloadSeconds = 0.0;
+        }
+        else
+        {
+            overloadSeconds = 0.0;
+            headroomSeconds = 0.0;
+        }
+
+        if (overloadSeconds >= stepDownHoldSeconds && tier < numTiers - 1)
+        {
+            ++tier;
+            overloadSeconds = 0.0;
+        }
+        else if (headroomSeconds >= stepUpHoldSeconds && tier > full)
+        {
+            --tier;
+            headroomSeconds = 0.0;
+        }
+
+        return tier;
+    }
+
+    int getTier() const noexcept
+    {
+        return tier;
+    }
+
+    double getSmoothedLoad() const noexcept
+    {
+        return smoothedLoad;
+    }
+
+private:
+    static constexpr double stepDownLoad = 0.10;
+    static constexpr double stepUpLoad = 0.04;
+    static constexpr double stepDownHoldSeconds = 0.25;
+    static constexpr double stepUpHoldSeconds = 3.0;
+    static constexpr double loadSmoothingSeconds = 0.1;
+
+    double sampleRate = 44100.0;
+    int tier = full;
+    double smoothedLoad = 0.0;
+    double overloadSeconds = 0.0;
+    double headroomSeconds = 0.0;
+};
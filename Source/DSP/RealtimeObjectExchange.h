@@ -0,0 +1,76 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+// Hands heap objects built on a background thread to the audio thread.
+// The audio thread never allocates, frees or blocks: it swaps a pointer and parks the
+// object it replaced in a retire slot that the background thread empties later.
+template <typename ObjectType>
+class RealtimeObjectExchange
+{
+public:
+    RealtimeObjectExchange() = default;
+
+    ~RealtimeObjectExchange()
+    {
+        delete pending.exchange (nullptr);
+        delete retired.exchange (nullptr);
+        delete current;
+    }
+
+    // Background thread. Replaces any object that has not been picked up yet.
+    void publish (std::unique_ptr<ObjectType> newObject)
+    {
+        delete pending.exchange (newObject.release(), std::memory_order_acq_rel);
+    }
+
+    // Background thread. Frees whatever the audio thread has retired.
+    void collectGarbage()
+    {
+        delete retired.exchange (nullptr, std::memory_order_acq_rel);
+    }
+
+    bool hasPending() const noexcept
+    {
+        return pending.load (std::memory_order_acquire) != nullptr;
+    }
+
+    // Audio thread, wait-free. Takes the pending object if the retire slot is free,
+    // otherwise keeps the current one until a later call.
+    ObjectType* acquire() noexcept
+    {
+        if (pending.load (std::memory_order_relaxed) != nullptr
+            && retired.load (std::memory_order_acquire) == nullptr)
+        {
+            if (auto* next = pending.exchange (nullptr, std::memory_order_acq_rel))
+            {
+                retired.store (current, std::memory_order_release);
+                current = next;
+            }
+        }
+
+        return current;
+    }
+
+    // Audio thread. The object in use, without looking for a newer one.
+    ObjectType* get() const noexcept
+    {
+        return current;
+    }
+
+    // Only where blocking is acceptable: prepareToPlay, or offline rendering on the audio thread.
+    void replaceCurrent (std::unique_ptr<ObjectType> newObject)
+    {
+        delete current;
+        current = newObject.release();
+    }
+
+private:
+    ObjectType* current = nullptr;
+    std::atomic<ObjectType*> pending { nullptr };
+    std::atomic<ObjectType*> retired { nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeObjectExchange)
+};
@@ -14,16 +14,8 @@ public:
         const auto wetMix = juce::jlimit (0.0f, 1.0f, mix);
         const auto dryMix = 1.0f - wetMix;
 
-        // Gentler drive law for finer low-end control.
-        const auto driveClamped = juce::jlimit (0.0f, 1.0f, drive);
-        const auto driveT = driveClamped * driveClamped;
-        const auto driveDb = 12.0f * driveT;
-
-        const auto inputGain = juce::Decibels::decibelsToGain (driveDb);
-
-        // Partial auto compensation keeps tone changes while limiting loudness jumps.
-        constexpr auto compensationAmount = 0.70f;
-        const auto outputGain = juce::Decibels::decibelsToGain (-driveDb * compensationAmount);
+        const auto inputGain = getInputGain (drive);
+        const auto outputGain = getOutputGain (drive);
 
         for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
         {
@@ -39,4 +31,86 @@ public:
             }
         }
     }
+
+    // First-order antiderivative antialiasing (ADAA) of the same shaper, for running hot
+    // signals at 1x: each output is tanh averaged over the segment from the previous input,
+    // which aliases far less than sampling tanh directly. The result, dry blend included,
+    // sits half a sample later than processInPlace(). previousInputs holds, per channel,
+    // the input sample just before the block.
+    void processInPlaceAntiderivative (juce::dsp::AudioBlock<float>& block, float drive, float mix, const float* previousInputs) const noexcept
+    {
+        if (drive <= 0.0f || mix <= 0.0f)
+            return;
+
+        const auto wetMix = juce::jlimit (0.0f, 1.0f, mix);
+        const auto dryMix = 1.0f - wetMix;
+
+        const auto inputGain = getInputGain (drive);
+        const auto outputGain = getOutputGain (drive);
+
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* samples = block.getChannelPointer (channel);
+            auto previousDry = previousInputs[channel];
+            auto previousDriven = static_cast<double> (previousDry * inputGain);
+            auto previousIntegral = logCosh (previousDriven);
+
+            for (size_t sample = 0; sample < block.getNumSamples(); ++sample)
+            {
+                const auto dry = samples[sample];
+                const auto driven = static_cast<double> (dry * inputGain);
+                const auto integral = logCosh (driven);
+                const auto step = driven - previousDriven;
+
+                // Near-equal inputs would divide cancellation noise; the midpoint is exact enough there.
+                const auto shaped = std::abs (step) > 1.0e-6 ? (integral - previousIntegral) / step
+                                                            : std::tanh (0.5 * (driven + previousDriven));
+                const auto wet = static_cast<float> (shaped) * outputGain;
+                samples[sample] = wet * wetMix + 0.5f * (dry + previousDry) * dryMix;
+
+                previousDry = dry;
+                previousDriven = driven;
+                previousIntegral = integral;
+            }
+        }
+    }
+
+    // True when a block peaking at blockPeak stays inside tanh's near-linear region,
+    // i.e. the third harmonic the shaper would add is at or below about -60 dB.
+    static bool isEffectivelyLinear (float blockPeak, float drive) noexcept
+    {
+        return blockPeak * getInputGain (drive) < linearDrivenPeak;
+    }
+
+    static float getInputGain (float drive) noexcept
+    {
+        return juce::Decibels::decibelsToGain (getDriveDb (drive));
+    }
+
+    static float getOutputGain (float drive) noexcept
+    {
+        // Partial auto compensation keeps tone changes while limiting loudness jumps.
+        constexpr auto compensationAmount = 0.70f;
+        return juce::Decibels::decibelsToGain (-getDriveDb (drive) * compensationAmount);
+    }
+
+private:
+    // Antiderivative of tanh, written so it neither overflows nor loses small values.
+    static double logCosh (double x) noexcept
+    {
+        constexpr auto ln2 = 0.69314718055994530942;
+        const auto magnitude = std::abs (x);
+        return magnitude + std::log1p (std::exp (-2.0 * magnitude)) - ln2;
+    }
+
+    static float getDriveDb (float drive) noexcept
+    {
+        // Gentler drive law for finer low-end control.
+        const auto driveClamped = juce::jlimit (0.0f, 1.0f, drive);
+        const auto driveT = driveClamped * driveClamped;
+        return 12.0f * driveT;
+    }
+
+    // tanh (x) ~= x - x^3 / 3, so the third harmonic sits near x^2 / 12 below the fundamental.
+    static constexpr float linearDrivenPeak = 0.1f;
 };
@@ -0,0 +1,597 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+#include "RealtimeObjectExchange.h"
+#include "Saturation.h"
+#include "ScratchArena.h"
+
+// Saturation with optional 2x/4x oversampling. Blocks whose peak keeps the shaper in its
+// near-linear region skip the oversampled path (it cannot alias there) and run at 1x.
+// While an oversampler is in use the 1x path (and the clean signal for the sat mix) is
+// delayed by its latency, so the two paths line up and transitions crossfade without
+// combing. A short input history provides that delay and also warms a skipped or newly
+// arrived oversampler's filters just before it is used.
+//
+// Only the oversampler for the requested mode exists. A mode change is built by
+// runBackgroundWork() on the shared builder thread and swapped in without locks. On a mode
+// change the stage first fades the oversampler in use over to its 1x path and keeps it
+// there until the new one arrives; that one is warmed and fades in from its own 1x path
+// when the signal calls for it. As the 1x path's delay follows the oversampler's latency,
+// the switch crossfades from the 1x path at the old latency as well.
+class SaturationStage
+{
+public:
+    struct OversamplingConfiguration
+    {
+        OversamplingConfiguration (int modeToUse, int numChannelsToUse, int maxBlockSizeToUse)
+            : mode (modeToUse),
+              numChannels (numChannelsToUse),
+              maxBlockSize (maxBlockSizeToUse),
+              oversampling (static_cast<size_t> (numChannelsToUse),
+                            static_cast<size_t> (modeToUse),
+                            juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
+                            true,
+                            true)
+        {
+            oversampling.initProcessing (static_cast<size_t> (maxBlockSize));
+            oversampling.reset();
+            latencySamples = juce::jlimit (0, historySamples, static_cast<int> (std::lround (oversampling.getLatencyInSamples())));
+            jassert (latencySamples < historySamples);
+        }
+
+        const int mode;
+        const int numChannels;
+        const int maxBlockSize;
+        juce::dsp::Oversampling<float> oversampling;
+        int latencySamples = 0; // whole samples: built with integer latency
+    };
+
+    // Reserves the stage's scratch in arena; attachScratch() follows once it is allocated.
+    // The half-band filters do not depend on the sample rate, so on a re-prepare an
+    // oversampler that already covers the channel count and block size is kept. Otherwise
+    // the one for initialOsMode is built here, so the first block already runs in it;
+    // only later mode changes go through the builder thread.
+    void prepare (double newSampleRate,
+                  int newNumChannels,
+                  int maxBlockSize,
+                  int initialOsMode,
+                  ScratchArena& arena)
+    {
+        const juce::ScopedLock lock (configurationLock);
+
+        sampleRate = juce::jmax (1.0, newSampleRate);
+        numChannels = juce::jmax (1, newNumChannels);
+        maxBlock = juce::jmax (1, maxBlockSize);
+
+        scratchRegion = arena.reserveChannels (numChannels, maxBlock);
+        latencyFadeRegion = arena.reserveChannels (numChannels, maxBlock);
+        historyRegion = arena.reserveChannels (numChannels, historySamples);
+
+        bypassFadeStep = 1.0f / static_cast<float> (juce::jmax (1.0, bypassFadeMs * 0.001 * sampleRate));
+        linearHoldSamples = juce::jmax (1, static_cast<int> (linearHoldMs * 0.001 * sampleRate));
+
+        // Anything still in flight was built for the old configuration.
+        oversamplingExchange.collectGarbage();
+        oversamplingExchange.publish (nullptr);
+
+        const auto* existing = oversamplingExchange.get();
+
+        if (! isUsable (existing) || (initialOsMode > 0 && existing->mode != initialOsMode))
+            oversamplingExchange.replaceCurrent (initialOsMode > 0 ? buildConfiguration (initialOsMode) : nullptr);
+
+        const auto* current = oversamplingExchange.get();
+        requestedMode.store (initialOsMode, std::memory_order_relaxed);
+        activeMode.store (current != nullptr ? current->mode : 0, std::memory_order_relaxed);
+        lastPublishedMode = 0;
+        lastUsedConfiguration = oversamplingExchange.get();
+        lastUsedLatency = current != nullptr ? current->latencySamples : 0;
+
+        reset();
+    }
+
+    void attachScratch (const ScratchArena& arena)
+    {
+        arena.referTo (scratchBuffer, scratchRegion, numChannels, maxBlock);
+        arena.referTo (latencyFadeBuffer, latencyFadeRegion, numChannels, maxBlock);
+        arena.referTo (inputHistory, historyRegion, numChannels, historySamples);
+        inputHistory.clear();
+        historyPosition = 0;
+    }
+
+    void reset()
+    {
+        if (auto* configuration = oversamplingExchange.get())
+            configuration->oversampling.reset();
+
+        inputHistory.clear();
+        historyPosition = 0;
+
+        bypassAmount = 0.0f;
+        latencyFadeAmount = 0.0f;
+        linearRunSamples = 0;
+        lastBlockSkipped = false;
+    }
+
+    // Builder thread: creates the oversampler for a newly requested mode and frees retired ones.
+    void runBackgroundWork()
+    {
+        oversamplingExchange.collectGarbage();
+
+        const juce::ScopedLock lock (configurationLock);
+        const auto mode = requestedMode.load (std::memory_order_relaxed);
+
+        if (mode <= 0 || mode == activeMode.load (std::memory_order_relaxed))
+            return;
+
+        if (oversamplingExchange.hasPending() && mode == lastPublishedMode)
+            return;
+
+        oversamplingExchange.publish (buildConfiguration (mode));
+        lastPublishedMode = mode;
+    }
+
+    // Returns the oversampling mode actually used for this block (0 = 1x).
+    // allowSynchronousBuild lets offline renders build a missing oversampler in place, so
+    // their output does not depend on when the builder thread got to it.
+    int process (juce::AudioBuffer<float>& buffer, float drive, float mix, int osModeRequested, bool allowSynchronousBuild)
+    {
+        const auto numSamples = buffer.getNumSamples();
+        lastBlockSkipped = false;
+        requestedMode.store (osModeRequested, std::memory_order_relaxed);
+
+        if (numSamples <= 0)
+            return 0;
+
+        // An oversampler still being heard stays in use until it has faded over to 1x.
+        const auto leavingOversampler = lastUsedConfiguration != nullptr
+                                     && lastUsedConfiguration->mode != osModeRequested
+                                     && bypassAmount < 1.0f;
+
+        auto* configuration = leavingOversampler ? lastUsedConfiguration
+                            : osModeRequested > 0 ? getConfigurationFor (osModeRequested, allowSynchronousBuild)
+                                                  : nullptr;
+
+        // The one last used may already be retired, so only its latency is looked at.
+        if (configuration != lastUsedConfiguration)
+        {
+            beginLatencyFade (lastUsedLatency, configuration != nullptr ? configuration->latencySamples : 0);
+            lastUsedLatency = configuration != nullptr ? configuration->latencySamples : 0;
+        }
+
+        // The 1x path at the old latency, read before this block goes into the history.
+        const auto fadingLatency = latencyFadeAmount > 0.0f && renderLatencyFadeSource (buffer, drive, mix);
+        const auto modeInUse = processPath (buffer, configuration, drive, mix, osModeRequested);
+
+        if (fadingLatency)
+            applyLatencyFade (buffer);
+
+        return modeInUse;
+    }
+
+    // While suspended the stage runs at 1x as if every block were linear: it fades over,
+    // shapes with the antiderivative-antialiased form, and warms the oversampler up again
+    // before fading back when released.
+    void setOversamplingSuspended (bool shouldSuspend) noexcept { oversamplingSuspended = shouldSuspend; }
+
+    // Any thread: the requested oversampler has not been built yet.
+    bool isBuildPending() const noexcept
+    {
+        const auto mode = requestedMode.load (std::memory_order_relaxed);
+        return mode > 0 && mode != activeMode.load (std::memory_order_relaxed) && ! oversamplingExchange.hasPending();
+    }
+
+    bool wasLastBlockSkipped() const noexcept { return lastBlockSkipped; }
+    juce::int64 getOversampledBlocksRequested() const noexcept { return oversampledBlocksRequested; }
+    juce::int64 getOversampledBlocksSkipped() const noexcept { return oversampledBlocksSkipped; }
+
+    // Blocks too long for the scratch buffer, which lose the clean blend or the 1x crossfade.
+    juce::int64 getCapacityFallbacks() const noexcept { return capacityFallbacks; }
+
+private:
+    // configuration is null for the plain 1x path. One that is not the requested mode is
+    // held in its 1x path.
+    int processPath (juce::AudioBuffer<float>& buffer,
+                     OversamplingConfiguration* configuration,
+                     float drive,
+                     float mix,
+                     int osModeRequested)
+    {
+        const auto numSamples = buffer.getNumSamples();
+
+        if (configuration == nullptr)
+        {
+            lastUsedConfiguration = nullptr;
+            delayThroughHistory (buffer, numSamples, 0);
+            auto wetBlock = juce::dsp::AudioBlock<float> (buffer);
+            saturation.processInPlace (wetBlock, drive, mix);
+            return 0;
+        }
+
+        auto& oversampler = configuration->oversampling;
+        const auto modeInUse = configuration->mode;
+        const auto latency = configuration->latencySamples;
+        ++oversampledBlocksRequested;
+
+        auto blockPeak = 0.0f;
+        for (auto channel = 0; channel < juce::jmin (numChannels, buffer.getNumChannels()); ++channel)
+            blockPeak = juce::jmax (blockPeak, buffer.getMagnitude (channel, 0, numSamples));
+
+        // Enter bypass only after the signal has stayed linear for a while, leave it at once.
+        if (Saturation::isEffectivelyLinear (blockPeak, drive))
+            linearRunSamples = juce::jmin (linearHoldSamples, linearRunSamples + numSamples);
+        else
+            linearRunSamples = 0;
+
+        const auto targetBypass = oversamplingSuspended
+                               || configuration->mode != osModeRequested
+                               || linearRunSamples >= linearHoldSamples ? 1.0f : 0.0f;
+
+        // A freshly swapped-in oversampler starts in its 1x path and fades in like one
+        // leaving bypass, with its filters run over the recent input first.
+        if (configuration != lastUsedConfiguration)
+        {
+            lastUsedConfiguration = configuration;
+            bypassAmount = 1.0f;
+        }
+
+        if (bypassAmount >= 1.0f && targetBypass < 1.0f)
+            warmFromHistory (oversampler, drive);
+
+        if (bypassAmount == targetBypass)
+        {
+            if (targetBypass < 1.0f)
+            {
+                processOversampled (buffer, oversampler, latency, drive, mix, false);
+                return modeInUse;
+            }
+
+            const auto previousInputs = getDelayedPreviousInputs (latency);
+            delayThroughHistory (buffer, numSamples, latency);
+
+            auto wetBlock = juce::dsp::AudioBlock<float> (buffer);
+            saturateAt1x (wetBlock, drive, mix, previousInputs);
+
+            ++oversampledBlocksSkipped;
+            lastBlockSkipped = true;
+            return 0;
+        }
+
+        // Crossfade between the oversampled result (in buffer) and the 1x result. The delayed
+        // input copy in scratch doubles as the oversampled path's clean signal, and only then
+        // is it saturated at 1x in place.
+        const auto channelsToFade = juce::jmin (numChannels, buffer.getNumChannels());
+
+        if (scratchBuffer.getNumSamples() < numSamples)
+        {
+            ++capacityFallbacks;
+            bypassAmount = targetBypass;
+            processOversampled (buffer, oversampler, latency, drive, mix, false);
+            return modeInUse;
+        }
+
+        for (auto channel = 0; channel < channelsToFade; ++channel)
+            scratchBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+
+        const auto previousInputs = getDelayedPreviousInputs (latency);
+        delayThroughHistory (scratchBuffer, numSamples, latency);
+        processOversampled (buffer, oversampler, latency, drive, mix, true);
+
+        auto alternateBlock = juce::dsp::AudioBlock<float> (scratchBuffer)
+                                  .getSubsetChannelBlock (0, static_cast<size_t> (channelsToFade))
+                                  .getSubBlock (0, static_cast<size_t> (numSamples));
+        saturateAt1x (alternateBlock, drive, mix, previousInputs);
+
+        auto fadeEnd = bypassAmount;
+
+        for (auto channel = 0; channel < channelsToFade; ++channel)
+        {
+            auto* wet = buffer.getWritePointer (channel);
+            const auto* bypassed = scratchBuffer.getReadPointer (channel);
+            auto amount = bypassAmount;
+
+            for (auto sample = 0; sample < numSamples; ++sample)
+            {
+                amount = targetBypass > amount ? juce::jmin (targetBypass, amount + bypassFadeStep)
+                                               : juce::jmax (targetBypass, amount - bypassFadeStep);
+                wet[sample] += amount * (bypassed[sample] - wet[sample]);
+            }
+
+            fadeEnd = amount;
+        }
+
+        bypassAmount = fadeEnd;
+        return modeInUse;
+    }
+
+    // Switching configurations moves the 1x path's delay from one latency to the other.
+    void beginLatencyFade (int fromLatency, int toLatency) noexcept
+    {
+        if (fromLatency == toLatency)
+            return;
+
+        latencyFadeFrom = fromLatency;
+        latencyFadeAmount = 1.0f;
+    }
+
+    // Renders this block through the 1x path at latencyFadeFrom into latencyFadeBuffer.
+    bool renderLatencyFadeSource (const juce::AudioBuffer<float>& buffer, float drive, float mix) noexcept
+    {
+        const auto numSamples = buffer.getNumSamples();
+        const auto channelsToFade = juce::jmin (numChannels, buffer.getNumChannels());
+
+        if (latencyFadeBuffer.getNumSamples() < numSamples)
+        {
+            ++capacityFallbacks;
+            latencyFadeAmount = 0.0f;
+            return false;
+        }
+
+        for (auto channel = 0; channel < channelsToFade; ++channel)
+            latencyFadeBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+
+        const auto previousInputs = getDelayedPreviousInputs (latencyFadeFrom);
+        delayThroughHistory (latencyFadeBuffer, numSamples, latencyFadeFrom, false);
+
+        auto fadeBlock = juce::dsp::AudioBlock<float> (latencyFadeBuffer)
+                             .getSubsetChannelBlock (0, static_cast<size_t> (channelsToFade))
+                             .getSubBlock (0, static_cast<size_t> (numSamples));
+        saturateAt1x (fadeBlock, drive, mix, previousInputs);
+        return true;
+    }
+
+    void applyLatencyFade (juce::AudioBuffer<float>& buffer) noexcept
+    {
+        const auto numSamples = buffer.getNumSamples();
+        auto fadeEnd = latencyFadeAmount;
+
+        for (auto channel = 0; channel < juce::jmin (numChannels, buffer.getNumChannels()); ++channel)
+        {
+            auto* wet = buffer.getWritePointer (channel);
+            const auto* previous = latencyFadeBuffer.getReadPointer (channel);
+            auto amount = latencyFadeAmount;
+
+            for (auto sample = 0; sample < numSamples && amount > 0.0f; ++sample)
+            {
+                amount = juce::jmax (0.0f, amount - bypassFadeStep);
+                wet[sample] += amount * (previous[sample] - wet[sample]);
+            }
+
+            fadeEnd = amount;
+        }
+
+        latencyFadeAmount = fadeEnd;
+    }
+
+    std::unique_ptr<OversamplingConfiguration> buildConfiguration (int mode) const
+    {
+        return std::make_unique<OversamplingConfiguration> (mode, numChannels, maxBlock);
+    }
+
+    // Covers the prepared channel count and block size (a larger block size is fine).
+    bool isUsable (const OversamplingConfiguration* configuration) const noexcept
+    {
+        return configuration != nullptr
+            && configuration->numChannels == numChannels
+            && configuration->maxBlockSize >= maxBlock;
+    }
+
+    OversamplingConfiguration* getConfigurationFor (int mode, bool allowSynchronousBuild)
+    {
+        auto* configuration = oversamplingExchange.get();
+
+        if (configuration != nullptr && configuration->mode == mode)
+            return configuration;
+
+        configuration = oversamplingExchange.acquire();
+
+        if ((configuration == nullptr || configuration->mode != mode) && allowSynchronousBuild)
+        {
+            oversamplingExchange.replaceCurrent (buildConfiguration (mode));
+            configuration = oversamplingExchange.get();
+        }
+
+        activeMode.store (configuration != nullptr ? configuration->mode : 0, std::memory_order_relaxed);
+        return configuration;
+    }
+
+    // inputInScratch: the caller already put this block's delayed input in scratchBuffer
+    // (which also moved the input history on).
+    void processOversampled (juce::AudioBuffer<float>& buffer,
+                             juce::dsp::Oversampling<float>& oversampler,
+                             int latency,
+                             float drive,
+                             float mix,
+                             bool inputInScratch) noexcept
+    {
+        const auto numSamples = buffer.getNumSamples();
+        const auto channelsToBlend = juce::jmin (numChannels, buffer.getNumChannels());
+        auto effectiveMix = mix;
+        auto historyUpdated = inputInScratch;
+
+        if (mix < 0.999f)
+        {
+            const auto hasCleanBufferCapacity = scratchBuffer.getNumChannels() >= channelsToBlend
+                                             && scratchBuffer.getNumSamples() >= numSamples;
+
+            if (hasCleanBufferCapacity)
+            {
+                if (! inputInScratch)
+                {
+                    for (auto channel = 0; channel < channelsToBlend; ++channel)
+                        scratchBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+
+                    delayThroughHistory (scratchBuffer, numSamples, latency);
+                    historyUpdated = true;
+                }
+            }
+            else
+            {
+                ++capacityFallbacks;
+                effectiveMix = 1.0f;
+            }
+        }
+
+        if (! historyUpdated)
+            delayThroughHistory (buffer, numSamples, 0);
+
+        auto wetBlock = juce::dsp::AudioBlock<float> (buffer);
+        auto upsampledBlock = oversampler.processSamplesUp (wetBlock);
+        saturation.processInPlace (upsampledBlock, drive, 1.0f);
+        oversampler.processSamplesDown (wetBlock);
+
+        if (effectiveMix < 0.999f)
+        {
+            const auto cleanBlend = 1.0f - effectiveMix;
+
+            for (auto channel = 0; channel < channelsToBlend; ++channel)
+            {
+                buffer.applyGain (channel, 0, numSamples, effectiveMix);
+                buffer.addFrom (channel, 0, scratchBuffer, channel, 0, numSamples, cleanBlend);
+            }
+        }
+    }
+
+    // The 1x shaper of an oversampled mode. Suspended blocks can be hot, so they take the
+    // antiderivative form, which needs the input sample before the block.
+    void saturateAt1x (juce::dsp::AudioBlock<float>& block,
+                       float drive,
+                       float mix,
+                       const std::array<float, ScratchArena::maxChannels>& previousInputs) const noexcept
+    {
+        if (oversamplingSuspended)
+            saturation.processInPlaceAntiderivative (block, drive, mix, previousInputs.data());
+        else
+            saturation.processInPlace (block, drive, mix);
+    }
+
+    // Per channel, the input sample just before this block once delayed by delaySamples.
+    // Read before the block goes into the history.
+    std::array<float, ScratchArena::maxChannels> getDelayedPreviousInputs (int delaySamples) const noexcept
+    {
+        std::array<float, ScratchArena::maxChannels> previous {};
+        const auto delay = juce::jlimit (0, historySamples - 2, delaySamples);
+        const auto position = (historyPosition - 1 - delay + historySamples) % historySamples;
+
+        for (auto channel = 0; channel < juce::jmin (numChannels, inputHistory.getNumChannels()); ++channel)
+            previous[static_cast<size_t> (channel)] = inputHistory.getSample (channel, position);
+
+        return previous;
+    }
+
+    // Delays target (this block's input) in place by delaySamples using the input history,
+    // and records the block in the history unless told not to. A delay of zero only records it.
+    void delayThroughHistory (juce::AudioBuffer<float>& target, int numSamples, int delaySamples, bool record = true) noexcept
+    {
+        const auto channels = juce::jmin (numChannels, target.getNumChannels(), inputHistory.getNumChannels());
+
+        if (numSamples <= 0 || channels <= 0)
+            return;
+
+        const auto delay = juce::jlimit (0, historySamples - 1, delaySamples);
+        const auto recorded = juce::jmin (numSamples, historySamples);
+        std::array<float, historySamples> delayed;
+
+        for (auto channel = 0; channel < channels; ++channel)
+        {
+            auto* data = target.getWritePointer (channel);
+            auto* history = inputHistory.getWritePointer (channel);
+
+            for (auto index = 0; index < delay; ++index)
+                delayed[static_cast<size_t> (index)] = history[(historyPosition - delay + index + historySamples) % historySamples];
+
+            if (record)
+                for (auto index = numSamples - recorded; index < numSamples; ++index)
+                    history[(historyPosition + index) % historySamples] = data[index];
+
+            if (delay > 0)
+            {
+                const auto shifted = juce::jmax (0, numSamples - delay);
+                std::copy_backward (data, data + shifted, data + shifted + delay);
+                std::copy (delayed.begin(), delayed.begin() + juce::jmin (delay, numSamples), data);
+            }
+        }
+
+        if (record)
+            historyPosition = (historyPosition + numSamples) % historySamples;
+    }
+
+    // The half-band IIR state only remembers a few dozen input samples, so running the
+    // history through an oversampler, shaped as the wet path shapes it, leaves it where a
+    // continuous run would have.
+    void warmFromHistory (juce::dsp::Oversampling<float>& oversampler, float drive) noexcept
+    {
+        const auto warmSamples = juce::jmin (historySamples, scratchBuffer.getNumSamples());
+        const auto channelsToWarm = juce::jmin (numChannels, scratchBuffer.getNumChannels(), inputHistory.getNumChannels());
+
+        if (warmSamples <= 0 || channelsToWarm <= 0)
+            return;
+
+        for (auto channel = 0; channel < channelsToWarm; ++channel)
+        {
+            const auto* history = inputHistory.getReadPointer (channel);
+            auto* destination = scratchBuffer.getWritePointer (channel);
+
+            for (auto index = 0; index < warmSamples; ++index)
+                destination[index] = history[(historyPosition - warmSamples + index + historySamples) % historySamples];
+        }
+
+        auto warmBlock = juce::dsp::AudioBlock<float> (scratchBuffer)
+                             .getSubsetChannelBlock (0, static_cast<size_t> (channelsToWarm))
+                             .getSubBlock (0, static_cast<size_t> (warmSamples));
+
+        auto upsampledBlock = oversampler.processSamplesUp (warmBlock);
+        saturation.processInPlace (upsampledBlock, drive, 1.0f);
+        oversampler.processSamplesDown (warmBlock);
+    }
+
+    Saturation saturation;
+
+    RealtimeObjectExchange<OversamplingConfiguration> oversamplingExchange;
+    OversamplingConfiguration* lastUsedConfiguration = nullptr;
+    int lastUsedLatency = 0;
+    juce::CriticalSection configurationLock;
+    std::atomic<int> requestedMode { 0 };
+    std::atomic<int> activeMode { 0 };
+    int lastPublishedMode = 0;
+
+    // The 1x path at the previous configuration's latency while a switch fades away from it.
+    ScratchArena::Region latencyFadeRegion;
+    juce::AudioBuffer<float> latencyFadeBuffer;
+    int latencyFadeFrom = 0;
+    float latencyFadeAmount = 0.0f;
+
+    // One input-sized scratch serves as the clean copy for the sat mix, the 1x alternate
+    // during crossfades and the warm-up block; those uses never overlap.
+    ScratchArena::Region scratchRegion;
+    juce::AudioBuffer<float> scratchBuffer;
+
+    // The last historySamples of input, a ring fed on every block.
+    ScratchArena::Region historyRegion;
+    juce::AudioBuffer<float> inputHistory;
+    int historyPosition = 0;
+
+    double sampleRate = 44100.0;
+    int numChannels = 2;
+    int maxBlock = 512;
+
+    bool oversamplingSuspended = false;
+    float bypassAmount = 0.0f;
+    float bypassFadeStep = 1.0f;
+    int linearRunSamples = 0;
+    int linearHoldSamples = 1;
+    bool lastBlockSkipped = false;
+
+    juce::int64 oversampledBlocksRequested = 0;
+    juce::int64 oversampledBlocksSkipped = 0;
+    juce::int64 capacityFallbacks = 0;
+
+    static constexpr double bypassFadeMs = 5.0;
+    static constexpr double linearHoldMs = 50.0;
+    static constexpr int historySamples = 64;
+};
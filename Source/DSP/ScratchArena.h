@@ -0,0 +1,118 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cstring>
+
+// One cache-line-aligned heap block per instance for everything the audio thread writes
+// outside its own members. prepareToPlay lays it out in two passes: components reserve
+// regions while sizing themselves, the arena allocates once, then each component takes
+// its pointers. Regions start on their own cache line so neighbours never share one.
+class ScratchArena
+{
+public:
+    static constexpr size_t alignment = 64;
+    static constexpr int maxChannels = 8;
+
+    struct Region
+    {
+        size_t offset = 0;
+        size_t bytes = 0;
+    };
+
+    // Non-owning array view into a region.
+    template <typename ElementType>
+    struct Array
+    {
+        ElementType* data = nullptr;
+        size_t count = 0;
+
+        ElementType& operator[] (size_t index) const noexcept { return data[index]; }
+        size_t size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+        ElementType* begin() const noexcept { return data; }
+        ElementType* end() const noexcept { return data + count; }
+    };
+
+    void beginLayout() noexcept
+    {
+        layoutBytes = 0;
+    }
+
+    Region reserve (size_t bytes) noexcept
+    {
+        const Region region { layoutBytes, bytes };
+        layoutBytes += roundUp (bytes);
+        return region;
+    }
+
+    template <typename ElementType>
+    Region reserveArray (size_t count) noexcept
+    {
+        return reserve (count * sizeof (ElementType));
+    }
+
+    // Channels are padded to whole cache lines, so each starts aligned.
+    Region reserveChannels (int numChannels, int numSamples) noexcept
+    {
+        return reserve (static_cast<size_t> (juce::jmax (0, numChannels)) * getChannelStride (numSamples));
+    }
+
+    // Keeps the current block when the layout fits in it, clearing the part laid out,
+    // otherwise replaces it with a larger zeroed one. Call before handing out pointers.
+    void allocate()
+    {
+        if (layoutBytes <= allocatedBytes && storage != nullptr)
+        {
+            std::memset (base, 0, layoutBytes);
+            return;
+        }
+
+        storage.calloc (layoutBytes + alignment);
+        allocatedBytes = layoutBytes;
+
+        const auto address = reinterpret_cast<juce::pointer_sized_uint> (storage.get());
+        base = storage.get() + (alignment - address % alignment) % alignment;
+    }
+
+    template <typename ElementType>
+    Array<ElementType> getArray (Region region) const noexcept
+    {
+        jassert (region.offset + region.bytes <= allocatedBytes);
+        return { reinterpret_cast<ElementType*> (base + region.offset), region.bytes / sizeof (ElementType) };
+    }
+
+    // Points buffer at a region reserved with reserveChannels; the buffer owns nothing.
+    void referTo (juce::AudioBuffer<float>& buffer, Region region, int numChannels, int numSamples) const noexcept
+    {
+        jassert (numChannels <= maxChannels);
+        std::array<float*, maxChannels> channels {};
+        const auto stride = getChannelStride (numSamples);
+
+        for (auto channel = 0; channel < numChannels; ++channel)
+            channels[static_cast<size_t> (channel)] = reinterpret_cast<float*> (base + region.offset + static_cast<size_t> (channel) * stride);
+
+        buffer.setDataToReferTo (channels.data(), numChannels, numSamples);
+    }
+
+    size_t getSizeInBytes() const noexcept
+    {
+        return allocatedBytes;
+    }
+
+private:
+    static size_t roundUp (size_t bytes) noexcept
+    {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    static size_t getChannelStride (int numSamples) noexcept
+    {
+        return roundUp (static_cast<size_t> (juce::jmax (0, numSamples)) * sizeof (float));
+    }
+
+    juce::HeapBlock<char> storage;
+    char* base = nullptr;
+    size_t allocatedBytes = 0;
+    size_t layoutBytes = 0;
+};
@@ -0,0 +1,426 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "ScratchArena.h"
+
+// Output ceiling on inter-sample peaks, in the spirit of ITU-R BS.1770 true-peak metering.
+// A 4x polyphase interpolator (48 taps, 12 per phase) estimates the reconstructed peak
+// between samples; the gain needed to keep it under the ceiling is held over a short
+// lookahead window, released exponentially and box-smoothed, so the delayed audio never
+// meets a gain above what its neighbourhood required.
+//
+// Blocks whose sample peak times the interpolator's worst-case gain cannot reach the
+// ceiling, while the limiter is fully released, only run the delay line. The bound
+// includes the previous block's tail still queued in the interpolator.
+class TruePeakLimiter
+{
+public:
+    TruePeakLimiter()
+    {
+        designInterpolator();
+    }
+
+    // Sizes the limiter and reserves its state in arena; attachScratch() follows once the
+    // arena has been allocated.
+    void prepare (double sampleRate, int newNumChannels, ScratchArena& arena)
+    {
+        const auto sr = juce::jmax (1.0, sampleRate);
+        numChannels = juce::jlimit (1, maxChannels, newNumChannels);
+
+        lookaheadSamples = juce::jmax (1, static_cast<int> (std::ceil (lookaheadMs * 0.001 * sr)));
+        delaySamples = lookaheadSamples + interpolatorDelaySamples;
+
+        delayRegion = arena.reserveChannels (numChannels, delaySamples);
+        gainHistoryRegion = arena.reserveArray<float> (static_cast<size_t> (lookaheadSamples + 1));
+        minQueueValuesRegion = arena.reserveArray<float> (static_cast<size_t> (lookaheadSamples + 2));
+        minQueuePositionsRegion = arena.reserveArray<juce::int64> (static_cast<size_t> (lookaheadSamples + 2));
+
+        releaseStep = 1.0f - std::exp (-1.0f / static_cast<float> (releaseMs * 0.001 * sr));
+    }
+
+    void attachScratch (const ScratchArena& arena)
+    {
+        arena.referTo (delayLine, delayRegion, numChannels, delaySamples);
+        gainHistory = arena.getArray<float> (gainHistoryRegion);
+        minQueueValues = arena.getArray<float> (minQueueValuesRegion);
+        minQueuePositions = arena.getArray<juce::int64> (minQueuePositionsRegion);
+
+        reset();
+    }
+
+    void reset()
+    {
+        delayLine.clear();
+        delayPosition = 0;
+
+        for (auto& channelHistory : history)
+            channelHistory.fill (0.0f);
+
+        historyPosition = 0;
+        samplePosition = 0;
+        resetGain();
+    }
+
+    // For blocks the limiter does not process (switched off, or bypassed): the delay line
+    // and interpolator take the block in without producing output and the gain lets go, so
+    // switching the limiter back in continues from the right audio instead of silence.
+    void prime (const juce::AudioBuffer<float>& buffer) noexcept
+    {
+        const auto channels = juce::jmin (numChannels, buffer.getNumChannels());
+        const auto numSamples = buffer.getNumSamples();
+
+        if (channels <= 0 || numSamples <= 0 || gainHistory.empty())
+            return;
+
+        if (! isReleased())
+            resetGain();
+
+        pushHistory (buffer, channels, numSamples);
+
+        const auto skipped = juce::jmax (0, numSamples - delaySamples);
+        const auto startPosition = (delayPosition + skipped) % delaySamples;
+        auto endPosition = startPosition;
+
+        for (auto channel = 0; channel < channels; ++channel)
+        {
+            const auto* input = buffer.getReadPointer (channel);
+            auto* delayed = delayLine.getWritePointer (channel);
+            auto position = startPosition;
+            auto done = skipped;
+
+            while (done < numSamples)
+            {
+                const auto chunk = juce::jmin (numSamples - done, delaySamples - position);
+                std::copy (input + done, input + done + chunk, delayed + position);
+                done += chunk;
+                position = position + chunk < delaySamples ? position + chunk : 0;
+            }
+
+            endPosition = position;
+        }
+
+        delayPosition = endPosition;
+        samplePosition += numSamples;
+        lastReductionDb = 0.0f;
+    }
+
+    int getLatencySamples() const noexcept
+    {
+        return delaySamples;
+    }
+
+    float getLastGainReductionDb() const noexcept
+    {
+        return lastReductionDb;
+    }
+
+    void process (juce::AudioBuffer<float>& buffer, float ceilingDb) noexcept
+    {
+        const auto channels = juce::jmin (numChannels, buffer.getNumChannels());
+        const auto numSamples = buffer.getNumSamples();
+
+        if (channels <= 0 || numSamples <= 0 || gainHistory.empty())
+            return;
+
+        const auto ceiling = juce::Decibels::decibelsToGain (ceilingDb);
+
+        // The interpolator still holds the previous block's last samples; the peaks between
+        // them and this block's first samples are only evaluated now, so they count too.
+        auto blockPeak = 0.0f;
+        for (auto channel = 0; channel < channels; ++channel)
+        {
+            const auto& channelHistory = history[static_cast<size_t> (channel)];
+            for (auto index = 0; index < tapsPerPhase; ++index)
+                blockPeak = juce::jmax (blockPeak, std::abs (channelHistory[static_cast<size_t> (index)]));
+
+            blockPeak = juce::jmax (blockPeak, buffer.getMagnitude (channel, 0, numSamples));
+        }
+
+        if (isReleased() && blockPeak * interpolatorPeakBound <= ceiling)
+        {
+            processReleased (buffer, channels, numSamples);
+            lastReductionDb = 0.0f;
+            return;
+        }
+
+        auto minGainInBlock = 1.0f;
+
+        for (auto sample = 0; sample < numSamples; ++sample)
+        {
+            auto truePeak = 0.0f;
+
+            for (auto channel = 0; channel < channels; ++channel)
+                truePeak = juce::jmax (truePeak, pushAndInterpolate (channel, buffer.getSample (channel, sample)));
+
+            advanceHistoryPosition();
+
+            const auto requiredGain = truePeak > ceiling ? ceiling / truePeak : 1.0f;
+
+            // Each sample borders two interpolated intervals: honour both.
+            const auto intervalGain = juce::jmin (requiredGain, previousRequiredGain);
+            previousRequiredGain = requiredGain;
+
+            const auto heldGain = pushWindowMinimum (intervalGain);
+            auto recovered = releasedGain + (1.0f - releasedGain) * releaseStep;
+            if (recovered > releaseSnapGain)
+                recovered = 1.0f;
+
+            releasedGain = juce::jmin (heldGain, recovered);
+
+            const auto gain = pushGainAverage (releasedGain);
+            minGainInBlock = juce::jmin (minGainInBlock, gain);
+
+            for (auto channel = 0; channel < channels; ++channel)
+            {
+                auto* delayed = delayLine.getWritePointer (channel) + delayPosition;
+                const auto input = buffer.getSample (channel, sample);
+                buffer.setSample (channel, sample, *delayed * gain);
+                *delayed = input;
+            }
+
+            delayPosition = delayPosition + 1 < delaySamples ? delayPosition + 1 : 0;
+            ++samplePosition;
+        }
+
+        lastReductionDb = -juce::Decibels::gainToDecibels (minGainInBlock, -100.0f);
+    }
+
+private:
+    static constexpr int maxChannels = 2;
+    static constexpr int oversamplingFactor = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int interpolatorDelaySamples = 6;
+    static constexpr double lookaheadMs = 1.5;
+    static constexpr double releaseMs = 50.0;
+    static constexpr float releaseSnapGain = 0.99999f;
+
+    bool isReleased() const noexcept
+    {
+        return releasedGain >= 1.0f && nonUnityGains == 0 && minQueueSize == 0 && previousRequiredGain >= 1.0f;
+    }
+
+    void resetGain() noexcept
+    {
+        std::fill (gainHistory.begin(), gainHistory.end(), 1.0f);
+        gainHistoryPosition = 0;
+        gainHistorySum = static_cast<double> (gainHistory.size());
+        nonUnityGains = 0;
+
+        minQueueHead = 0;
+        minQueueSize = 0;
+
+        previousRequiredGain = 1.0f;
+        releasedGain = 1.0f;
+        lastReductionDb = 0.0f;
+    }
+
+    void designInterpolator()
+    {
+        constexpr auto numTaps = oversamplingFactor * tapsPerPhase;
+        constexpr auto centre = 0.5 * (numTaps - 1);
+        constexpr auto cutoff = 0.9; // of the base-rate Nyquist
+
+        std::array<double, numTaps> prototype {};
+
+        for (auto n = 0; n < numTaps; ++n)
+        {
+            const auto t = (n - centre) / oversamplingFactor;
+            const auto x = juce::MathConstants<double>::pi * cutoff * t;
+            const auto sinc = std::abs (x) < 1.0e-9 ? 1.0 : std::sin (x) / x;
+            const auto phase = 2.0 * juce::MathConstants<double>::pi * (n + 0.5) / numTaps;
+            const auto blackman = 0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2.0 * phase);
+            prototype[static_cast<size_t> (n)] = sinc * blackman;
+        }
+
+        interpolatorPeakBound = 0.0f;
+
+        for (auto p = 0; p < oversamplingFactor; ++p)
+        {
+            auto dcGain = 0.0;
+            for (auto k = 0; k < tapsPerPhase; ++k)
+                dcGain += prototype[static_cast<size_t> (k * oversamplingFactor + p)];
+
+            auto absoluteSum = 0.0;
+
+            // Stored oldest-first so the dot product walks the history forwards.
+            for (auto j = 0; j < tapsPerPhase; ++j)
+            {
+                const auto k = tapsPerPhase - 1 - j;
+                const auto coefficient = prototype[static_cast<size_t> (k * oversamplingFactor + p)] / dcGain;
+                phaseCoefficients[static_cast<size_t> (p)][static_cast<size_t> (j)] = static_cast<float> (coefficient);
+                absoluteSum += std::abs (coefficient);
+            }
+
+            interpolatorPeakBound = juce::jmax (interpolatorPeakBound, static_cast<float> (absoluteSum));
+        }
+    }
+
+    float pushAndInterpolate (int channel, float input) noexcept
+    {
+        auto& channelHistory = history[static_cast<size_t> (channel)];
+        channelHistory[static_cast<size_t> (historyPosition)] = input;
+        channelHistory[static_cast<size_t> (historyPosition + tapsPerPhase)] = input;
+
+        const auto* window = channelHistory.data() + historyPosition + 1;
+
+        // The sample the interpolated points surround, so sample peaks are always honoured.
+        auto peak = std::abs (window[tapsPerPhase - 1 - interpolatorDelaySamples]);
+
+        for (const auto& coefficients : phaseCoefficients)
+        {
+            auto sum = 0.0f;
+            for (auto j = 0; j < tapsPerPhase; ++j)
+                sum += coefficients[static_cast<size_t> (j)] * window[j];
+
+            peak = juce::jmax (peak, std::abs (sum));
+        }
+
+        return peak;
+    }
+
+    void advanceHistoryPosition() noexcept
+    {
+        historyPosition = historyPosition + 1 < tapsPerPhase ? historyPosition + 1 : 0;
+    }
+
+    // Minimum over the last lookahead + 1 values. Only gains below unity are queued, so an
+    // empty queue means "no reduction anywhere in the window".
+    float pushWindowMinimum (float value) noexcept
+    {
+        const auto capacity = static_cast<int> (minQueueValues.size());
+        const auto oldestAllowed = samplePosition - lookaheadSamples;
+
+        while (minQueueSize > 0 && minQueuePositions[static_cast<size_t> (minQueueHead)] < oldestAllowed)
+        {
+            minQueueHead = (minQueueHead + 1) % capacity;
+            --minQueueSize;
+        }
+
+        if (value < 1.0f)
+        {
+            while (minQueueSize > 0)
+            {
+                const auto back = (minQueueHead + minQueueSize - 1) % capacity;
+                if (minQueueValues[static_cast<size_t> (back)] < value)
+                    break;
+
+                --minQueueSize;
+            }
+
+            const auto slot = static_cast<size_t> ((minQueueHead + minQueueSize) % capacity);
+            minQueueValues[slot] = value;
+            minQueuePositions[slot] = samplePosition;
+            ++minQueueSize;
+        }
+
+        return minQueueSize > 0 ? minQueueValues[static_cast<size_t> (minQueueHead)] : 1.0f;
+    }
+
+    float pushGainAverage (float value) noexcept
+    {
+        auto& slot = gainHistory[static_cast<size_t> (gainHistoryPosition)];
+
+        nonUnityGains += (value < 1.0f ? 1 : 0) - (slot < 1.0f ? 1 : 0);
+        gainHistorySum += static_cast<double> (value) - static_cast<double> (slot);
+        slot = value;
+
+        gainHistoryPosition = gainHistoryPosition + 1 < static_cast<int> (gainHistory.size()) ? gainHistoryPosition + 1 : 0;
+
+        if (nonUnityGains == 0)
+        {
+            gainHistorySum = static_cast<double> (gainHistory.size());
+            return 1.0f;
+        }
+
+        return juce::jmin (1.0f, static_cast<float> (gainHistorySum / static_cast<double> (gainHistory.size())));
+    }
+
+    // Only the last tapsPerPhase samples of a block are ever read back.
+    void pushHistory (const juce::AudioBuffer<float>& buffer, int channels, int numSamples) noexcept
+    {
+        const auto historySamples = juce::jmin (numSamples, tapsPerPhase);
+        const auto startPosition = historyPosition;
+
+        for (auto channel = 0; channel < channels; ++channel)
+        {
+            historyPosition = startPosition;
+            const auto* input = buffer.getReadPointer (channel);
+
+            for (auto sample = numSamples - historySamples; sample < numSamples; ++sample)
+            {
+                auto& channelHistory = history[static_cast<size_t> (channel)];
+                channelHistory[static_cast<size_t> (historyPosition)] = input[sample];
+                channelHistory[static_cast<size_t> (historyPosition + tapsPerPhase)] = input[sample];
+                advanceHistoryPosition();
+            }
+        }
+    }
+
+    // Fully released and far from the ceiling: unity gain, so only the latency and the
+    // interpolator history need to move forward.
+    void processReleased (juce::AudioBuffer<float>& buffer, int channels, int numSamples) noexcept
+    {
+        pushHistory (buffer, channels, numSamples);
+
+        const auto startDelayPosition = delayPosition;
+
+        for (auto channel = 0; channel < channels; ++channel)
+        {
+            auto* data = buffer.getWritePointer (channel);
+            auto* delayed = delayLine.getWritePointer (channel);
+            auto position = startDelayPosition;
+            auto done = 0;
+
+            while (done < numSamples)
+            {
+                const auto chunk = juce::jmin (numSamples - done, delaySamples - position);
+                std::swap_ranges (delayed + position, delayed + position + chunk, data + done);
+                done += chunk;
+                position = position + chunk < delaySamples ? position + chunk : 0;
+            }
+
+            delayPosition = position;
+        }
+
+        gainHistoryPosition = static_cast<int> ((gainHistoryPosition + numSamples) % static_cast<int> (gainHistory.size()));
+        samplePosition += numSamples;
+    }
+
+    std::array<std::array<float, tapsPerPhase>, oversamplingFactor> phaseCoefficients {};
+    float interpolatorPeakBound = 1.0f;
+
+    int numChannels = 2;
+    int lookaheadSamples = 1;
+    int delaySamples = 1 + interpolatorDelaySamples;
+
+    juce::AudioBuffer<float> delayLine;
+    int delayPosition = 0;
+
+    std::array<std::array<float, 2 * tapsPerPhase>, maxChannels> history {};
+    int historyPosition = 0;
+
+    ScratchArena::Region delayRegion;
+    ScratchArena::Region gainHistoryRegion;
+    ScratchArena::Region minQueueValuesRegion;
+    ScratchArena::Region minQueuePositionsRegion;
+
+    ScratchArena::Array<float> gainHistory;
+    int gainHistoryPosition = 0;
+    double gainHistorySum = 0.0;
+    int nonUnityGains = 0;
+
+    ScratchArena::Array<float> minQueueValues;
+    ScratchArena::Array<juce::int64> minQueuePositions;
+    int minQueueHead = 0;
+    int minQueueSize = 0;
+    juce::int64 samplePosition = 0;
+
+    float previousRequiredGain = 1.0f;
+    float releasedGain = 1.0f;
+    float releaseStep = 1.0f;
+    float lastReductionDb = 0.0f;
+};
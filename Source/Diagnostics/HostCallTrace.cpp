@@ -0,0 +1,127 @@
+#include "HostCallTrace.h"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// Traced instances that have been prepared at least once, process-wide.
+std::atomic<int> preparedTraces { 0 };
+}
+
+std::unique_ptr<Diagnostics::HostCallTrace> Diagnostics::HostCallTrace::createFromEnvironment (const std::vector<StateFormat::ParameterEntry>& entries)
+{
+    const auto path = juce::SystemStats::getEnvironmentVariable ("TWOC_TRACE_FILE", {});
+
+    if (path.isEmpty() || ! juce::File::isAbsolutePath (path))
+        return {};
+
+    return std::make_unique<HostCallTrace> (juce::File (path), entries);
+}
+
+Diagnostics::HostCallTrace::HostCallTrace (const juce::File& destination, const std::vector<StateFormat::ParameterEntry>& entries)
+    : basePath (destination),
+      parameterEntries (entries),
+      originTicks (juce::Time::getHighResolutionTicks())
+{
+    records.resize (static_cast<size_t> (capacity));
+
+    // NaN never compares equal, so the first block records every parameter.
+    lastValues.assign (parameterEntries.size(), std::numeric_limits<float>::quiet_NaN());
+}
+
+void Diagnostics::HostCallTrace::recordPrepare (double sampleRate, int maximumBlockSize, int numChannels) noexcept
+{
+    if (traceNumber == 0)
+        traceNumber = ++preparedTraces;
+
+    append (HostCallTraceFormat::prepare, 0, numChannels, maximumBlockSize, static_cast<float> (sampleRate), juce::Time::getHighResolutionTicks());
+}
+
+void Diagnostics::HostCallTrace::recordRelease() noexcept
+{
+    append (HostCallTraceFormat::release, 0, 0, 0, 0.0f, juce::Time::getHighResolutionTicks());
+}
+
+void Diagnostics::HostCallTrace::recordReset() noexcept
+{
+    append (HostCallTraceFormat::reset, 0, 0, 0, 0.0f, juce::Time::getHighResolutionTicks());
+}
+
+void Diagnostics::HostCallTrace::recordParameterChanges() noexcept
+{
+    const auto ticks = juce::Time::getHighResolutionTicks();
+
+    for (size_t index = 0; index < parameterEntries.size(); ++index)
+    {
+        const auto& entry = parameterEntries[index];
+        const auto value = entry.value->load (std::memory_order_relaxed);
+
+        if (value == lastValues[index])
+            continue;
+
+        lastValues[index] = value;
+        append (HostCallTraceFormat::parameter, 0, static_cast<int> (index), 0, entry.parameter->convertTo0to1 (value), ticks);
+    }
+}
+
+void Diagnostics::HostCallTrace::recordProcess (int numSamples, juce::uint16 flags, juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    const auto elapsedUs = juce::Time::highResolutionTicksToSeconds (endTicks - startTicks) * 1.0e6;
+    append (HostCallTraceFormat::process, flags, 0, numSamples, static_cast<float> (elapsedUs), startTicks);
+}
+
+void Diagnostics::HostCallTrace::append (HostCallTraceFormat::RecordType type, juce::uint16 flags, int index, int numSamples, float value, juce::int64 ticks) noexcept
+{
+    const auto count = numRecords.load (std::memory_order_relaxed);
+
+    if (count >= static_cast<juce::uint32> (capacity))
+    {
+        dropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& record = records[count];
+    record.type = type;
+    record.flags = flags;
+    record.index = index;
+    record.numSamples = numSamples;
+    record.value = value;
+    record.ticks = ticks - originTicks;
+    numRecords.store (count + 1, std::memory_order_release);
+}
+
+bool Diagnostics::HostCallTrace::writeToFile() const
+{
+    const auto count = numRecords.load (std::memory_order_acquire);
+
+    if (traceNumber == 0 || count == 0)
+        return false;
+
+    auto file = basePath;
+
+    if (traceNumber > 1)
+        file = basePath.getSiblingFile (basePath.getFileNameWithoutExtension() + "_" + juce::String (traceNumber) + basePath.getFileExtension());
+
+    juce::MemoryOutputStream stream (HostCallTraceFormat::headerBytes + count * HostCallTraceFormat::recordBytes);
+    stream.writeInt (static_cast<int> (HostCallTraceFormat::magic));
+    stream.writeShort (static_cast<short> (HostCallTraceFormat::version));
+    stream.writeShort (static_cast<short> (HostCallTraceFormat::recordBytes));
+    stream.writeInt (static_cast<int> (parameterEntries.size()));
+    stream.writeInt (static_cast<int> (count));
+    stream.writeInt (static_cast<int> (dropped.load (std::memory_order_relaxed)));
+    stream.writeDouble (static_cast<double> (juce::Time::getHighResolutionTicksPerSecond()));
+
+    for (juce::uint32 index = 0; index < count; ++index)
+    {
+        const auto& record = records[index];
+        stream.writeShort (static_cast<short> (record.type));
+        stream.writeShort (static_cast<short> (record.flags));
+        stream.writeInt (record.index);
+        stream.writeInt (record.numSamples);
+        stream.writeFloat (record.value);
+        stream.writeInt64 (record.ticks);
+    }
+
+    return file.replaceWithData (stream.getData(), stream.getDataSize());
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "../StateFormat.h"
+#include "HostCallTraceFormat.h"
+
+namespace Diagnostics
+{
+// Opt-in recorder of the calls a host makes: prepare, release, reset, every processed
+// block with its size and duration, and every parameter that changed since the previous
+// block. Records go into a buffer preallocated up front; once it is full, later calls are
+// counted but not kept, so a trace always starts at the host's first prepare.
+//
+// Enabled by pointing TWOC_TRACE_FILE at an absolute path. The first instance the host
+// prepares writes to that path, later ones add their order of preparation to the file
+// name; instances that are never prepared (plugin scans) write nothing. The trace is
+// written on releaseResources() and again on destruction, never from the audio thread. `vst3_harness replay` re-drives a plugin with it.
+class HostCallTrace
+{
+public:
+    static constexpr int capacity = 1 << 18; // 6 MB; about 11 minutes of 128-sample blocks at 48 kHz
+
+    // Null unless TWOC_TRACE_FILE is set.
+    static std::unique_ptr<HostCallTrace> createFromEnvironment (const std::vector<StateFormat::ParameterEntry>& entries);
+
+    HostCallTrace (const juce::File& destination, const std::vector<StateFormat::ParameterEntry>& entries);
+
+    // Host calls. prepare, release and reset come from the message thread, the rest from
+    // the audio thread; hosts never overlap the two.
+    void recordPrepare (double sampleRate, int maximumBlockSize, int numChannels) noexcept;
+    void recordRelease() noexcept;
+    void recordReset() noexcept;
+    void recordParameterChanges() noexcept;
+    void recordProcess (int numSamples, juce::uint16 flags, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+    // False, and nothing written, until the host has prepared this instance.
+    bool writeToFile() const;
+
+private:
+    void append (HostCallTraceFormat::RecordType type, juce::uint16 flags, int index, int numSamples, float value, juce::int64 ticks) noexcept;
+
+    juce::File basePath;
+    int traceNumber = 0; // order of the first prepare among traced instances; 0 = never prepared
+    const std::vector<StateFormat::ParameterEntry>& parameterEntries;
+    std::vector<HostCallTraceFormat::Record> records;
+    std::vector<float> lastValues;
+    std::atomic<juce::uint32> numRecords { 0 };
+    std::atomic<juce::uint32> dropped { 0 };
+    juce::int64 originTicks = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (HostCallTrace)
+};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary host call trace, written by Diagnostics::HostCallTrace and read back by
+// `vst3_harness replay`. Only standard types, so the harness can include it as well.
+// All little-endian:
+//   uint32 magic, uint16 version, uint16 record bytes, uint32 parameter count,
+//   uint32 record count, uint32 records dropped, float64 ticks per second,
+//   record count x Record, each field in declaration order.
+namespace HostCallTraceFormat
+{
+constexpr std::uint32_t magic = 0x52544332; // "2CTR"
+constexpr std::uint16_t version = 1;
+
+enum RecordType : std::uint16_t
+{
+    prepare = 1,
+    release,
+    reset,
+    parameter,
+    process
+};
+
+enum ProcessFlags : std::uint16_t
+{
+    bypassedCall = 1, // processBlockBypassed rather than processBlock
+    nonRealtime = 2
+};
+
+struct Record
+{
+    std::uint16_t type = 0;
+    std::uint16_t flags = 0;
+    std::int32_t index = 0;      // parameter: parameter index; prepare: channel count
+    std::int32_t numSamples = 0; // process: block size; prepare: maximum block size
+    float value = 0.0f;          // parameter: normalised value; prepare: sample rate;
+                                 // process: microseconds the call took
+    std::int64_t ticks = 0;      // high-resolution ticks since the trace started
+};
+
+constexpr std::size_t headerBytes = 4 + 2 + 2 + 4 + 4 + 4 + 8;
+constexpr std::size_t recordBytes = 2 + 2 + 4 + 4 + 4 + 8;
+}
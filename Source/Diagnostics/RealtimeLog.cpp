@@ -0,0 +1,73 @@
+#include "RealtimeLog.h"
+
+#include <cstdio>
+
+const char* Diagnostics::getEventName (EventCode code) noexcept
+{
+    switch (code)
+    {
+        case EventCode::prepared: return "prepared";
+        case EventCode::blockTooLarge: return "blockTooLarge";
+        case EventCode::nonFiniteInput: return "nonFiniteInput";
+        case EventCode::nonFiniteOutput: return "nonFiniteOutput";
+        case EventCode::dryMixCapacityFallback: return "dryMixCapacityFallback";
+        case EventCode::bypassFadeCapacityFallback: return "bypassFadeCapacityFallback";
+        case EventCode::saturationCapacityFallback: return "saturationCapacityFallback";
+        case EventCode::latencyChanged: return "latencyChanged";
+        case EventCode::truePeakFadeCapacityFallback: return "truePeakFadeCapacityFallback";
+        case EventCode::nonFiniteCleared: return "nonFiniteCleared";
+    }
+
+    return "unknown";
+}
+
+Diagnostics::RealtimeLogWriter::RealtimeLogWriter()
+    : startTicks (juce::Time::getHighResolutionTicks())
+{
+    const auto path = juce::SystemStats::getEnvironmentVariable ("TWOC_RT_LOG_FILE", {});
+
+    if (path.isNotEmpty() && juce::File::isAbsolutePath (path))
+    {
+        file = std::make_unique<juce::FileOutputStream> (juce::File (path));
+
+        if (file->failedToOpen())
+            file.reset();
+    }
+}
+
+void Diagnostics::RealtimeLogWriter::drain (RealtimeLog& log, int instanceId)
+{
+    const juce::ScopedLock sl (lock);
+
+    log.drain ([this, instanceId] (const LogRecord& record)
+    {
+        const auto ms = juce::Time::highResolutionTicksToSeconds (record.ticks - startTicks) * 1000.0;
+        writeLine (juce::String::formatted ("[2C rt %d] %10.3f ms %-28s %d %g %g",
+                                            instanceId, ms, getEventName (record.code),
+                                            static_cast<int> (record.value),
+                                            static_cast<double> (record.a),
+                                            static_cast<double> (record.b)));
+    });
+
+    const auto dropped = log.getDroppedCount();
+
+    if (dropped != droppedReported[instanceId])
+    {
+        writeLine ("[2C rt " + juce::String (instanceId) + "] " + juce::String (dropped - droppedReported[instanceId]) + " records dropped (ring full)");
+        droppedReported.set (instanceId, dropped);
+    }
+
+    if (file != nullptr)
+        file->flush();
+}
+
+void Diagnostics::RealtimeLogWriter::writeLine (const juce::String& line)
+{
+    if (file != nullptr)
+    {
+        file->writeText (line + "\n", false, false, nullptr);
+        return;
+    }
+
+    std::fprintf (stderr, "%s\n", line.toRawUTF8());
+}
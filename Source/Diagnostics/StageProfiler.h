@@ -0,0 +1,262 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+// Compiled in with -DTWOC_STAGE_PROFILER=1 (CMake option TWOC_STAGE_PROFILER). When it is
+// 0, the macros below expand to nothing and the processor holds no profiler.
+#ifndef TWOC_STAGE_PROFILER
+ #define TWOC_STAGE_PROFILER 0
+#endif
+
+#if TWOC_STAGE_PROFILER
+ #define TWOC_PROFILE_STAGE(profiler, stage) \
+     const Diagnostics::ScopedStageTimer JUCE_JOIN_MACRO (stageTimer, __LINE__) (profiler, Diagnostics::StageProfiler::stage)
+ #define TWOC_PROFILE_BEGIN_BLOCK(profiler) (profiler).beginBlock()
+ #define TWOC_PROFILE_END_BLOCK(profiler, numSamples) (profiler).endBlock (numSamples)
+#else
+ #define TWOC_PROFILE_STAGE(profiler, stage) ((void) 0)
+ #define TWOC_PROFILE_BEGIN_BLOCK(profiler) ((void) 0)
+ #define TWOC_PROFILE_END_BLOCK(profiler, numSamples) ((void) 0)
+#endif
+
+namespace Diagnostics
+{
+// Time-stamp counter on x86 and the virtual counter on ARM64; elsewhere the high
+// resolution clock. Only differences between two reads are meaningful.
+inline juce::uint64 readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return static_cast<juce::uint64> (__rdtsc());
+   #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+    juce::uint64 ticks;
+    asm volatile ("mrs %0, cntvct_el0" : "=r" (ticks));
+    return ticks;
+   #else
+    return static_cast<juce::uint64> (juce::Time::getHighResolutionTicks());
+   #endif
+}
+
+// Ticks per second of readCycleCounter(). ARM64 and the high resolution clock report
+// theirs; the TSC's is measured against the high resolution clock over 20 ms the first
+// time this is called, so call it once off the audio thread before relying on it.
+inline double getCycleCounterFrequency() noexcept
+{
+   #if JUCE_INTEL
+    static const double frequency = []
+    {
+        const auto clockStart = juce::Time::getHighResolutionTicks();
+        const auto counterStart = readCycleCounter();
+        auto clockEnd = clockStart;
+
+        while (juce::Time::highResolutionTicksToSeconds (clockEnd - clockStart) < 0.02)
+            clockEnd = juce::Time::getHighResolutionTicks();
+
+        const auto counterEnd = readCycleCounter();
+        return static_cast<double> (counterEnd - counterStart) / juce::Time::highResolutionTicksToSeconds (clockEnd - clockStart);
+    }();
+    return frequency;
+   #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+    juce::uint64 frequency;
+    asm volatile ("mrs %0, cntfrq_el0" : "=r" (frequency));
+    return static_cast<double> (frequency);
+   #else
+    return static_cast<double> (juce::Time::getHighResolutionTicksPerSecond());
+   #endif
+}
+
+// Per-stage cost histograms for processBlock. Stages add their counter deltas while the
+// block runs (a stage may be timed in several pieces); endBlock() turns each stage that
+// ran into counter ticks per sample and files it in a quarter-octave histogram; summaries
+// convert to nanoseconds per sample. Written only by the audio thread, readable from any
+// thread without locks.
+class StageProfiler
+{
+public:
+    enum Stage
+    {
+        total = 0,
+        metering,
+        compressor,
+        saturation,
+        gainMix,
+        truePeak,
+        bypass,
+        diagnostics,
+        numStages
+    };
+
+    static constexpr int numBuckets = 64;
+
+    struct Summary
+    {
+        juce::int64 blocks = 0;
+        double minPerSample = 0.0;
+        double meanPerSample = 0.0;
+        double p99PerSample = 0.0;
+        double maxPerSample = 0.0;
+    };
+
+    static const char* getStageName (int stage) noexcept
+    {
+        static constexpr std::array<const char*, numStages> names { "total", "metering", "compressor", "saturation", "gain_mix", "true_peak", "bypass", "diagnostics" };
+        return juce::isPositiveAndBelow (stage, static_cast<int> (numStages)) ? names[static_cast<size_t> (stage)] : "unknown";
+    }
+
+    // Only while the audio thread is stopped. Also measures the counter frequency, if that
+    // has not been done yet, so summaries never have to.
+    void reset() noexcept
+    {
+        getCycleCounterFrequency();
+        pendingTicks.fill (0);
+
+        for (auto& histogram : histograms)
+        {
+            histogram.blocks.store (0, std::memory_order_relaxed);
+            histogram.sum.store (0.0, std::memory_order_relaxed);
+            histogram.min.store (std::numeric_limits<float>::max(), std::memory_order_relaxed);
+            histogram.max.store (0.0f, std::memory_order_relaxed);
+
+            for (auto& bucket : histogram.buckets)
+                bucket.store (0, std::memory_order_relaxed);
+        }
+    }
+
+    // Audio thread.
+    void beginBlock() noexcept
+    {
+        blockStart = readCycleCounter();
+    }
+
+    void add (int stage, juce::uint64 ticks) noexcept
+    {
+        pendingTicks[static_cast<size_t> (stage)] += ticks;
+    }
+
+    void endBlock (int numSamples) noexcept
+    {
+        add (total, readCycleCounter() - blockStart);
+
+        for (size_t stage = 0; stage < pendingTicks.size(); ++stage)
+        {
+            if (pendingTicks[stage] > 0 && numSamples > 0)
+                publish (histograms[stage], static_cast<float> (static_cast<double> (pendingTicks[stage]) / static_cast<double> (numSamples)));
+
+            pendingTicks[stage] = 0;
+        }
+    }
+
+    // Any thread. Values are nanoseconds per sample; p99 is the upper edge of its bucket.
+    Summary getSummary (int stage) const noexcept
+    {
+        Summary summary;
+
+        if (! juce::isPositiveAndBelow (stage, static_cast<int> (numStages)))
+            return summary;
+
+        const auto& histogram = histograms[static_cast<size_t> (stage)];
+        summary.blocks = histogram.blocks.load (std::memory_order_relaxed);
+
+        if (summary.blocks <= 0)
+            return summary;
+
+        summary.minPerSample = histogram.min.load (std::memory_order_relaxed);
+        summary.maxPerSample = histogram.max.load (std::memory_order_relaxed);
+        summary.meanPerSample = histogram.sum.load (std::memory_order_relaxed) / static_cast<double> (summary.blocks);
+
+        const auto p99Rank = static_cast<juce::int64> (std::ceil (0.99 * static_cast<double> (summary.blocks)));
+        juce::int64 seen = 0;
+
+        for (auto bucket = 0; bucket < numBuckets; ++bucket)
+        {
+            seen += histogram.buckets[static_cast<size_t> (bucket)].load (std::memory_order_relaxed);
+
+            if (seen >= p99Rank)
+            {
+                summary.p99PerSample = juce::jmin (summary.maxPerSample, getBucketUpperEdge (bucket));
+                break;
+            }
+        }
+
+        const auto nanosecondsPerTick = 1.0e9 / getCycleCounterFrequency();
+        summary.minPerSample *= nanosecondsPerTick;
+        summary.meanPerSample *= nanosecondsPerTick;
+        summary.p99PerSample *= nanosecondsPerTick;
+        summary.maxPerSample *= nanosecondsPerTick;
+        return summary;
+    }
+
+private:
+    // Bucket 0 starts at 1/4 tick per sample; 64 quarter octaves reach 2^14.
+    static int getBucket (float perSample) noexcept
+    {
+        if (perSample <= 0.0f)
+            return 0;
+
+        return juce::jlimit (0, numBuckets - 1, static_cast<int> (std::floor (4.0f * std::log2 (perSample))) + 8);
+    }
+
+    static double getBucketUpperEdge (int bucket) noexcept
+    {
+        return std::exp2 (static_cast<double> (bucket - 7) / 4.0);
+    }
+
+    struct Histogram
+    {
+        std::atomic<juce::int64> blocks { 0 };
+        std::atomic<double> sum { 0.0 };
+        std::atomic<float> min { std::numeric_limits<float>::max() };
+        std::atomic<float> max { 0.0f };
+        std::array<std::atomic<juce::uint32>, numBuckets> buckets {};
+    };
+
+    // Single writer, so plain load/store pairs are enough.
+    static void publish (Histogram& histogram, float perSample) noexcept
+    {
+        histogram.sum.store (histogram.sum.load (std::memory_order_relaxed) + perSample, std::memory_order_relaxed);
+        histogram.min.store (juce::jmin (histogram.min.load (std::memory_order_relaxed), perSample), std::memory_order_relaxed);
+        histogram.max.store (juce::jmax (histogram.max.load (std::memory_order_relaxed), perSample), std::memory_order_relaxed);
+
+        auto& bucket = histogram.buckets[static_cast<size_t> (getBucket (perSample))];
+        bucket.store (bucket.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        histogram.blocks.store (histogram.blocks.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    std::array<juce::uint64, numStages> pendingTicks {};
+    juce::uint64 blockStart = 0;
+    std::array<Histogram, numStages> histograms;
+};
+
+// Adds the ticks between construction and destruction to one stage.
+class ScopedStageTimer
+{
+public:
+    ScopedStageTimer (StageProfiler& profilerToUse, int stageToTime) noexcept
+        : profiler (profilerToUse), stage (stageToTime), start (readCycleCounter())
+    {
+    }
+
+    ~ScopedStageTimer()
+    {
+        profiler.add (stage, readCycleCounter() - start);
+    }
+
+private:
+    StageProfiler& profiler;
+    int stage;
+    juce::uint64 start;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedStageTimer)
+};
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the shared-memory telemetry segment every instance publishes into, and which
+// `vst3_harness top` maps read-only. Only standard types, so the harness can include it.
+//
+// The segment is one Header followed by numSlots Slots, one cache line each. An instance
+// claims a slot by swapping its process id into ownerPid and is from then on the slot's
+// only writer. Each block it rewrites the payload under a seqlock: sequence is odd while a
+// write is in progress, and a reader that sees it change across its copy tries again.
+// Every field is a lock-free atomic, so the copy itself is never a data race.
+namespace TelemetryFormat
+{
+constexpr const char* segmentName = "/twoc_telemetry";
+constexpr std::uint32_t magic = 0x4D4C5432; // "2TLM"
+constexpr std::uint32_t version = 1;
+constexpr std::uint32_t numSlots = 1024;
+
+enum Flags : std::uint32_t
+{
+    silent = 1,   // input and output below silenceDb
+    bypassed = 2,
+    eco = 4       // the eco governor has stepped quality down
+};
+
+constexpr float silenceDb = -90.0f;
+
+struct alignas (64) Header
+{
+    std::atomic<std::uint32_t> magic { 0 }; // stored last by whoever creates the segment
+    std::atomic<std::uint32_t> version { 0 };
+    std::atomic<std::uint32_t> numSlots { 0 };
+    std::atomic<std::uint32_t> slotBytes { 0 };
+};
+
+// What one block publishes; a plain copy of a Slot's payload.
+struct Sample
+{
+    std::int32_t instanceId = 0;
+    std::int32_t blockSize = 0;
+    float sampleRate = 0.0f;
+    float cpuUs = 0.0f;           // time processBlock took
+    float cpuLoad = 0.0f;         // cpuUs as a fraction of the block's real-time budget
+    float gainReductionDb = 0.0f;
+    float inputDb = -120.0f;      // peak of the detector (after the input trim)
+    float outputDb = -120.0f;     // output peak
+    std::int32_t osMode = 0;      // oversampling factor in use: 0 = off, 1 = 2x, 2 = 4x
+    std::uint32_t flags = 0;
+    std::uint64_t blocks = 0;
+    std::int64_t updatedMs = 0;   // wall clock, milliseconds since 1970
+};
+
+struct alignas (64) Slot
+{
+    std::atomic<std::uint32_t> sequence { 0 };
+    std::atomic<std::uint32_t> ownerPid { 0 }; // 0 = free
+
+    std::atomic<std::int32_t> instanceId { 0 };
+    std::atomic<std::int32_t> blockSize { 0 };
+    std::atomic<float> sampleRate { 0.0f };
+    std::atomic<float> cpuUs { 0.0f };
+    std::atomic<float> cpuLoad { 0.0f };
+    std::atomic<float> gainReductionDb { 0.0f };
+    std::atomic<float> inputDb { 0.0f };
+    std::atomic<float> outputDb { 0.0f };
+    std::atomic<std::int32_t> osMode { 0 };
+    std::atomic<std::uint32_t> flags { 0 };
+    std::atomic<std::uint64_t> blocks { 0 };
+    std::atomic<std::int64_t> updatedMs { 0 };
+};
+
+static_assert (sizeof (Slot) == 64, "a slot must stay one cache line");
+static_assert (std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<float>::is_always_lock_free,
+               "slots are shared between processes, so their atomics must be address-free");
+
+constexpr std::size_t segmentBytes = sizeof (Header) + numSlots * sizeof (Slot);
+
+inline Slot* getSlots (void* segment) noexcept
+{
+    return reinterpret_cast<Slot*> (static_cast<char*> (segment) + sizeof (Header));
+}
+
+inline const Slot* getSlots (const void* segment) noexcept
+{
+    return reinterpret_cast<const Slot*> (static_cast<const char*> (segment) + sizeof (Header));
+}
+
+// Writer side: the slot's owner only.
+inline void write (Slot& slot, const Sample& sample) noexcept
+{
+    const auto sequence = slot.sequence.load (std::memory_order_relaxed);
+    slot.sequence.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    slot.instanceId.store (sample.instanceId, std::memory_order_relaxed);
+    slot.blockSize.store (sample.blockSize, std::memory_order_relaxed);
+    slot.sampleRate.store (sample.sampleRate, std::memory_order_relaxed);
+    slot.cpuUs.store (sample.cpuUs, std::memory_order_relaxed);
+    slot.cpuLoad.store (sample.cpuLoad, std::memory_order_relaxed);
+    slot.gainReductionDb.store (sample.gainReductionDb, std::memory_order_relaxed);
+    slot.inputDb.store (sample.inputDb, std::memory_order_relaxed);
+    slot.outputDb.store (sample.outputDb, std::memory_order_relaxed);
+    slot.osMode.store (sample.osMode, std::memory_order_relaxed);
+    slot.flags.store (sample.flags, std::memory_order_relaxed);
+    slot.blocks.store (sample.blocks, std::memory_order_relaxed);
+    slot.updatedMs.store (sample.updatedMs, std::memory_order_relaxed);
+
+    slot.sequence.store (sequence + 2, std::memory_order_release);
+}
+
+// Reader side. False if the slot is free or kept changing under the reader.
+inline bool read (const Slot& slot, Sample& sample, std::uint32_t& ownerPid) noexcept
+{
+    for (auto attempt = 0; attempt < 16; ++attempt)
+    {
+        const auto before = slot.sequence.load (std::memory_order_acquire);
+
+        if ((before & 1u) != 0)
+            continue;
+
+        ownerPid = slot.ownerPid.load (std::memory_order_relaxed);
+        sample.instanceId = slot.instanceId.load (std::memory_order_relaxed);
+        sample.blockSize = slot.blockSize.load (std::memory_order_relaxed);
+        sample.sampleRate = slot.sampleRate.load (std::memory_order_relaxed);
+        sample.cpuUs = slot.cpuUs.load (std::memory_order_relaxed);
+        sample.cpuLoad = slot.cpuLoad.load (std::memory_order_relaxed);
+        sample.gainReductionDb = slot.gainReductionDb.load (std::memory_order_relaxed);
+        sample.inputDb = slot.inputDb.load (std::memory_order_relaxed);
+        sample.outputDb = slot.outputDb.load (std::memory_order_relaxed);
+        sample.osMode = slot.osMode.load (std::memory_order_relaxed);
+        sample.flags = slot.flags.load (std::memory_order_relaxed);
+        sample.blocks = slot.blocks.load (std::memory_order_relaxed);
+        sample.updatedMs = slot.updatedMs.load (std::memory_order_relaxed);
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (slot.sequence.load (std::memory_order_relaxed) == before)
+            return ownerPid != 0;
+    }
+
+    return false;
+}
+}
@@ -0,0 +1,166 @@
+#include "TelemetryPublisher.h"
+
+#include <utility>
+
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <unistd.h>
+ #define TWOC_TELEMETRY_POSIX 1
+#else
+ #define TWOC_TELEMETRY_POSIX 0
+#endif
+
+namespace
+{
+#if TWOC_TELEMETRY_POSIX
+bool isProcessAlive (std::uint32_t pid) noexcept
+{
+    return ::kill (static_cast<pid_t> (pid), 0) == 0 || errno != ESRCH;
+}
+#endif
+}
+
+Diagnostics::TelemetrySegment::TelemetrySegment()
+{
+   #if TWOC_TELEMETRY_POSIX
+    const auto fd = ::shm_open (TelemetryFormat::segmentName, O_RDWR | O_CREAT, 0600);
+
+    if (fd < 0)
+        return;
+
+    // Growing a fresh (zero-length) segment zero-fills it, which is every slot free.
+    // Every process truncates to the same size, so the race between creators is harmless.
+    if (::ftruncate (fd, static_cast<off_t> (TelemetryFormat::segmentBytes)) == 0)
+    {
+        auto* address = ::mmap (nullptr, TelemetryFormat::segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (address != MAP_FAILED)
+            mapping = address;
+    }
+
+    ::close (fd);
+
+    if (mapping == nullptr)
+        return;
+
+    auto* header = static_cast<TelemetryFormat::Header*> (mapping);
+
+    // A segment left by an incompatible build is not ours to write into.
+    if (const auto existing = header->magic.load (std::memory_order_acquire); existing != 0)
+    {
+        if (existing != TelemetryFormat::magic
+            || header->version.load (std::memory_order_relaxed) != TelemetryFormat::version
+            || header->slotBytes.load (std::memory_order_relaxed) != sizeof (TelemetryFormat::Slot))
+        {
+            ::munmap (mapping, TelemetryFormat::segmentBytes);
+            mapping = nullptr;
+        }
+
+        return;
+    }
+
+    header->version.store (TelemetryFormat::version, std::memory_order_relaxed);
+    header->numSlots.store (TelemetryFormat::numSlots, std::memory_order_relaxed);
+    header->slotBytes.store (static_cast<std::uint32_t> (sizeof (TelemetryFormat::Slot)), std::memory_order_relaxed);
+    header->magic.store (TelemetryFormat::magic, std::memory_order_release);
+   #endif
+}
+
+Diagnostics::TelemetrySegment::~TelemetrySegment()
+{
+   #if TWOC_TELEMETRY_POSIX
+    if (mapping == nullptr)
+        return;
+
+    // This process's instances have all released their slots by now. With no live owner
+    // left in any process the name goes too, so /dev/shm does not keep it after the last
+    // host quits; readers that have it mapped keep their view until they unmap.
+    if (! isOwnedByLiveProcess())
+        ::shm_unlink (TelemetryFormat::segmentName);
+
+    ::munmap (mapping, TelemetryFormat::segmentBytes);
+   #endif
+}
+
+bool Diagnostics::TelemetrySegment::isOwnedByLiveProcess() const noexcept
+{
+   #if TWOC_TELEMETRY_POSIX
+    if (mapping == nullptr)
+        return false;
+
+    const auto* slots = TelemetryFormat::getSlots (static_cast<const void*> (mapping));
+
+    for (std::uint32_t index = 0; index < TelemetryFormat::numSlots; ++index)
+        if (const auto owner = slots[index].ownerPid.load (std::memory_order_acquire); owner != 0 && isProcessAlive (owner))
+            return true;
+   #endif
+
+    return false;
+}
+
+TelemetryFormat::Slot* Diagnostics::TelemetrySegment::claimSlot() noexcept
+{
+   #if TWOC_TELEMETRY_POSIX
+    if (mapping == nullptr)
+        return nullptr;
+
+    const auto pid = static_cast<std::uint32_t> (::getpid());
+    auto* slots = TelemetryFormat::getSlots (mapping);
+
+    // Free slots first; failing that, take over one left behind by a process that died.
+    for (auto pass = 0; pass < 2; ++pass)
+    {
+        for (std::uint32_t index = 0; index < TelemetryFormat::numSlots; ++index)
+        {
+            auto& slot = slots[index];
+            auto owner = slot.ownerPid.load (std::memory_order_relaxed);
+
+            if (owner != 0 && (pass == 0 || isProcessAlive (owner)))
+                continue;
+
+            if (slot.ownerPid.compare_exchange_strong (owner, pid, std::memory_order_acq_rel))
+            {
+                TelemetryFormat::write (slot, {});
+                return &slot;
+            }
+        }
+    }
+   #endif
+
+    return nullptr;
+}
+
+void Diagnostics::TelemetrySegment::releaseSlot (TelemetryFormat::Slot* slot) noexcept
+{
+    if (slot == nullptr)
+        return;
+
+    TelemetryFormat::write (*slot, {});
+    slot->ownerPid.store (0, std::memory_order_release);
+}
+
+void Diagnostics::TelemetryPublisher::attach()
+{
+   #if TWOC_TELEMETRY
+    if (slot != nullptr)
+        return;
+
+    if (! segment.has_value())
+        segment.emplace();
+
+    slot = (*segment)->claimSlot();
+   #endif
+}
+
+void Diagnostics::TelemetryPublisher::detach()
+{
+   #if TWOC_TELEMETRY
+    if (segment.has_value())
+        (*segment)->releaseSlot (std::exchange (slot, nullptr));
+
+    segment.reset();
+   #endif
+}
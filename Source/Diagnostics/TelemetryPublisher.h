@@ -0,0 +1,69 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+
+#include "TelemetryFormat.h"
+
+// Compiled in by default (CMake option TWOC_TELEMETRY), but off until a process opts in;
+// see attach(). Only POSIX systems have the shared-memory segment, elsewhere the
+// publisher never attaches.
+#ifndef TWOC_TELEMETRY
+ #define TWOC_TELEMETRY 1
+#endif
+
+namespace Diagnostics
+{
+// The process's mapping of the telemetry segment, shared by every instance through
+// juce::SharedResourcePointer. The first process to get here creates the segment, so
+// instances in other processes and `vst3_harness top` all meet in the same place; the
+// last process to let go with no slot owned anywhere unlinks it. Slots are handed out
+// and taken back on the message thread.
+class TelemetrySegment
+{
+public:
+    TelemetrySegment();
+    ~TelemetrySegment();
+
+    // Null when the segment is unavailable or every slot is owned by a live process.
+    TelemetryFormat::Slot* claimSlot() noexcept;
+    void releaseSlot (TelemetryFormat::Slot* slot) noexcept;
+
+private:
+    bool isOwnedByLiveProcess() const noexcept;
+
+    void* mapping = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE (TelemetrySegment)
+};
+
+// One instance's slot. attach() and detach() run on the message thread; publish() is the
+// audio thread's whole cost: one seqlocked cache-line write.
+class TelemetryPublisher
+{
+public:
+    TelemetryPublisher() = default;
+    ~TelemetryPublisher() { detach(); }
+
+    // Maps the segment (the first attach in a process creates it) and claims a slot. Until
+    // then an instance neither maps nor publishes anything.
+    void attach();
+    void detach();
+
+    bool isAttached() const noexcept { return slot != nullptr; }
+
+    void publish (const TelemetryFormat::Sample& sample) noexcept
+    {
+        if (slot != nullptr)
+            TelemetryFormat::write (*slot, sample);
+    }
+
+private:
+   #if TWOC_TELEMETRY
+    std::optional<juce::SharedResourcePointer<TelemetrySegment>> segment;
+   #endif
+    TelemetryFormat::Slot* slot = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE (TelemetryPublisher)
+};
+}
@@ -120,7 +120,7 @@ juce::NormalisableRange<float> makeKneeRange()
 juce::AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterLayout()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> parameters;
-    parameters.reserve (17);
+    parameters.reserve (23);
 
     parameters.push_back (std::make_unique<juce::AudioParameterFloat> (
         juce::ParameterID { IDs::inputDb, 1 }, "Input", juce::NormalisableRange<float> { -24.0f, 24.0f }, 0.0f,
@@ -218,5 +218,30 @@ juce::AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterL
         juce::AudioParameterFloatAttributes().withStringFromValueFunction (
             [] (float value, int) { return juce::String (value, 1) + " dB"; })));
 
+    parameters.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { IDs::truePeakEnabled, 1 }, "True Peak", false));
+
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { IDs::truePeakCeilingDb, 1 }, "TP Ceiling", juce::NormalisableRange<float> { -12.0f, 0.0f }, -1.0f,
+        juce::AudioParameterFloatAttributes().withStringFromValueFunction (
+            [] (float value, int) { return juce::String (value, 1) + " dBTP"; })));
+
+    // Reported to the host as the plugin's own bypass (getBypassParameter).
+    parameters.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { IDs::bypass, 1 }, "Bypass", false));
+
+    parameters.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { IDs::ecoMode, 1 }, "Eco", false));
+
+    // While on, the compressor runs from the A/B preset slots instead of the controls;
+    // Morph moves between them (0 = A, 1 = B).
+    parameters.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { IDs::presetCompare, 1 }, "A/B", false));
+
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { IDs::presetMorph, 1 }, "Morph", juce::NormalisableRange<float> { 0.0f, 1.0f }, 0.0f,
+        juce::AudioParameterFloatAttributes().withStringFromValueFunction (
+            [] (float value, int) { return "A " + juce::String (juce::roundToInt ((1.0f - value) * 100.0f)) + " / B " + juce::String (juce::roundToInt (value * 100.0f)); })));
+
     return { parameters.begin(), parameters.end() };
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
 
 namespace Parameters
 {
@@ -23,6 +24,77 @@ inline constexpr const char* satMix = "satMix";
 inline constexpr const char* osMode = "osMode";
 inline constexpr const char* mix = "mix";
 inline constexpr const char* outputDb = "outputDb";
+inline constexpr const char* truePeakEnabled = "truePeakEnabled";
+inline constexpr const char* truePeakCeilingDb = "truePeakCeilingDb";
+inline constexpr const char* bypass = "bypass";
+inline constexpr const char* ecoMode = "ecoMode";
+inline constexpr const char* presetCompare = "presetCompare";
+inline constexpr const char* presetMorph = "presetMorph";
+}
+
+// The parameters an A/B preset slot holds and the morph blends, in slot order. The
+// true-peak switch stays live so a morph never changes the reported latency; bypass, eco
+// and the A/B controls themselves are not part of a preset.
+namespace MorphTargets
+{
+enum Index
+{
+    inputDb = 0,
+    thresholdDb,
+    ratio,
+    timingMode,
+    character,
+    attackMs,
+    releaseMs,
+    scHpfHz,
+    scHpfEnabled,
+    kneeDb,
+    makeupDb,
+    autoMakeup,
+    satDrive,
+    satMix,
+    osMode,
+    mix,
+    outputDb,
+    truePeakCeilingDb,
+    count
+};
+
+// Times and ratios blend geometrically so the midpoint sounds like a midpoint; switches
+// and choices change over halfway between two slots.
+enum class Blend
+{
+    linear,
+    logarithmic,
+    stepped
+};
+
+struct Target
+{
+    const char* parameterID;
+    Blend blend;
+};
+
+inline constexpr std::array<Target, count> targets { {
+    { IDs::inputDb, Blend::linear },
+    { IDs::thresholdDb, Blend::linear },
+    { IDs::ratio, Blend::logarithmic },
+    { IDs::timingMode, Blend::stepped },
+    { IDs::character, Blend::stepped },
+    { IDs::attackMs, Blend::logarithmic },
+    { IDs::releaseMs, Blend::logarithmic },
+    { IDs::scHpfHz, Blend::linear },
+    { IDs::scHpfEnabled, Blend::stepped },
+    { IDs::kneeDb, Blend::linear },
+    { IDs::makeupDb, Blend::linear },
+    { IDs::autoMakeup, Blend::stepped },
+    { IDs::satDrive, Blend::linear },
+    { IDs::satMix, Blend::linear },
+    { IDs::osMode, Blend::stepped },
+    { IDs::mix, Blend::linear },
+    { IDs::outputDb, Blend::linear },
+    { IDs::truePeakCeilingDb, Blend::linear },
+} };
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
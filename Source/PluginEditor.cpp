@@ -4,11 +4,16 @@
 TwoCCompressorAudioProcessorEditor::TwoCCompressorAudioProcessorEditor (TwoCCompressorAudioProcessor& p)
     : AudioProcessorEditor (&p),
       processor (p),
+      sidechainSpectrum (p),
+      transferCurve (p),
       inputMeter ("IN", MeterComponent::Type::inputOutput),
       grMeter ("GR", MeterComponent::Type::gainReduction),
       outputMeter ("OUT", MeterComponent::Type::inputOutput)
+     #if TWOC_STAGE_PROFILER
+      , stageProfileOverlay (p.getStageProfiler())
+     #endif
 {
-    setSize (980, 560);
+    setSize (980, 700);
 
     setupControl (controls[0], "Input", Parameters::IDs::inputDb);
     setupControl (controls[1], "Threshold", Parameters::IDs::thresholdDb);
@@ -119,6 +124,105 @@ TwoCCompressorAudioProcessorEditor::TwoCCompressorAudioProcessorEditor (TwoCComp
     addAndMakeVisible (autoMakeupButton);
     autoMakeupAttachment = std::make_unique<ButtonAttachment> (processor.getAPVTS(), Parameters::IDs::autoMakeup, autoMakeupButton);
 
+    truePeakButton.setButtonText ("TP");
+    truePeakButton.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.9f));
+    truePeakButton.setClickingTogglesState (true);
+    addAndMakeVisible (truePeakButton);
+    truePeakAttachment = std::make_unique<ButtonAttachment> (processor.getAPVTS(), Parameters::IDs::truePeakEnabled, truePeakButton);
+
+    truePeakCeilingSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    truePeakCeilingSlider.setTextBoxStyle (juce::Slider::TextBoxRight, false, 76, 20);
+    truePeakCeilingSlider.setColour (juce::Slider::trackColourId, juce::Colour::fromRGB (75, 174, 224));
+    truePeakCeilingSlider.setColour (juce::Slider::backgroundColourId, juce::Colours::white.withAlpha (0.2f));
+    truePeakCeilingSlider.setColour (juce::Slider::thumbColourId, juce::Colours::white.withAlpha (0.95f));
+    truePeakCeilingSlider.setColour (juce::Slider::textBoxTextColourId, juce::Colours::white.withAlpha (0.9f));
+    truePeakCeilingSlider.setColour (juce::Slider::textBoxOutlineColourId, juce::Colours::transparentBlack);
+    truePeakCeilingSlider.setColour (juce::Slider::textBoxBackgroundColourId, juce::Colours::white.withAlpha (0.08f));
+    addAndMakeVisible (truePeakCeilingSlider);
+    truePeakCeilingAttachment = std::make_unique<SliderAttachment> (processor.getAPVTS(), Parameters::IDs::truePeakCeilingDb, truePeakCeilingSlider);
+
+    ecoButton.setButtonText ("ECO");
+    ecoButton.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.9f));
+    ecoButton.setClickingTogglesState (true);
+    addAndMakeVisible (ecoButton);
+    ecoAttachment = std::make_unique<ButtonAttachment> (processor.getAPVTS(), Parameters::IDs::ecoMode, ecoButton);
+
+    presetCompareButton.setButtonText ("A/B");
+    presetCompareButton.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.9f));
+    presetCompareButton.setClickingTogglesState (true);
+    addAndMakeVisible (presetCompareButton);
+    presetCompareAttachment = std::make_unique<ButtonAttachment> (processor.getAPVTS(), Parameters::IDs::presetCompare, presetCompareButton);
+
+    static constexpr std::array<const char*, PresetSlots::numSlots> presetSlotNames { "A", "B" };
+
+    for (size_t i = 0; i < presetSlotNames.size(); ++i)
+    {
+        auto& storeButton = presetStoreButtons[i];
+        storeButton.setButtonText (juce::String ("SET ") + presetSlotNames[i]);
+        storeButton.setColour (juce::TextButton::buttonColourId, juce::Colours::white.withAlpha (0.08f));
+        storeButton.setColour (juce::TextButton::textColourOffId, juce::Colours::white.withAlpha (0.85f));
+        storeButton.onClick = [this, slot = static_cast<int> (i)] { processor.storePresetSlot (slot); };
+        addAndMakeVisible (storeButton);
+
+        // Recalling a slot moves Morph to its end; the audio thread glides there.
+        auto& recallButton = presetRecallButtons[i];
+        recallButton.setButtonText (presetSlotNames[i]);
+        recallButton.setClickingTogglesState (false);
+        recallButton.setColour (juce::TextButton::buttonColourId, juce::Colours::white.withAlpha (0.08f));
+        recallButton.setColour (juce::TextButton::buttonOnColourId, juce::Colour::fromRGB (75, 174, 224).withAlpha (0.95f));
+        recallButton.setColour (juce::TextButton::textColourOffId, juce::Colours::white.withAlpha (0.85f));
+        recallButton.setColour (juce::TextButton::textColourOnId, juce::Colours::black.withAlpha (0.88f));
+        recallButton.onClick = [this, position = static_cast<double> (i)]
+        {
+            presetMorphSlider.setValue (position / static_cast<double> (PresetSlots::numSlots - 1), juce::sendNotificationSync);
+        };
+        addAndMakeVisible (recallButton);
+    }
+
+    presetMorphSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    presetMorphSlider.setTextBoxStyle (juce::Slider::NoTextBox, false, 0, 0);
+    presetMorphSlider.setColour (juce::Slider::trackColourId, juce::Colour::fromRGB (75, 174, 224));
+    presetMorphSlider.setColour (juce::Slider::backgroundColourId, juce::Colours::white.withAlpha (0.2f));
+    presetMorphSlider.setColour (juce::Slider::thumbColourId, juce::Colours::white.withAlpha (0.95f));
+    addAndMakeVisible (presetMorphSlider);
+    presetMorphAttachment = std::make_unique<SliderAttachment> (processor.getAPVTS(), Parameters::IDs::presetMorph, presetMorphSlider);
+
+    loudnessLabel.setJustificationType (juce::Justification::centredLeft);
+    loudnessLabel.setColour (juce::Label::textColourId, juce::Colours::white.withAlpha (0.85f));
+    loudnessLabel.setFont (juce::FontOptions { 12.0f });
+    addAndMakeVisible (loudnessLabel);
+
+    // Clears the integrated readings; momentary and short-term keep running.
+    loudnessResetButton.setButtonText ("RST");
+    loudnessResetButton.setColour (juce::TextButton::buttonColourId, juce::Colours::white.withAlpha (0.08f));
+    loudnessResetButton.setColour (juce::TextButton::textColourOffId, juce::Colours::white.withAlpha (0.85f));
+    loudnessResetButton.onClick = [this] { processor.resetIntegratedLoudness(); };
+    addAndMakeVisible (loudnessResetButton);
+
+    linkLabel.setText ("LINK", juce::dontSendNotification);
+    linkLabel.setJustificationType (juce::Justification::centredLeft);
+    linkLabel.setColour (juce::Label::textColourId, juce::Colours::white.withAlpha (0.9f));
+    linkLabel.setFont (juce::FontOptions { 14.0f, juce::Font::bold });
+    addAndMakeVisible (linkLabel);
+
+    linkGroupEditor.setText (processor.getLinkGroup(), juce::dontSendNotification);
+    linkGroupEditor.setTextToShowWhenEmpty ("off", juce::Colours::white.withAlpha (0.4f));
+    linkGroupEditor.setColour (juce::TextEditor::backgroundColourId, juce::Colours::white.withAlpha (0.08f));
+    linkGroupEditor.setColour (juce::TextEditor::textColourId, juce::Colours::white.withAlpha (0.9f));
+    linkGroupEditor.setColour (juce::TextEditor::outlineColourId, juce::Colours::white.withAlpha (0.2f));
+    linkGroupEditor.onReturnKey = [this] { processor.setLinkGroup (linkGroupEditor.getText()); };
+    linkGroupEditor.onFocusLost = [this] { processor.setLinkGroup (linkGroupEditor.getText()); };
+    addAndMakeVisible (linkGroupEditor);
+
+    linkMembersLabel.setJustificationType (juce::Justification::centredRight);
+    linkMembersLabel.setColour (juce::Label::textColourId, juce::Colours::white.withAlpha (0.85f));
+    linkMembersLabel.setFont (juce::FontOptions { 13.0f, juce::Font::bold });
+    addAndMakeVisible (linkMembersLabel);
+
+    addAndMakeVisible (sidechainSpectrum);
+    addAndMakeVisible (levelHistory);
+    addAndMakeVisible (transferCurve);
+
     timingModeParam = processor.getAPVTS().getRawParameterValue (Parameters::IDs::timingMode);
     characterParam = processor.getAPVTS().getRawParameterValue (Parameters::IDs::character);
 
@@ -137,8 +241,31 @@ TwoCCompressorAudioProcessorEditor::TwoCCompressorAudioProcessorEditor (TwoCComp
     addAndMakeVisible (grMeter);
     addAndMakeVisible (outputMeter);
 
+   #if TWOC_STAGE_PROFILER
+    stageProfileButton.setButtonText ("PROF");
+    stageProfileButton.setClickingTogglesState (true);
+    stageProfileButton.onClick = [this]
+    {
+        stageProfileOverlay.setVisible (stageProfileButton.getToggleState());
+        stageProfileOverlay.refresh();
+    };
+    addAndMakeVisible (stageProfileButton);
+    addChildComponent (stageProfileOverlay);
+   #endif
+
+    processor.getAPVTS().addParameterListener (Parameters::IDs::timingMode, this);
+    processor.getAPVTS().addParameterListener (Parameters::IDs::character, this);
+    handleAsyncUpdate();
+
     timerCallback();
-    startTimerHz (60);
+    startTimerHz (10);
+}
+
+TwoCCompressorAudioProcessorEditor::~TwoCCompressorAudioProcessorEditor()
+{
+    meterVBlank.reset();
+    processor.getAPVTS().removeParameterListener (Parameters::IDs::timingMode, this);
+    processor.getAPVTS().removeParameterListener (Parameters::IDs::character, this);
 }
 
 void TwoCCompressorAudioProcessorEditor::paint (juce::Graphics& g)
@@ -172,6 +299,14 @@ void TwoCCompressorAudioProcessorEditor::resized()
     auto utilityRow = controlsArea.removeFromBottom (34);
     controlsArea.removeFromBottom (10);
 
+    auto analysisStrip = controlsArea.removeFromBottom (130);
+    controlsArea.removeFromBottom (10);
+    transferCurve.setBounds (analysisStrip.removeFromRight (analysisStrip.getHeight()));
+    analysisStrip.removeFromRight (10);
+    sidechainSpectrum.setBounds (analysisStrip.removeFromLeft (analysisStrip.proportionOfWidth (0.45f)));
+    analysisStrip.removeFromLeft (10);
+    levelHistory.setBounds (analysisStrip);
+
     juce::Grid grid;
     grid.templateRows = {
         juce::Grid::TrackInfo (1_fr),
@@ -265,9 +400,43 @@ void TwoCCompressorAudioProcessorEditor::resized()
 
     auto meterHeader = meterArea.removeFromTop (28);
     meterTitle.setBounds (meterHeader.removeFromLeft (meterHeader.proportionOfWidth (0.5f)));
+   #if TWOC_STAGE_PROFILER
+    stageProfileButton.setBounds (meterHeader.removeFromLeft (44).reduced (0, 3));
+   #endif
     osModeInUseLabel.setBounds (meterHeader);
     meterArea.removeFromTop (10);
 
+    auto truePeakRow = meterArea.removeFromBottom (28);
+    meterArea.removeFromBottom (10);
+    truePeakButton.setBounds (truePeakRow.removeFromLeft (52));
+    ecoButton.setBounds (truePeakRow.removeFromRight (60));
+    truePeakCeilingSlider.setBounds (truePeakRow);
+
+    auto linkRow = meterArea.removeFromBottom (24);
+    meterArea.removeFromBottom (8);
+    linkLabel.setBounds (linkRow.removeFromLeft (52));
+    linkMembersLabel.setBounds (linkRow.removeFromRight (60));
+    linkGroupEditor.setBounds (linkRow);
+
+    auto presetStoreRow = meterArea.removeFromBottom (24);
+    meterArea.removeFromBottom (6);
+    presetCompareButton.setBounds (presetStoreRow.removeFromLeft (52));
+    const auto storeButtonWidth = presetStoreRow.getWidth() / static_cast<int> (presetStoreButtons.size());
+
+    for (auto& button : presetStoreButtons)
+        button.setBounds (presetStoreRow.removeFromLeft (storeButtonWidth).reduced (2, 0));
+
+    auto presetMorphRow = meterArea.removeFromBottom (24);
+    meterArea.removeFromBottom (8);
+    presetRecallButtons.front().setBounds (presetMorphRow.removeFromLeft (28));
+    presetRecallButtons.back().setBounds (presetMorphRow.removeFromRight (28));
+    presetMorphSlider.setBounds (presetMorphRow.reduced (4, 0));
+
+    auto loudnessRow = meterArea.removeFromBottom (32);
+    meterArea.removeFromBottom (8);
+    loudnessResetButton.setBounds (loudnessRow.removeFromRight (36).withSizeKeepingCentre (36, 22));
+    loudnessLabel.setBounds (loudnessRow);
+
     juce::Grid meterGrid;
     meterGrid.templateRows = { juce::Grid::TrackInfo (1_fr) };
     meterGrid.templateColumns = {
@@ -282,30 +451,189 @@ void TwoCCompressorAudioProcessorEditor::resized()
         juce::GridItem (outputMeter)
     };
     meterGrid.performLayout (meterArea);
+
+   #if TWOC_STAGE_PROFILER
+    stageProfileOverlay.setBounds (meterArea.withHeight (juce::jmin (meterArea.getHeight(), 150)));
+   #endif
+}
+
+void TwoCCompressorAudioProcessorEditor::visibilityChanged()
+{
+    updateLiveState();
+}
+
+void TwoCCompressorAudioProcessorEditor::parentHierarchyChanged()
+{
+    updateLiveState();
 }
 
+// Meters, frames and the spectrum feed only run while the editor is on screen. Hidden or
+// minimised, it lets go of its consumers, so the audio thread skips metering too, and
+// drops the vblank callback; the slow timer then only checks whether it is back.
+void TwoCCompressorAudioProcessorEditor::updateLiveState()
+{
+    const auto shouldBeLive = isShowing();
+
+    if (shouldBeLive == live)
+        return;
+
+    live = shouldBeLive;
+    sidechainSpectrum.setActive (live);
+
+    if (live)
+    {
+        meterConsumer.emplace (processor);
+        levelHistory.markGap();
+        meterVBlank = std::make_unique<juce::VBlankAttachment> (this, [this] { refreshMeters(); });
+    }
+    else
+    {
+        meterVBlank.reset();
+        meterConsumer.reset();
+    }
+}
+
+// Once per display refresh.
+void TwoCCompressorAudioProcessorEditor::refreshMeters()
+{
+    inputMeter.setDbValue (processor.inputMeterDb.load (std::memory_order_relaxed));
+    grMeter.setDbValue (processor.gainReductionDb.load (std::memory_order_relaxed));
+    outputMeter.setDbValue (processor.outputMeterDb.load (std::memory_order_relaxed));
+    drainMeterFrames();
+    levelHistory.update();
+    transferCurve.update();
+}
+
+// Parameters can change on any thread; the mode switches follow on the message thread.
+void TwoCCompressorAudioProcessorEditor::parameterChanged (const juce::String&, float)
+{
+    triggerAsyncUpdate();
+}
+
+void TwoCCompressorAudioProcessorEditor::handleAsyncUpdate()
+{
+    updateTimingControlState();
+    updateCharacterControlState();
+}
+
+// Readouts of processor state that has no parameter to listen to, at 10 Hz.
 void TwoCCompressorAudioProcessorEditor::timerCallback()
 {
-    const auto in = processor.inputMeterDb.load (std::memory_order_relaxed);
-    const auto gr = processor.gainReductionDb.load (std::memory_order_relaxed);
-    const auto out = processor.outputMeterDb.load (std::memory_order_relaxed);
-    const auto osModeInUse = processor.osModeInUse.load (std::memory_order_relaxed);
+    updateLiveState();
 
-    inputMeter.setDbValue (in);
-    grMeter.setDbValue (gr);
-    outputMeter.setDbValue (out);
+    if (! live)
+        return;
+
+    const auto osModeInUse = processor.osModeInUse.load (std::memory_order_relaxed);
+    const auto osSkipped = processor.osSkippedLastBlock.load (std::memory_order_relaxed);
 
     juce::String osText = "OS: Off";
     if (osModeInUse == 1)
         osText = "OS: 2x";
     else if (osModeInUse == 2)
         osText = "OS: 4x";
+    else if (osSkipped)
+        osText = osModeBox.getSelectedItemIndex() == 2 ? "OS: 4x (skip)" : "OS: 2x (skip)";
+
+    // Eco tier 0 is full quality; anything above it is a step down the governor has taken.
+    if (const auto tier = processor.qualityTier.load (std::memory_order_relaxed); tier > 0)
+        osText << "  ECO " << tier;
 
     if (osModeInUseLabel.getText() != osText)
         osModeInUseLabel.setText (osText, juce::dontSendNotification);
 
-    updateTimingControlState();
-    updateCharacterControlState();
+    // Group name follows state recalls; member count follows other instances joining.
+    if (! linkGroupEditor.hasKeyboardFocus (true) && linkGroupEditor.getText() != processor.getLinkGroup())
+        linkGroupEditor.setText (processor.getLinkGroup(), juce::dontSendNotification);
+
+    const auto linkMembers = processor.getLinkGroupSize();
+    const auto linkText = linkMembers > 0 ? juce::String (linkMembers) + " in grp" : juce::String();
+
+    if (linkMembersLabel.getText() != linkText)
+        linkMembersLabel.setText (linkText, juce::dontSendNotification);
+
+    // Momentary, short-term and integrated LUFS, input over output.
+    const auto formatLufs = [] (float lufs)
+    {
+        return lufs <= LoudnessMeter::minimumLufs ? juce::String ("-inf") : juce::String (lufs, 1);
+    };
+
+    const auto loudnessText = "IN   M " + formatLufs (processor.inputMomentaryLufs.load (std::memory_order_relaxed))
+                            + "  S " + formatLufs (processor.inputShortTermLufs.load (std::memory_order_relaxed))
+                            + "  I " + formatLufs (processor.inputIntegratedLufs.load (std::memory_order_relaxed))
+                            + "\nOUT M " + formatLufs (processor.outputMomentaryLufs.load (std::memory_order_relaxed))
+                            + "  S " + formatLufs (processor.outputShortTermLufs.load (std::memory_order_relaxed))
+                            + "  I " + formatLufs (processor.outputIntegratedLufs.load (std::memory_order_relaxed));
+
+    if (loudnessLabel.getText() != loudnessText)
+        loudnessLabel.setText (loudnessText, juce::dontSendNotification);
+
+    // Lit: the slot Morph sits nearest. Dimmed: nothing stored there yet.
+    const auto morph = presetMorphSlider.getValue();
+
+    for (size_t i = 0; i < presetRecallButtons.size(); ++i)
+    {
+        auto& button = presetRecallButtons[i];
+        const auto slotPosition = static_cast<double> (i) / static_cast<double> (presetRecallButtons.size() - 1);
+        button.setToggleState (std::abs (morph - slotPosition) < 0.5, juce::dontSendNotification);
+        button.setAlpha (processor.isPresetSlotStored (static_cast<int> (i)) ? 1.0f : 0.5f);
+    }
+
+   #if TWOC_STAGE_PROFILER
+    if (stageProfileOverlay.isVisible())
+        stageProfileOverlay.refresh();
+   #endif
+}
+
+// Every block since the last tick goes into the history, and is folded into one frame for
+// the meters, so peaks between ticks show.
+// With blocks longer than a tick some ticks see none; the last range then stays up a
+// little while before it clears.
+void TwoCCompressorAudioProcessorEditor::drainMeterFrames()
+{
+    if (! meterConsumer.has_value())
+        return;
+
+    std::array<MeterFrame, 64> frames;
+    MeterFrame combined;
+    auto received = 0;
+    const auto sampleRate = processor.getSampleRate();
+
+    for (auto count = meterConsumer->popFrames (frames.data(), static_cast<int> (frames.size())); count > 0;
+         count = meterConsumer->popFrames (frames.data(), static_cast<int> (frames.size())))
+    {
+        for (auto i = 0; i < count; ++i)
+        {
+            levelHistory.addFrame (frames[static_cast<size_t> (i)], sampleRate);
+
+            if (received++ == 0)
+                combined = frames[static_cast<size_t> (i)];
+            else
+                combined.merge (frames[static_cast<size_t> (i)]);
+        }
+    }
+
+    // Keeps clearing while idle, which also lets the peak holds expire.
+    if (received == 0)
+    {
+        ticksWithoutMeterFrames = juce::jmin (ticksWithoutMeterFrames + 1, 15);
+
+        if (ticksWithoutMeterFrames == 15)
+        {
+            inputMeter.setBlockRangeDb (-100.0f, -100.0f);
+            grMeter.setBlockRangeDb (0.0f, 0.0f);
+            outputMeter.setBlockRangeDb (-100.0f, -100.0f);
+        }
+
+        return;
+    }
+
+    ticksWithoutMeterFrames = 0;
+
+    const auto toDb = [] (float gain) { return juce::Decibels::gainToDecibels (gain, -100.0f); };
+    inputMeter.setBlockRangeDb (toDb (combined.inputRms), toDb (combined.inputPeak));
+    grMeter.setBlockRangeDb (combined.minGainReductionDb, combined.maxGainReductionDb);
+    outputMeter.setBlockRangeDb (toDb (combined.outputRms), toDb (combined.outputPeak));
 }
 
 void TwoCCompressorAudioProcessorEditor::setupControl (ParameterControl& control, const juce::String& name, const juce::String& parameterID)
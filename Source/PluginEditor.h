@@ -1,19 +1,28 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <optional>
 
 #include "PluginProcessor.h"
+#include "UI/LevelHistoryComponent.h"
 #include "UI/MeterComponent.h"
+#include "UI/SidechainSpectrumComponent.h"
+#include "UI/TransferCurveComponent.h"
+#include "UI/StageProfileOverlay.h"
 
 class TwoCCompressorAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                           private juce::Timer
+                                           private juce::Timer,
+                                           private juce::AudioProcessorValueTreeState::Listener,
+                                           private juce::AsyncUpdater
 {
 public:
     explicit TwoCCompressorAudioProcessorEditor (TwoCCompressorAudioProcessor&);
-    ~TwoCCompressorAudioProcessorEditor() override = default;
+    ~TwoCCompressorAudioProcessorEditor() override;
 
     void paint (juce::Graphics&) override;
     void resized() override;
+    void visibilityChanged() override;
+    void parentHierarchyChanged() override;
 
 private:
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
@@ -28,11 +37,21 @@ private:
     };
 
     void timerCallback() override;
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    void updateLiveState();
+    void refreshMeters();
+    void drainMeterFrames();
     void setupControl (ParameterControl& control, const juce::String& name, const juce::String& parameterID);
     void updateTimingControlState();
     void updateCharacterControlState();
 
     TwoCCompressorAudioProcessor& processor;
+    // Held only while the editor is on screen; see updateLiveState().
+    std::optional<TwoCCompressorAudioProcessor::MeterConsumer> meterConsumer;
+    std::unique_ptr<juce::VBlankAttachment> meterVBlank;
+    bool live = false;
+    int ticksWithoutMeterFrames = 0;
 
     std::array<ParameterControl, 12> controls;
 
@@ -57,12 +76,42 @@ private:
     juce::ToggleButton autoMakeupButton;
     std::unique_ptr<ButtonAttachment> autoMakeupAttachment;
 
+    juce::ToggleButton truePeakButton;
+    std::unique_ptr<ButtonAttachment> truePeakAttachment;
+    juce::Slider truePeakCeilingSlider;
+    std::unique_ptr<SliderAttachment> truePeakCeilingAttachment;
+    juce::ToggleButton ecoButton;
+    std::unique_ptr<ButtonAttachment> ecoAttachment;
+
+    juce::ToggleButton presetCompareButton;
+    std::unique_ptr<ButtonAttachment> presetCompareAttachment;
+    std::array<juce::TextButton, PresetSlots::numSlots> presetStoreButtons;
+    std::array<juce::TextButton, PresetSlots::numSlots> presetRecallButtons;
+    juce::Slider presetMorphSlider;
+    std::unique_ptr<SliderAttachment> presetMorphAttachment;
+
+    juce::Label loudnessLabel;
+    juce::TextButton loudnessResetButton;
+
+    juce::Label linkLabel;
+    juce::TextEditor linkGroupEditor;
+    juce::Label linkMembersLabel;
+
+    SidechainSpectrumComponent sidechainSpectrum;
+    LevelHistoryComponent levelHistory;
+    TransferCurveComponent transferCurve;
+
     juce::Label meterTitle;
     juce::Label osModeInUseLabel;
     MeterComponent inputMeter;
     MeterComponent grMeter;
     MeterComponent outputMeter;
 
+   #if TWOC_STAGE_PROFILER
+    juce::TextButton stageProfileButton;
+    StageProfileOverlay stageProfileOverlay;
+   #endif
+
     bool manualTimingEnabled = true;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TwoCCompressorAudioProcessorEditor)
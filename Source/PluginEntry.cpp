@@ -1,6 +1,67 @@
 #include "PluginProcessor.h"
 
+#include <cstring>
+
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new TwoCCompressorAudioProcessor();
 }
+
+// Everything below is for tools/vst3_harness and only exported from TWOC_TEST_HOOKS builds.
+#if TWOC_TEST_HOOKS
+
+ #if JUCE_WINDOWS
+  #define TWOC_PROBE_EXPORT extern "C" __declspec (dllexport)
+ #else
+  #define TWOC_PROBE_EXPORT extern "C" __attribute__ ((visibility ("default")))
+ #endif
+
+// Diagnostics hook for tools/vst3_harness: copies the newest instance's probe report
+// (UTF-8 JSON) into destination and returns its length, or -1 if there is no instance.
+// Returns the required size without copying when capacity is too small.
+TWOC_PROBE_EXPORT int twoCCompressorReadProbe (char* destination, int capacity)
+{
+    const auto report = TwoCCompressorAudioProcessor::createProbeReportForNewestInstance();
+
+    if (report.isEmpty())
+        return -1;
+
+    const auto utf8 = report.toRawUTF8();
+    const auto length = static_cast<int> (std::strlen (utf8));
+
+    if (destination != nullptr && capacity > length)
+        std::memcpy (destination, utf8, static_cast<size_t> (length) + 1);
+
+    return length;
+}
+
+// Test hook for tools/vst3_harness: stores the newest instance's current controls in A/B
+// slot 0 or 1, as the editor's store buttons do. Returns 0, or -1 if there is no instance.
+TWOC_PROBE_EXPORT int twoCCompressorStorePresetSlot (int slot)
+{
+    return TwoCCompressorAudioProcessor::storePresetSlotForNewestInstance (slot) ? 0 : -1;
+}
+
+// Test hook for tools/vst3_harness: attach != 0 gives the newest instance a meter consumer
+// (as an open editor would), 0 takes it away. Returns 0, or -1 if there is no instance.
+TWOC_PROBE_EXPORT int twoCCompressorAttachMeterConsumer (int attach)
+{
+    return TwoCCompressorAudioProcessor::setMeterConsumerForNewestInstance (attach != 0) ? 0 : -1;
+}
+
+// Test hook for tools/vst3_harness: puts the newest instance in the link group named by
+// the UTF-8 string groupName; an empty name leaves. Returns 0, or -1 if there is no instance.
+TWOC_PROBE_EXPORT int twoCCompressorSetLinkGroup (const char* groupName)
+{
+    return TwoCCompressorAudioProcessor::setLinkGroupForNewestInstance (juce::String::fromUTF8 (groupName != nullptr ? groupName : ""))
+               ? 0 : -1;
+}
+
+// Test hook for tools/vst3_harness: scales the block times the newest instance's eco
+// governor sees (at least 1). Returns 0, or -1 if there is no instance.
+TWOC_PROBE_EXPORT int twoCCompressorSetEcoLoadScale (double scale)
+{
+    return TwoCCompressorAudioProcessor::setEcoLoadScaleForNewestInstance (scale) ? 0 : -1;
+}
+
+#endif
@@ -18,31 +18,23 @@ int loadChoiceIndex (const std::atomic<float>* parameter, int fallback, int minV
     return juce::jlimit (minValue, maxValue, static_cast<int> (std::lround (parameter->load (std::memory_order_relaxed))));
 }
 
-float processMeterBuffer (
-    const juce::AudioBuffer<float>& buffer,
-    int channelsToMeasure,
-    MeterBallistics& ballistics) noexcept
+int toChoiceIndex (float value, int minValue, int maxValue) noexcept
 {
-    const auto numChannels = juce::jmin (channelsToMeasure, buffer.getNumChannels());
-    const auto numSamples = buffer.getNumSamples();
-
-    if (numChannels <= 0 || numSamples <= 0)
-        return ballistics.processSample (-100.0f);
-
-    auto smoothedDb = ballistics.getCurrentDb();
-
-    for (auto sample = 0; sample < numSamples; ++sample)
-    {
-        auto samplePeak = 0.0f;
-
-        for (auto channel = 0; channel < numChannels; ++channel)
-            samplePeak = juce::jmax (samplePeak, std::abs (buffer.getSample (channel, sample)));
+    return juce::jlimit (minValue, maxValue, static_cast<int> (std::lround (value)));
+}
 
-        const auto sampleDb = juce::Decibels::gainToDecibels (samplePeak, -100.0f);
-        smoothedDb = ballistics.processSample (sampleDb);
-    }
+// Live instances, newest last, so the harness probe can find the one it just created.
+struct InstanceRegistry
+{
+    juce::CriticalSection lock;
+    juce::Array<TwoCCompressorAudioProcessor*> instances;
+    int lastInstanceId = 0;
+};
 
-    return smoothedDb;
+InstanceRegistry& getInstanceRegistry()
+{
+    static InstanceRegistry registry;
+    return registry;
 }
 }
 
@@ -53,57 +45,166 @@ TwoCCompressorAudioProcessor::TwoCCompressorAudioProcessor()
       apvts (*this, nullptr, "PARAMETERS", Parameters::createParameterLayout())
 {
     cacheParameterPointers();
+    stateEntries = StateFormat::makeEntries (*this, apvts);
+    stateSnapshot.prepare (stateEntries.size());
+    backgroundBuildThread->addTimeSliceClient (this);
+
+    {
+        auto& registry = getInstanceRegistry();
+        const juce::ScopedLock sl (registry.lock);
+        registry.instances.add (this);
+        instanceId = ++registry.lastInstanceId;
+    }
+
+    hostCallTrace = Diagnostics::HostCallTrace::createFromEnvironment (stateEntries);
+
+    // Telemetry is opt-in: a host started with TWOC_TELEMETRY=1 publishes every instance.
+    if (juce::SystemStats::getEnvironmentVariable ("TWOC_TELEMETRY", {}) == "1")
+        telemetry.attach();
+
+}
+
+TwoCCompressorAudioProcessor::~TwoCCompressorAudioProcessor()
+{
+    {
+        auto& registry = getInstanceRegistry();
+        const juce::ScopedLock sl (registry.lock);
+        registry.instances.removeFirstMatchingValue (this);
+    }
+
+    backgroundBuildThread->removeTimeSliceClient (this);
+    cancelPendingUpdate();
+    linkBus->releaseSlot (linkSlot.load (std::memory_order_acquire));
+
+    if (hostCallTrace != nullptr)
+        hostCallTrace->writeToFile();
+
+   #if TWOC_REALTIME_LOG
+    realtimeLogWriter->drain (realtimeLog, instanceId);
+   #endif
 }
 
 void TwoCCompressorAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    processingSampleRate = juce::jmax (1.0, sampleRate);
-    const auto numOutputChannels = juce::jmax (1, getTotalNumOutputChannels());
-    const auto maxBlock = juce::jmax (1, samplesPerBlock);
+    const PreparedConfiguration configuration { juce::jmax (1.0, sampleRate),
+                                                juce::jmax (1, samplesPerBlock),
+                                                juce::jmax (1, getTotalNumOutputChannels()) };
+    const auto numOutputChannels = configuration.numChannels;
+    const auto maxBlock = configuration.maxBlockSize;
+    processingSampleRate = configuration.sampleRate;
+
+    if (hostCallTrace != nullptr)
+        hostCallTrace->recordPrepare (sampleRate, samplesPerBlock, numOutputChannels);
+
+    // Many hosts call prepareToPlay again on transport or graph changes with nothing
+    // changed; then only the DSP state is cleared and every allocation is kept.
+    if (configuration == preparedConfiguration)
+    {
+        compressor.reset();
+        saturationStage.reset();
+        truePeakLimiter.reset();
+        bypassDelay.reset();
+    }
+    else
+    {
+        compressor.init (processingSampleRate, maxBlock);
 
-    compressor.init (processingSampleRate, maxBlock);
+        // All audio-thread scratch and delay state lives in one arena sized for this configuration.
+        // The block-sized scratch regions are all live at once and cannot share memory: the
+        // bypass dry copy is held across the whole of processActive(), the dry copy for the
+        // mix from before the compressor until after saturation, and the stage's scratch and
+        // latency-fade copy across its own process() call. The rest is state kept between blocks.
+        scratchArena.beginLayout();
+        const auto dryRegion = scratchArena.reserveChannels (numOutputChannels, maxBlock);
+        saturationStage.prepare (processingSampleRate, numOutputChannels, maxBlock,
+                                 loadChoiceIndex (osModeParam, 0, 0, 2), scratchArena);
+        truePeakLimiter.prepare (processingSampleRate, numOutputChannels, scratchArena);
+        const auto bypassDryRegion = scratchArena.reserveChannels (numOutputChannels, maxBlock);
+        bypassDelay.prepare (numOutputChannels, truePeakLimiter.getLatencySamples(), scratchArena);
+        scratchArena.allocate();
 
-    dryBuffer.setSize (numOutputChannels, maxBlock, false, false, true);
-    saturationDryBuffer.setSize (numOutputChannels, maxBlock, false, false, true);
+        scratchArena.referTo (dryBuffer, dryRegion, numOutputChannels, maxBlock);
+        scratchArena.referTo (bypassDryBuffer, bypassDryRegion, numOutputChannels, maxBlock);
+        saturationStage.attachScratch (scratchArena);
+        truePeakLimiter.attachScratch (scratchArena);
+        bypassDelay.attachScratch (scratchArena);
+        scratchBytes.store (static_cast<juce::int64> (scratchArena.getSizeInBytes()), std::memory_order_relaxed);
 
-    const auto osChannels = static_cast<size_t> (numOutputChannels);
-    const auto osBlock = static_cast<size_t> (maxBlock);
+        inputMeterBallistics.prepare (processingSampleRate, 10.0f, 300.0f);
+        outputMeterBallistics.prepare (processingSampleRate, 10.0f, 300.0f);
+        inputLoudness.prepare (processingSampleRate);
+        outputLoudness.prepare (processingSampleRate);
+        preparedConfiguration = configuration;
+    }
 
-    oversampling2x = std::make_unique<juce::dsp::Oversampling<float>> (
-        osChannels,
-        1,
-        juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
-        true,
-        false);
+   #if TWOC_REALTIME_LOG
+    nonFiniteRunBlocks = {};
+   #endif
 
-    oversampling4x = std::make_unique<juce::dsp::Oversampling<float>> (
-        osChannels,
-        2,
-        juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
-        true,
-        false);
+    TWOC_RT_LOG (realtimeLog, prepared, maxBlock, static_cast<float> (processingSampleRate), 0.0f);
 
-    oversampling2x->reset();
-    oversampling2x->initProcessing (osBlock);
+    // Hosts expect the latency to be settled when prepareToPlay returns, so it is reported here directly.
+    const auto truePeakEnabled = loadParam (truePeakEnabledParam, 0.0f) >= 0.5f;
+    applyTruePeakLatency (truePeakEnabled);
+    setLatencySamples (reportedLatencySamples.load (std::memory_order_relaxed));
+    truePeakMix = truePeakEnabled ? 1.0f : 0.0f;
+    qualityGovernor.prepare (processingSampleRate);
+    qualityTier.store (QualityGovernor::full, std::memory_order_relaxed);
 
-    oversampling4x->reset();
-    oversampling4x->initProcessing (osBlock);
+    // Start in whichever bypass state the parameter holds; there is nothing to fade from yet.
+    bypassMix = loadParam (bypassParam, 0.0f) >= 0.5f ? 1.0f : 0.0f;
+    bypassFadeStep = 1.0f / static_cast<float> (juce::jmax (1.0, bypassFadeMs * 0.001 * processingSampleRate));
 
-    inputMeterBallistics.prepare (processingSampleRate, 10.0f, 300.0f);
     inputMeterBallistics.reset (-100.0f);
-    outputMeterBallistics.prepare (processingSampleRate, 10.0f, 300.0f);
     outputMeterBallistics.reset (-100.0f);
+    meteringActive = false;
+    lastOutputPeak = 0.0f;
+
+    sidechainDecimation = juce::jmax (1, juce::roundToInt (processingSampleRate / analysisRateHz));
+    sidechainAnalysisRate.store (processingSampleRate / static_cast<double> (sidechainDecimation), std::memory_order_relaxed);
+    sidechainAccumulator = 0.0f;
+    sidechainAccumulated = 0;
+
+   #if TWOC_STAGE_PROFILER
+    stageProfiler.reset();
+   #endif
 
-    autoMakeupAverageGrDb = 0.0f;
-    autoMakeupAppliedDb = 0.0f;
+    // Start the ramps at the current settings (or the current blend of the preset slots)
+    // so the first block does not fade in.
+    morphPosition = juce::jlimit (0.0f, 1.0f, loadParam (presetMorphParam, 0.0f));
+    compareAmount = loadParam (presetCompareParam, 0.0f) >= 0.5f ? 1.0f : 0.0f;
+    PresetSlots::Values values;
+    loadParameterValues (values, 0);
+
+    const auto autoMakeupEnabled = values[Parameters::MorphTargets::autoMakeup] >= 0.5f;
+    inputGainRamp.reset (juce::Decibels::decibelsToGain (values[Parameters::MorphTargets::inputDb]));
+    makeupGainRamp.reset (juce::Decibels::decibelsToGain (autoMakeupEnabled ? 0.0f : values[Parameters::MorphTargets::makeupDb]));
+    mixRamp.reset (juce::jlimit (0.0f, 1.0f, values[Parameters::MorphTargets::mix]));
+    outputGainRamp.reset (juce::Decibels::decibelsToGain (values[Parameters::MorphTargets::outputDb]));
 
     inputMeterDb.store (0.0f);
     outputMeterDb.store (0.0f);
     gainReductionDb.store (0.0f);
+    truePeakReductionDb.store (0.0f);
     osModeInUse.store (0, std::memory_order_relaxed);
+    osSkippedLastBlock.store (false, std::memory_order_relaxed);
 }
 
-void TwoCCompressorAudioProcessor::releaseResources() {}
+void TwoCCompressorAudioProcessor::releaseResources()
+{
+    if (hostCallTrace != nullptr)
+    {
+        hostCallTrace->recordRelease();
+        hostCallTrace->writeToFile();
+    }
+}
+
+// Only traced: every stage already restarts cleanly from prepareToPlay().
+void TwoCCompressorAudioProcessor::reset()
+{
+    if (hostCallTrace != nullptr)
+        hostCallTrace->recordReset();
+}
 
 bool TwoCCompressorAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
@@ -119,171 +220,695 @@ bool TwoCCompressorAudioProcessor::isBusesLayoutSupported (const BusesLayout& la
 void TwoCCompressorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
     juce::ScopedNoDenormals noDenormals;
+    TWOC_PROFILE_BEGIN_BLOCK (stageProfiler);
 
-    const auto numSamples = buffer.getNumSamples();
-    const auto numInputChannels = getTotalNumInputChannels();
-    const auto numOutputChannels = getTotalNumOutputChannels();
+    // Offline renders have no deadline, so eco never degrades them.
+    const auto ecoActive = loadParam (ecoModeParam, 0.0f) >= 0.5f && ! isNonRealtime();
 
-    const auto inputDb = loadParam (inputDbParam, 0.0f);
-    const auto thresholdDb = loadParam (thresholdDbParam, -18.0f);
-    const auto ratio = loadParam (ratioParam, 4.0f);
-    const auto timingMode = loadChoiceIndex (timingModeParam, 0, 0, 3);
-    const auto characterMode = loadChoiceIndex (characterParam, 0, 0, 1);
-    const auto attackMs = loadParam (attackMsParam, 10.0f);
-    const auto releaseMs = loadParam (releaseMsParam, 100.0f);
-    const auto scHpfHz = loadParam (scHpfHzParam, 0.0f);
-    const auto scHpfEnabled = loadParam (scHpfEnabledParam, 1.0f) >= 0.5f;
-    const auto kneeDb = loadParam (kneeDbParam, 6.0f);
-    const auto makeupDb = loadParam (makeupDbParam, 0.0f);
-    const auto autoMakeupEnabled = loadParam (autoMakeupParam, 0.0f) >= 0.5f;
-    const auto satDrive = juce::jlimit (0.0f, 1.0f, loadParam (satDriveParam, 0.0f));
-    const auto satMix = juce::jlimit (0.0f, 1.0f, loadParam (satMixParam, 0.0f));
-    const auto osModeRequested = loadChoiceIndex (osModeParam, 0, 0, 2);
-    const auto mix = juce::jlimit (0.0f, 1.0f, loadParam (mixParam, 1.0f));
-    const auto outputDb = loadParam (outputDbParam, 0.0f);
-    auto osModeAppliedThisBlock = 0;
+    if (hostCallTrace != nullptr)
+        hostCallTrace->recordParameterChanges();
 
-    const auto smoothedInputDb = processMeterBuffer (buffer, numInputChannels, inputMeterBallistics);
-    inputMeterDb.store (smoothedInputDb, std::memory_order_relaxed);
+    const auto startTicks = ecoActive || hostCallTrace != nullptr || telemetry.isAttached() ? juce::Time::getHighResolutionTicks() : juce::int64 { 0 };
 
-    const auto hasDryBufferCapacity = dryBuffer.getNumChannels() >= numOutputChannels
-                                   && dryBuffer.getNumSamples() >= numSamples;
-    const auto useDryMix = mix < 1.0f && hasDryBufferCapacity;
+    updateMeteringState();
+    checkBlockIsFinite (buffer, false);
+    measureLoudness (buffer, false);
+    processWithBypass (buffer, loadParam (bypassParam, 0.0f) >= 0.5f);
+    measureLoudness (buffer, true);
+    checkBlockIsFinite (buffer, true);
+    updateQualityTier (ecoActive, startTicks, buffer.getNumSamples());
+    TWOC_PROFILE_END_BLOCK (stageProfiler, buffer.getNumSamples());
 
-    if (useDryMix)
+    if (telemetry.isAttached())
+        publishTelemetry (buffer, startTicks);
+
+    if (hostCallTrace != nullptr)
+        hostCallTrace->recordProcess (buffer.getNumSamples(),
+                                      static_cast<juce::uint16> (isNonRealtime() ? HostCallTraceFormat::nonRealtime : 0),
+                                      startTicks, juce::Time::getHighResolutionTicks());
+}
+
+// Only reached from hosts that bypass through their own switch despite the parameter.
+void TwoCCompressorAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    juce::ScopedNoDenormals noDenormals;
+    TWOC_PROFILE_BEGIN_BLOCK (stageProfiler);
+
+    if (hostCallTrace != nullptr)
+        hostCallTrace->recordParameterChanges();
+
+    const auto startTicks = hostCallTrace != nullptr || telemetry.isAttached() ? juce::Time::getHighResolutionTicks() : juce::int64 { 0 };
+
+    updateMeteringState();
+    checkBlockIsFinite (buffer, false);
+    measureLoudness (buffer, false);
+    processWithBypass (buffer, true);
+    measureLoudness (buffer, true);
+    checkBlockIsFinite (buffer, true);
+    TWOC_PROFILE_END_BLOCK (stageProfiler, buffer.getNumSamples());
+
+    if (telemetry.isAttached())
+        publishTelemetry (buffer, startTicks);
+
+    if (hostCallTrace != nullptr)
+        hostCallTrace->recordProcess (buffer.getNumSamples(),
+                                      static_cast<juce::uint16> (HostCallTraceFormat::bypassedCall | (isNonRealtime() ? HostCallTraceFormat::nonRealtime : 0)),
+                                      startTicks, juce::Time::getHighResolutionTicks());
+}
+
+// With the diagnostic log compiled in, reports the first NaN or infinity of a run of bad
+// blocks, and how many blocks the run lasted once a clean block ends it, so a stuck NaN
+// costs two records instead of filling the log. Profiled as the diagnostics stage.
+void TwoCCompressorAudioProcessor::checkBlockIsFinite (const juce::AudioBuffer<float>& buffer, bool isOutput) noexcept
+{
+   #if TWOC_REALTIME_LOG
+    TWOC_PROFILE_STAGE (stageProfiler, diagnostics);
+    const auto numChannels = isOutput ? getTotalNumOutputChannels() : getTotalNumInputChannels();
+    auto& runBlocks = nonFiniteRunBlocks[isOutput ? 1 : 0];
+
+    for (auto channel = 0; channel < juce::jmin (numChannels, buffer.getNumChannels()); ++channel)
     {
-        for (auto channel = 0; channel < numOutputChannels; ++channel)
+        if (const auto index = Diagnostics::findNonFinite (buffer.getReadPointer (channel), buffer.getNumSamples()); index >= 0)
         {
-            if (channel < numInputChannels)
-                dryBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+            if (runBlocks++ > 0)
+                return;
+
+            if (isOutput)
+                TWOC_RT_LOG (realtimeLog, nonFiniteOutput, channel, static_cast<float> (index), 0.0f);
             else
-                dryBuffer.clear (channel, 0, numSamples);
+                TWOC_RT_LOG (realtimeLog, nonFiniteInput, channel, static_cast<float> (index), 0.0f);
+
+            return;
         }
     }
 
-    for (auto channel = numInputChannels; channel < numOutputChannels; ++channel)
-        buffer.clear (channel, 0, numSamples);
+    if (runBlocks > 0)
+    {
+        TWOC_RT_LOG (realtimeLog, nonFiniteCleared, runBlocks, isOutput ? 1.0f : 0.0f, 0.0f);
+        runBlocks = 0;
+    }
+   #else
+    juce::ignoreUnused (buffer, isOutput);
+   #endif
+}
 
-    // Wet path: Input trim -> Compressor -> Makeup -> Saturation
-    buffer.applyGain (juce::Decibels::decibelsToGain (inputDb));
-
-    CompressorDSP::Parameters compressorParams;
-    compressorParams.thresholdDb = thresholdDb;
-    compressorParams.ratio = ratio;
-    compressorParams.timingMode = timingMode;
-    compressorParams.characterMode = characterMode;
-    compressorParams.attackMs = attackMs;
-    compressorParams.releaseMs = releaseMs;
-    compressorParams.scHpfHz = scHpfHz;
-    compressorParams.scHpfEnabled = scHpfEnabled;
-    compressorParams.kneeDb = kneeDb;
-    compressor.setParameters (compressorParams);
-    compressor.processBlock (buffer);
-
-    const auto currentGainReductionDb = juce::jmax (0.0f, compressor.getMeterGainReductionDb());
-    const auto blockSeconds = static_cast<float> (numSamples / processingSampleRate);
-
-    const auto smoothingCoeffForSeconds = [] (float tauSeconds, float dtSeconds) noexcept
-    {
-        const auto tau = juce::jmax (0.001f, tauSeconds);
-        const auto dt = juce::jmax (0.000001f, dtSeconds);
-        return std::exp (-dt / tau);
-    };
+void TwoCCompressorAudioProcessor::measureLoudness (const juce::AudioBuffer<float>& buffer, bool isOutput) noexcept
+{
+    if (! meteringActive)
+        return;
 
-    constexpr auto avgAttackSeconds = 0.8f;
-    constexpr auto avgReleaseSeconds = 1.8f;
-    const auto avgCoeff = smoothingCoeffForSeconds (
-        currentGainReductionDb > autoMakeupAverageGrDb ? avgAttackSeconds : avgReleaseSeconds,
-        blockSeconds);
-    autoMakeupAverageGrDb = avgCoeff * autoMakeupAverageGrDb + (1.0f - avgCoeff) * currentGainReductionDb;
+    TWOC_PROFILE_STAGE (stageProfiler, metering);
 
-    constexpr auto autoCompensationRatio = 0.72f;
-    const auto autoMakeupTargetDb = juce::jlimit (0.0f, 18.0f, autoMakeupAverageGrDb * autoCompensationRatio);
+    if (isOutput)
+    {
+        outputLoudness.process (buffer, getTotalNumOutputChannels());
+        outputMomentaryLufs.store (outputLoudness.getMomentaryLufs(), std::memory_order_relaxed);
+        outputShortTermLufs.store (outputLoudness.getShortTermLufs(), std::memory_order_relaxed);
+        outputIntegratedLufs.store (outputLoudness.getIntegratedLufs(), std::memory_order_relaxed);
+        return;
+    }
+
+    if (loudnessResetRequested.load (std::memory_order_relaxed) && loudnessResetRequested.exchange (false, std::memory_order_acquire))
+    {
+        inputLoudness.resetIntegrated();
+        outputLoudness.resetIntegrated();
+    }
+
+    inputLoudness.process (buffer, getTotalNumInputChannels());
+    inputMomentaryLufs.store (inputLoudness.getMomentaryLufs(), std::memory_order_relaxed);
+    inputShortTermLufs.store (inputLoudness.getShortTermLufs(), std::memory_order_relaxed);
+    inputIntegratedLufs.store (inputLoudness.getIntegratedLufs(), std::memory_order_relaxed);
+}
+
+// Feeds the editor's spectrum with what the detector sees, before its HPF. A box average
+// over each decimation stride is the only anti-aliasing; that is plenty for a display of
+// where the low end sits, and the FFT work stays on the reader's side.
+void TwoCCompressorAudioProcessor::pushSidechainSpectrum (const juce::AudioBuffer<float>& buffer, int numChannels) noexcept
+{
+    TWOC_PROFILE_STAGE (stageProfiler, metering);
 
-    constexpr auto appliedMakeupSmoothingSeconds = 1.2f;
-    const auto appliedCoeff = smoothingCoeffForSeconds (appliedMakeupSmoothingSeconds, blockSeconds);
-    autoMakeupAppliedDb = appliedCoeff * autoMakeupAppliedDb + (1.0f - appliedCoeff) * autoMakeupTargetDb;
+    numChannels = juce::jmin (numChannels, buffer.getNumChannels());
 
-    const auto effectiveMakeupDb = autoMakeupEnabled ? autoMakeupAppliedDb : makeupDb;
-    buffer.applyGain (juce::Decibels::decibelsToGain (effectiveMakeupDb));
+    if (numChannels <= 0)
+        return;
 
-    if (satDrive > 0.0001f && satMix > 0.0001f)
+    const auto scale = 1.0f / static_cast<float> (numChannels * sidechainDecimation);
+    std::array<float, 256> decimated;
+    auto count = 0;
+
+    for (auto sample = 0; sample < buffer.getNumSamples(); ++sample)
     {
-        const auto use2x = (osModeRequested == 1 && oversampling2x != nullptr);
-        const auto use4x = (osModeRequested == 2 && oversampling4x != nullptr);
-        const auto useOversampledPath = use2x || use4x;
-        auto effectiveSatMix = satMix;
+        for (auto channel = 0; channel < numChannels; ++channel)
+            sidechainAccumulator += buffer.getSample (channel, sample);
+
+        if (++sidechainAccumulated < sidechainDecimation)
+            continue;
 
-        if (useOversampledPath && satMix < 0.999f)
+        decimated[static_cast<size_t> (count++)] = sidechainAccumulator * scale;
+        sidechainAccumulator = 0.0f;
+        sidechainAccumulated = 0;
+
+        if (count == static_cast<int> (decimated.size()))
         {
-            const auto hasSatBlendBufferCapacity = saturationDryBuffer.getNumChannels() >= numOutputChannels
-                                                && saturationDryBuffer.getNumSamples() >= numSamples;
-
-            if (hasSatBlendBufferCapacity)
-            {
-                for (auto channel = 0; channel < numOutputChannels; ++channel)
-                    saturationDryBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
-            }
-            else
-            {
-                effectiveSatMix = 1.0f;
-            }
+            sidechainFifo.push (decimated.data(), count);
+            count = 0;
         }
+    }
 
-        auto wetBlock = juce::dsp::AudioBlock<float> (buffer);
+    sidechainFifo.push (decimated.data(), count);
+}
+
+// One seqlocked cache-line write into this instance's shared-memory telemetry slot, from
+// levels the block already produced: the compressor's detector peak and gain reduction,
+// and the output peak from the meter pass when a consumer runs it. Telemetry does not
+// run the meters itself; without them the output peak is one vectorised scan of the
+// block, which is still in cache.
+void TwoCCompressorAudioProcessor::publishTelemetry (const juce::AudioBuffer<float>& buffer, juce::int64 startTicks) noexcept
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto bypassed = bypassMix >= 1.0f;
+    auto outputPeak = lastOutputPeak;
+
+    if (! meteringActive)
+    {
+        outputPeak = 0.0f;
+
+        for (auto channel = 0; channel < juce::jmin (getTotalNumOutputChannels(), buffer.getNumChannels()); ++channel)
+            outputPeak = juce::jmax (outputPeak, buffer.getMagnitude (channel, 0, numSamples));
+    }
 
-        if (use2x)
+    const auto endTicks = juce::Time::getHighResolutionTicks();
+    const auto elapsedUs = juce::Time::highResolutionTicksToSeconds (endTicks - startTicks) * 1.0e6;
+    const auto budgetUs = 1.0e6 * static_cast<double> (numSamples) / processingSampleRate;
+
+    TelemetryFormat::Sample sample;
+    sample.instanceId = instanceId;
+    sample.blockSize = numSamples;
+    sample.sampleRate = static_cast<float> (processingSampleRate);
+    sample.cpuUs = static_cast<float> (elapsedUs);
+    sample.cpuLoad = budgetUs > 0.0 ? static_cast<float> (elapsedUs / budgetUs) : 0.0f;
+    sample.outputDb = juce::Decibels::gainToDecibels (outputPeak, -120.0f);
+
+    // Bypassed, the output is the (delayed) input and the compressor only tracks it.
+    sample.inputDb = bypassed ? sample.outputDb : compressor.getLastBlockDetectorDb();
+    sample.gainReductionDb = bypassed ? 0.0f : compressor.getLastGainReductionDb();
+    sample.osMode = osModeInUse.load (std::memory_order_relaxed);
+    sample.blocks = ++telemetryBlocks;
+
+    // The wall clock is read every 1024 blocks; in between the tick counter advances it.
+    if (sample.blocks % 1024 == 1)
+        telemetryEpochMs = static_cast<double> (juce::Time::currentTimeMillis()) - juce::Time::highResolutionTicksToSeconds (endTicks) * 1000.0;
+
+    sample.updatedMs = static_cast<std::int64_t> (telemetryEpochMs + juce::Time::highResolutionTicksToSeconds (endTicks) * 1000.0);
+
+    if (sample.inputDb <= TelemetryFormat::silenceDb && sample.outputDb <= TelemetryFormat::silenceDb)
+        sample.flags |= TelemetryFormat::silent;
+
+    if (bypassed)
+        sample.flags |= TelemetryFormat::bypassed;
+
+    if (qualityTier.load (std::memory_order_relaxed) != QualityGovernor::full)
+        sample.flags |= TelemetryFormat::eco;
+
+    telemetry.publish (sample);
+}
+
+juce::AudioProcessorParameter* TwoCCompressorAudioProcessor::getBypassParameter() const
+{
+    return apvts.getParameter (Parameters::IDs::bypass);
+}
+
+void TwoCCompressorAudioProcessor::processWithBypass (juce::AudioBuffer<float>& buffer, bool bypassed)
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto numInputChannels = getTotalNumInputChannels();
+    const auto numOutputChannels = getTotalNumOutputChannels();
+
+    for (auto channel = numInputChannels; channel < numOutputChannels; ++channel)
+        buffer.clear (channel, 0, numSamples);
+
+    if (numSamples > preparedConfiguration.maxBlockSize)
+        TWOC_RT_LOG (realtimeLog, blockTooLarge, numSamples, static_cast<float> (preparedConfiguration.maxBlockSize), 0.0f);
+
+    // Latency follows the true-peak switch in both states, so the bypassed dry path always
+    // lines up with what the host compensates for.
+    const auto truePeakEnabled = loadParam (truePeakEnabledParam, 0.0f) >= 0.5f;
+
+    if (truePeakEnabled != truePeakLatencyApplied)
+        applyTruePeakLatency (truePeakEnabled);
+
+    const auto targetMix = bypassed ? 1.0f : 0.0f;
+
+    if (bypassMix == targetMix)
+    {
+        if (bypassed)
         {
-            auto upsampledBlock = oversampling2x->processSamplesUp (wetBlock);
-            saturation.processInPlace (upsampledBlock, satDrive, 1.0f);
-            oversampling2x->processSamplesDown (wetBlock);
-            osModeAppliedThisBlock = 1;
+            processBypassed (buffer);
+            return;
         }
-        else if (use4x)
+
+        // Keep the dry delay filled so a later bypass starts from the right audio.
         {
-            auto upsampledBlock = oversampling4x->processSamplesUp (wetBlock);
-            saturation.processInPlace (upsampledBlock, satDrive, 1.0f);
-            oversampling4x->processSamplesDown (wetBlock);
-            osModeAppliedThisBlock = 2;
+            TWOC_PROFILE_STAGE (stageProfiler, bypass);
+            bypassDelay.push (buffer, numOutputChannels);
         }
-        else
+
+        processActive (buffer);
+        return;
+    }
+
+    // Saturation sat idle while bypassed and restarts clean; the compressor kept tracking
+    // and the true-peak limiter was kept primed, so its delay line already holds audio.
+    if (bypassMix >= 1.0f)
+        saturationStage.reset();
+
+    const auto hasCapacity = bypassDryBuffer.getNumChannels() >= numOutputChannels
+                          && bypassDryBuffer.getNumSamples() >= numSamples;
+
+    if (! hasCapacity)
+    {
+        TWOC_RT_LOG (realtimeLog, bypassFadeCapacityFallback, numSamples, 0.0f, 0.0f);
+        bypassMix = targetMix;
+        processActive (buffer);
+        return;
+    }
+
+    // Crossfade between the processed block and the latency-matched dry copy of it.
+    juce::AudioBuffer<float> dry (bypassDryBuffer.getArrayOfWritePointers(), numOutputChannels, numSamples);
+
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, bypass);
+
+        for (auto channel = 0; channel < numOutputChannels; ++channel)
+            dry.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+
+        bypassDelay.process (dry, numOutputChannels);
+    }
+
+    processActive (buffer);
+
+    auto mixAtEnd = bypassMix;
+
+    for (auto channel = 0; channel < numOutputChannels; ++channel)
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, bypass);
+        auto* wet = buffer.getWritePointer (channel);
+        const auto* delayedDry = dry.getReadPointer (channel);
+        auto amount = bypassMix;
+
+        for (auto sample = 0; sample < numSamples; ++sample)
         {
-            saturation.processInPlace (wetBlock, satDrive, effectiveSatMix);
-            effectiveSatMix = 1.0f;
-            osModeAppliedThisBlock = 0;
+            amount = bypassed ? juce::jmin (1.0f, amount + bypassFadeStep)
+                              : juce::jmax (0.0f, amount - bypassFadeStep);
+            wet[sample] += amount * (delayedDry[sample] - wet[sample]);
         }
 
-        if (useOversampledPath && effectiveSatMix < 0.999f)
-        {
-            const auto cleanSatBlend = 1.0f - effectiveSatMix;
+        mixAtEnd = amount;
+    }
 
-            for (auto channel = 0; channel < numOutputChannels; ++channel)
-            {
-                buffer.applyGain (channel, 0, numSamples, effectiveSatMix);
-                buffer.addFrom (channel, 0, saturationDryBuffer, channel, 0, numSamples, cleanSatBlend);
-            }
-        }
+    bypassMix = mixAtEnd;
+}
+
+// Fully bypassed: the only audio work is the latency-matched copy. The compressor follows
+// the input cheaply so it resumes near the right gain, and the true-peak limiter takes
+// the input into its delay line so un-bypassing does not start from its silence.
+void TwoCCompressorAudioProcessor::processBypassed (juce::AudioBuffer<float>& buffer)
+{
+    const auto numOutputChannels = getTotalNumOutputChannels();
+    MeterFrame meterFrame;
+
+    if (meteringActive)
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, metering);
+        inputMeterDb.store (inputMeterBallistics.processBuffer (buffer, getTotalNumInputChannels(), meterFramesRead), std::memory_order_relaxed);
+        meterFrame.inputPeak = inputMeterBallistics.getBlockPeak();
+        meterFrame.inputRms = inputMeterBallistics.getBlockRms();
+    }
+
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, bypass);
+        compressor.setMeteringEnabled (false);
+        compressor.trackIdle (buffer, juce::Decibels::decibelsToGain (loadParam (inputDbParam, 0.0f)));
+
+        truePeakLimiter.prime (buffer);
+        truePeakMix = truePeakLatencyApplied ? 1.0f : 0.0f;
+        bypassDelay.process (buffer, numOutputChannels);
+    }
+
+    if (meteringActive)
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, metering);
+        outputMeterDb.store (outputMeterBallistics.processBuffer (buffer, numOutputChannels, meterFramesRead), std::memory_order_relaxed);
+        gainReductionDb.store (0.0f, std::memory_order_relaxed);
+        truePeakReductionDb.store (0.0f, std::memory_order_relaxed);
+        gainComputerInputDb.store (-120.0f, std::memory_order_relaxed);
+
+        meterFrame.outputPeak = outputMeterBallistics.getBlockPeak();
+        meterFrame.outputRms = outputMeterBallistics.getBlockRms();
+        meterFrame.numSamples = buffer.getNumSamples();
+        meterFrames.push (meterFrame);
+        lastOutputPeak = meterFrame.outputPeak;
+    }
+
+    osModeInUse.store (0, std::memory_order_relaxed);
+    osSkippedLastBlock.store (false, std::memory_order_relaxed);
+}
+
+void TwoCCompressorAudioProcessor::updateQualityTier (bool ecoActive, juce::int64 startTicks, int numSamples) noexcept
+{
+    if (! ecoActive)
+    {
+        if (qualityGovernor.getTier() != QualityGovernor::full)
+            qualityGovernor.reset();
+
+        qualityTier.store (QualityGovernor::full, std::memory_order_relaxed);
+        ecoLoad.store (0.0f, std::memory_order_relaxed);
+        return;
     }
 
-    // Then Wet/Dry mix.
-    if (useDryMix)
+    auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+
+   #if TWOC_TEST_HOOKS
+    elapsedSeconds *= ecoLoadScale.load (std::memory_order_relaxed);
+   #endif
+
+    qualityTier.store (qualityGovernor.update (elapsedSeconds, numSamples), std::memory_order_relaxed);
+    ecoLoad.store (static_cast<float> (qualityGovernor.getSmoothedLoad()), std::memory_order_relaxed);
+}
+
+// Meters only run while something reads them, and restart from silence when a reader attaches.
+void TwoCCompressorAudioProcessor::updateMeteringState() noexcept
+{
+    const auto meteringWanted = meterConsumerCount.load (std::memory_order_relaxed) > 0;
+
+    if (meteringWanted && ! meteringActive)
     {
-        const auto dryGain = 1.0f - mix;
+        inputMeterBallistics.reset (-100.0f);
+        outputMeterBallistics.reset (-100.0f);
+        inputLoudness.reset();
+        outputLoudness.reset();
+        meterFrames.resetProducer();
+    }
+
+    meteringActive = meteringWanted;
+    meterFramesRead = meteringActive && meterFrameReaderAttached.load (std::memory_order_acquire);
+
+    if (meteringActive)
+        meteredBlocks.store (meteredBlocks.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Fills values from the parameters, or, with A/B on, from the preset slots blended at the
+// smoothed morph position. Switching A/B fades between the two with the same smoothing, so
+// engaging it glides from the controls instead of jumping to the slots. numSamples is how
+// far the glides move this call.
+void TwoCCompressorAudioProcessor::loadParameterValues (PresetSlots::Values& values, int numSamples) noexcept
+{
+    for (size_t index = 0; index < values.size(); ++index)
+        values[index] = loadParam (morphTargetParams[index], 0.0f);
+
+    const auto morphTarget = juce::jlimit (0.0f, 1.0f, loadParam (presetMorphParam, 0.0f));
+    const auto compareTarget = loadParam (presetCompareParam, 0.0f) >= 0.5f ? 1.0f : 0.0f;
+
+    if (compareTarget == 0.0f && compareAmount == 0.0f)
+    {
+        morphPosition = morphTarget;
+        return;
+    }
+
+    // One step per block; the gain ramps and the compressor's own smoothing cover the
+    // samples in between.
+    const auto smoothing = static_cast<float> (std::exp (-static_cast<double> (numSamples) / (morphSmoothingMs * 0.001 * processingSampleRate)));
+    const auto glide = [smoothing] (float& position, float target)
+    {
+        position = target + smoothing * (position - target);
+
+        if (std::abs (position - target) < 1.0e-4f)
+            position = target;
+    };
+
+    glide (morphPosition, morphTarget);
+    glide (compareAmount, compareTarget);
 
+    if (compareAmount >= 1.0f)
+    {
+        presetSlots.blend (morphPosition, values);
+        return;
+    }
+
+    auto morphed = values;
+    presetSlots.blend (morphPosition, morphed);
+    PresetSlots::blendTowards (morphed, compareAmount, values);
+}
+
+void TwoCCompressorAudioProcessor::processActive (juce::AudioBuffer<float>& buffer)
+{
+    using Target = Parameters::MorphTargets::Index;
+
+    const auto numSamples = buffer.getNumSamples();
+    const auto numOutputChannels = getTotalNumOutputChannels();
+
+    PresetSlots::Values values;
+    loadParameterValues (values, numSamples);
+
+    const auto inputDb = values[Target::inputDb];
+    const auto thresholdDb = values[Target::thresholdDb];
+    const auto ratio = values[Target::ratio];
+    const auto timingMode = toChoiceIndex (values[Target::timingMode], 0, 3);
+    const auto characterMode = toChoiceIndex (values[Target::character], 0, 1);
+    const auto attackMs = values[Target::attackMs];
+    const auto releaseMs = values[Target::releaseMs];
+    const auto scHpfHz = values[Target::scHpfHz];
+    const auto scHpfEnabled = values[Target::scHpfEnabled] >= 0.5f;
+    const auto kneeDb = values[Target::kneeDb];
+    const auto makeupDb = values[Target::makeupDb];
+    const auto autoMakeupEnabled = values[Target::autoMakeup] >= 0.5f;
+    const auto satDrive = juce::jlimit (0.0f, 1.0f, values[Target::satDrive]);
+    const auto satMix = juce::jlimit (0.0f, 1.0f, values[Target::satMix]);
+    const auto qualityTierInUse = qualityGovernor.getTier();
+    auto osModeRequested = toChoiceIndex (values[Target::osMode], 0, 2);
+    const auto mix = juce::jlimit (0.0f, 1.0f, values[Target::mix]);
+    const auto outputDb = values[Target::outputDb];
+    const auto truePeakEnabled = truePeakLatencyApplied;
+    const auto truePeakCeilingDb = values[Target::truePeakCeilingDb];
+    auto osModeAppliedThisBlock = 0;
+    MeterFrame meterFrame;
+
+    if (meteringActive)
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, metering);
+        inputMeterDb.store (inputMeterBallistics.processBuffer (buffer, getTotalNumInputChannels(), meterFramesRead), std::memory_order_relaxed);
+        meterFrame.inputPeak = inputMeterBallistics.getBlockPeak();
+        meterFrame.inputRms = inputMeterBallistics.getBlockRms();
+    }
+
+    // Eco tiers, cheapest last: cap oversampling at 2x, fade saturation over to its 1x
+    // antiderivative-antialiased path, then run the compressor's level-to-gain chain at
+    // control rate.
+    if (qualityTierInUse >= QualityGovernor::oversamplingCapped2x)
+        osModeRequested = juce::jmin (osModeRequested, 1);
+
+    saturationStage.setOversamplingSuspended (qualityTierInUse >= QualityGovernor::oversamplingOff);
+    compressor.setControlInterval (qualityTierInUse >= QualityGovernor::controlRateDetection ? QualityGovernor::controlInterval : 1);
+
+    inputGainRamp.setTarget (juce::Decibels::decibelsToGain (inputDb), numSamples);
+    mixRamp.setTarget (mix, numSamples);
+
+    // The dry copy stays on while the mix is still ramping back up to fully wet.
+    const auto hasDryBufferCapacity = dryBuffer.getNumChannels() >= numOutputChannels
+                                   && dryBuffer.getNumSamples() >= numSamples;
+    const auto useDryMix = hasDryBufferCapacity && ! mixRamp.isConstant (1.0f);
+
+    if (! hasDryBufferCapacity && ! mixRamp.isConstant (1.0f))
+        TWOC_RT_LOG (realtimeLog, dryMixCapacityFallback, numSamples, 0.0f, 0.0f);
+    auto gainStageStreams = 0;
+
+    // Wet path: Input trim -> Compressor -> Makeup -> Saturation.
+    // The trim pass also captures the dry signal, so the input is only swept once.
+    for (auto channel = 0; channel < numOutputChannels; ++channel)
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, gainMix);
+        gainStageStreams += GainMixKernel::trimAndCaptureDry (buffer.getWritePointer (channel),
+                                                              useDryMix ? dryBuffer.getWritePointer (channel) : nullptr,
+                                                              numSamples,
+                                                              inputGainRamp);
+    }
+
+    if (spectrumConsumerCount.load (std::memory_order_relaxed) > 0)
+        pushSidechainSpectrum (buffer, numOutputChannels);
+
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, compressor);
+
+        CompressorDSP::Parameters compressorParams;
+        compressorParams.thresholdDb = thresholdDb;
+        compressorParams.ratio = ratio;
+        compressorParams.timingMode = timingMode;
+        compressorParams.characterMode = characterMode;
+        compressorParams.attackMs = attackMs;
+        compressorParams.releaseMs = releaseMs;
+        compressorParams.scHpfHz = scHpfHz;
+        compressorParams.scHpfEnabled = scHpfEnabled;
+        compressorParams.kneeDb = kneeDb;
+        compressorParams.autoMakeup = autoMakeupEnabled;
+        compressor.setParameters (compressorParams);
+        compressor.setMeteringEnabled (meteringActive);
+
+        // Linked: follow the group's loudest peer, then publish this block's own level.
+        const auto slot = linkSlot.load (std::memory_order_acquire);
+        const auto nowMs = slot >= 0 ? juce::Time::getMillisecondCounter() : 0u;
+        compressor.setExternalDetectorLevelDb (slot >= 0 ? linkBus->getGroupLevelDb (slot, nowMs) : LinkBus::silenceDb);
+        compressor.processBlock (buffer);
+
+        if (slot >= 0)
+            linkBus->publish (slot, compressor.getLastBlockDetectorDb(), nowMs);
+
+        if (meteringActive)
+        {
+            curveThresholdDb.store (compressorParams.thresholdDb, std::memory_order_relaxed);
+            curveRatio.store (compressorParams.ratio, std::memory_order_relaxed);
+            curveKneeDb.store (compressorParams.kneeDb, std::memory_order_relaxed);
+            curveCharacterMode.store (compressorParams.characterMode, std::memory_order_relaxed);
+            curveUpdates.store (curveUpdates.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+            gainComputerInputDb.store (compressor.getLastBlockGainComputerInputDb(), std::memory_order_relaxed);
+        }
+    }
+
+    // Auto makeup is applied inside the compressor's sample loop; the manual makeup ramps
+    // to unity while it is on.
+    const auto effectiveMakeupDb = autoMakeupEnabled ? 0.0f : makeupDb;
+    makeupGainRamp.setTarget (juce::Decibels::decibelsToGain (effectiveMakeupDb), numSamples);
+    outputGainRamp.setTarget (juce::Decibels::decibelsToGain (outputDb), numSamples);
+
+    auto osSkippedThisBlock = false;
+    const auto saturationActive = satDrive > 0.0001f && satMix > 0.0001f;
+
+    // The shaper is nonlinear, so makeup has to land before it; otherwise makeup folds
+    // into the final pass below.
+    if (saturationActive)
+    {
         for (auto channel = 0; channel < numOutputChannels; ++channel)
         {
-            buffer.applyGain (channel, 0, numSamples, mix);
-            buffer.addFrom (channel, 0, dryBuffer, channel, 0, numSamples, dryGain);
+            TWOC_PROFILE_STAGE (stageProfiler, gainMix);
+            gainStageStreams += GainMixKernel::applyGain (buffer.getWritePointer (channel), numSamples, makeupGainRamp);
         }
+
+        // Covers the oversamplers too; they run inside the stage.
+        TWOC_PROFILE_STAGE (stageProfiler, saturation);
+        osModeAppliedThisBlock = saturationStage.process (buffer, satDrive, satMix, osModeRequested, isNonRealtime());
+        osSkippedThisBlock = saturationStage.wasLastBlockSkipped();
+
+       #if TWOC_REALTIME_LOG
+        if (saturationStage.getCapacityFallbacks() != saturationFallbacksLogged)
+        {
+            saturationFallbacksLogged = saturationStage.getCapacityFallbacks();
+            TWOC_RT_LOG (realtimeLog, saturationCapacityFallback, numSamples, 0.0f, 0.0f);
+        }
+       #endif
     }
 
-    // Output trim is post wet/dry mix.
-    buffer.applyGain (juce::Decibels::decibelsToGain (outputDb));
+    // Makeup, wet/dry mix and output trim (post mix) in one pass.
+    for (auto channel = 0; channel < numOutputChannels; ++channel)
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, gainMix);
+        gainStageStreams += GainMixKernel::mixAndTrim (buffer.getWritePointer (channel),
+                                                       useDryMix ? dryBuffer.getReadPointer (channel) : nullptr,
+                                                       numSamples,
+                                                       saturationActive ? nullptr : &makeupGainRamp,
+                                                       mixRamp,
+                                                       outputGainRamp);
+    }
+
+    // An estimate, not a measurement: the streams the separate applyGain/copyFrom/addFrom
+    // passes this replaced would have moved (dry copy, input trim, makeup, mix gain + dry
+    // add, output trim), counted the same way the kernels count their own.
+    auto legacyGainStageStreams = (useDryMix ? 2 + 2 + 3 : 0)
+                                + (inputDb != 0.0f ? 2 : 0)
+                                + (autoMakeupEnabled || makeupDb != 0.0f ? 2 : 0)
+                                + (outputDb != 0.0f ? 2 : 0);
+    legacyGainStageStreams *= numOutputChannels;
+
+    const auto bytesPerStream = static_cast<juce::int64> (numSamples) * static_cast<juce::int64> (sizeof (float));
+    gainStageBytesPerBlock.store (gainStageStreams * bytesPerStream, std::memory_order_relaxed);
+    estimatedLegacyGainStageBytesPerBlock.store (legacyGainStageStreams * bytesPerStream, std::memory_order_relaxed);
+
+    // True-peak ceiling is the final stage, after the output trim.
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, truePeak);
+        processTruePeak (buffer, truePeakEnabled, truePeakCeilingDb);
+    }
+
+    if (meteringActive)
+    {
+        TWOC_PROFILE_STAGE (stageProfiler, metering);
+        outputMeterDb.store (outputMeterBallistics.processBuffer (buffer, numOutputChannels, meterFramesRead), std::memory_order_relaxed);
+        gainReductionDb.store (compressor.getMeterGainReductionDb(), std::memory_order_relaxed);
+        truePeakReductionDb.store (truePeakEnabled ? truePeakLimiter.getLastGainReductionDb() : 0.0f, std::memory_order_relaxed);
+
+        meterFrame.outputPeak = outputMeterBallistics.getBlockPeak();
+        meterFrame.outputRms = outputMeterBallistics.getBlockRms();
+        meterFrame.minGainReductionDb = compressor.getLastMinGainReductionDb();
+        meterFrame.maxGainReductionDb = compressor.getLastGainReductionDb();
+        meterFrame.numSamples = numSamples;
+        meterFrames.push (meterFrame);
+        lastOutputPeak = meterFrame.outputPeak;
+    }
 
-    const auto smoothedOutputDb = processMeterBuffer (buffer, numOutputChannels, outputMeterBallistics);
-    outputMeterDb.store (smoothedOutputDb, std::memory_order_relaxed);
-    gainReductionDb.store (compressor.getMeterGainReductionDb(), std::memory_order_relaxed);
     osModeInUse.store (osModeAppliedThisBlock, std::memory_order_relaxed);
+    osSkippedLastBlock.store (osSkippedThisBlock, std::memory_order_relaxed);
+    osBlocksRequested.store (saturationStage.getOversampledBlocksRequested(), std::memory_order_relaxed);
+    osBlocksSkipped.store (saturationStage.getOversampledBlocksSkipped(), std::memory_order_relaxed);
+}
+
+// Switching the limiter crossfades between the undelayed and the limited signal. While it
+// is off it stays primed, so it comes back in with its delay line full of the right audio.
+void TwoCCompressorAudioProcessor::processTruePeak (juce::AudioBuffer<float>& buffer, bool enabled, float ceilingDb) noexcept
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto numOutputChannels = getTotalNumOutputChannels();
+    const auto targetMix = enabled ? 1.0f : 0.0f;
+
+    // The dry copy has already been mixed in by now, so its buffer holds the undelayed signal.
+    if (truePeakMix != targetMix
+        && (dryBuffer.getNumChannels() < numOutputChannels || dryBuffer.getNumSamples() < numSamples))
+    {
+        TWOC_RT_LOG (realtimeLog, truePeakFadeCapacityFallback, numSamples, 0.0f, 0.0f);
+        truePeakMix = targetMix;
+    }
+
+    if (truePeakMix == targetMix)
+    {
+        if (enabled)
+            truePeakLimiter.process (buffer, ceilingDb);
+        else
+            truePeakLimiter.prime (buffer);
+
+        return;
+    }
+
+    for (auto channel = 0; channel < numOutputChannels; ++channel)
+        dryBuffer.copyFrom (channel, 0, buffer, channel, 0, numSamples);
+
+    truePeakLimiter.process (buffer, ceilingDb);
+
+    auto mixAtEnd = truePeakMix;
+
+    for (auto channel = 0; channel < numOutputChannels; ++channel)
+    {
+        auto* limited = buffer.getWritePointer (channel);
+        const auto* undelayed = dryBuffer.getReadPointer (channel);
+        auto amount = truePeakMix;
+
+        for (auto sample = 0; sample < numSamples; ++sample)
+        {
+            amount = enabled ? juce::jmin (1.0f, amount + bypassFadeStep)
+                             : juce::jmax (0.0f, amount - bypassFadeStep);
+            limited[sample] = undelayed[sample] + amount * (limited[sample] - undelayed[sample]);
+        }
+
+        mixAtEnd = amount;
+    }
+
+    truePeakMix = mixAtEnd;
 }
 
 juce::AudioProcessorEditor* TwoCCompressorAudioProcessor::createEditor()
@@ -293,58 +918,305 @@ juce::AudioProcessorEditor* TwoCCompressorAudioProcessor::createEditor()
 
 void TwoCCompressorAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    if (const auto state = apvts.copyState(); const auto xml = state.createXml())
-        copyXmlToBinary (*xml, destData);
+    // Written straight from the parameter atomics; the ValueTree is not copied or serialised.
+    StateFormat::write (stateEntries, getLinkGroup(), presetSlots, destData);
 }
 
 void TwoCCompressorAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    if (const auto xml = getXmlFromBinary (data, sizeInBytes))
+    if (! StateFormat::read (data, sizeInBytes, stateEntries, stateSnapshot))
+        return;
+
+    for (size_t index = 0; index < stateEntries.size(); ++index)
+    {
+        const auto& entry = stateEntries[index];
+        const auto value = stateSnapshot.values[index];
+
+        if (value != entry.value->load (std::memory_order_relaxed))
+            entry.parameter->setValueNotifyingHost (entry.parameter->convertTo0to1 (value));
+    }
+
+    setLinkGroup (stateSnapshot.linkGroup);
+
+    for (auto slot = 0; slot < PresetSlots::numSlots; ++slot)
+    {
+        if (stateSnapshot.slotStored[static_cast<size_t> (slot)])
+            presetSlots.store (slot, stateSnapshot.slotValues[static_cast<size_t> (slot)]);
+        else
+            presetSlots.clear (slot);
+    }
+}
+
+void TwoCCompressorAudioProcessor::storePresetSlot (int slot)
+{
+    PresetSlots::Values values;
+
+    for (size_t index = 0; index < values.size(); ++index)
+        values[index] = loadParam (morphTargetParams[index], 0.0f);
+
+    presetSlots.store (slot, values);
+}
+
+CompressorDSP::Parameters TwoCCompressorAudioProcessor::getCurveFromControls() const noexcept
+{
+    using Target = Parameters::MorphTargets::Index;
+
+    PresetSlots::Values values;
+
+    for (size_t index = 0; index < values.size(); ++index)
+        values[index] = loadParam (morphTargetParams[index], 0.0f);
+
+    if (loadParam (presetCompareParam, 0.0f) >= 0.5f)
+        presetSlots.blend (juce::jlimit (0.0f, 1.0f, loadParam (presetMorphParam, 0.0f)), values);
+
+    CompressorDSP::Parameters curve;
+    curve.thresholdDb = values[Target::thresholdDb];
+    curve.ratio = values[Target::ratio];
+    curve.kneeDb = values[Target::kneeDb];
+    curve.characterMode = toChoiceIndex (values[Target::character], 0, 1);
+    return curve;
+}
+
+juce::String TwoCCompressorAudioProcessor::createProbeReport() const
+{
+    juce::var root (new juce::DynamicObject());
+    auto* object = root.getDynamicObject();
+
+    object->setProperty ("latency_samples", getLatencySamples());
+    object->setProperty ("os_mode_in_use", osModeInUse.load (std::memory_order_relaxed));
+    object->setProperty ("os_blocks_requested", osBlocksRequested.load (std::memory_order_relaxed));
+    object->setProperty ("os_blocks_skipped", osBlocksSkipped.load (std::memory_order_relaxed));
+    object->setProperty ("os_builds_pending", countPendingOversamplerBuilds());
+    object->setProperty ("quality_tier", qualityTier.load (std::memory_order_relaxed));
+    object->setProperty ("eco_load", ecoLoad.load (std::memory_order_relaxed));
+    object->setProperty ("link_group_size", getLinkGroupSize());
+    object->setProperty ("link_slot", linkSlot.load (std::memory_order_relaxed));
+    object->setProperty ("scratch_bytes", scratchBytes.load (std::memory_order_relaxed));
+    object->setProperty ("footprint_bytes", getMemoryFootprintBytes());
+    object->setProperty ("gain_stage_bytes_per_block", gainStageBytesPerBlock.load (std::memory_order_relaxed));
+    object->setProperty ("legacy_gain_stage_bytes_per_block_estimate", estimatedLegacyGainStageBytesPerBlock.load (std::memory_order_relaxed));
+    object->setProperty ("telemetry_attached", telemetry.isAttached());
+    object->setProperty ("metered_blocks", meteredBlocks.load (std::memory_order_relaxed));
+
+    // Each A/B slot's stored values in MorphTargets order, or null while it is empty.
+    juce::Array<juce::var> slots;
+
+    for (auto slot = 0; slot < PresetSlots::numSlots; ++slot)
     {
-        if (xml->hasTagName (apvts.state.getType()))
+        PresetSlots::Values values;
+
+        if (! presetSlots.load (slot, values))
         {
-            const auto hasScHpfEnabled = xml->toString().contains (Parameters::IDs::scHpfEnabled);
-            const auto hasTimingMode = xml->toString().contains (Parameters::IDs::timingMode);
-            const auto hasCharacter = xml->toString().contains (Parameters::IDs::character);
-            const auto hasAutoMakeup = xml->toString().contains (Parameters::IDs::autoMakeup);
-            apvts.replaceState (juce::ValueTree::fromXml (*xml));
-
-            if (! hasScHpfEnabled)
-                if (auto* parameter = apvts.getParameter (Parameters::IDs::scHpfEnabled))
-                    parameter->setValueNotifyingHost (1.0f);
-
-            if (! hasTimingMode)
-                if (auto* parameter = apvts.getParameter (Parameters::IDs::timingMode))
-                    parameter->setValueNotifyingHost (0.0f);
-
-            if (! hasCharacter)
-                if (auto* parameter = apvts.getParameter (Parameters::IDs::character))
-                    parameter->setValueNotifyingHost (0.0f);
-
-            if (! hasAutoMakeup)
-                if (auto* parameter = apvts.getParameter (Parameters::IDs::autoMakeup))
-                    parameter->setValueNotifyingHost (0.0f);
+            slots.add (juce::var());
+            continue;
         }
+
+        juce::Array<juce::var> entries;
+
+        for (const auto value : values)
+            entries.add (value);
+
+        slots.add (entries);
+    }
+
+    object->setProperty ("preset_slots", slots);
+    object->setProperty ("loudness_in_momentary_lufs", inputMomentaryLufs.load (std::memory_order_relaxed));
+    object->setProperty ("loudness_in_short_term_lufs", inputShortTermLufs.load (std::memory_order_relaxed));
+    object->setProperty ("loudness_in_integrated_lufs", inputIntegratedLufs.load (std::memory_order_relaxed));
+    object->setProperty ("loudness_out_momentary_lufs", outputMomentaryLufs.load (std::memory_order_relaxed));
+    object->setProperty ("loudness_out_short_term_lufs", outputShortTermLufs.load (std::memory_order_relaxed));
+    object->setProperty ("loudness_out_integrated_lufs", outputIntegratedLufs.load (std::memory_order_relaxed));
+
+   #if TWOC_REALTIME_LOG
+    object->setProperty ("rt_log_pushed", static_cast<juce::int64> (realtimeLog.getPushedCount()));
+    object->setProperty ("rt_log_dropped", static_cast<juce::int64> (realtimeLog.getDroppedCount()));
+   #endif
+
+   #if TWOC_STAGE_PROFILER
+    // Nanoseconds per sample for each stage, over every block since the last prepare, and
+    // the rate of the counter they were timed with.
+    object->setProperty ("stage_profile_counter_hz", Diagnostics::getCycleCounterFrequency());
+    juce::var stages (new juce::DynamicObject());
+
+    for (auto stage = 0; stage < Diagnostics::StageProfiler::numStages; ++stage)
+    {
+        const auto summary = stageProfiler.getSummary (stage);
+        juce::var entry (new juce::DynamicObject());
+        entry.getDynamicObject()->setProperty ("blocks", summary.blocks);
+        entry.getDynamicObject()->setProperty ("min", summary.minPerSample);
+        entry.getDynamicObject()->setProperty ("mean", summary.meanPerSample);
+        entry.getDynamicObject()->setProperty ("p99", summary.p99PerSample);
+        entry.getDynamicObject()->setProperty ("max", summary.maxPerSample);
+        stages.getDynamicObject()->setProperty (Diagnostics::StageProfiler::getStageName (stage), entry);
     }
+
+    object->setProperty ("stage_profile", stages);
+   #endif
+
+    return juce::JSON::toString (root, true);
+}
+
+void TwoCCompressorAudioProcessor::setLinkGroup (const juce::String& groupName)
+{
+    const auto trimmed = groupName.trim();
+    const juce::ScopedLock sl (linkGroupLock);
+    linkGroupName = trimmed;
+
+    // Leaving the group gives the slot back for other instances to take.
+    if (trimmed.isEmpty())
+    {
+        linkBus->releaseSlot (linkSlot.exchange (-1, std::memory_order_acq_rel));
+        return;
+    }
+
+    auto slot = linkSlot.load (std::memory_order_acquire);
+
+    if (slot < 0)
+    {
+        slot = linkBus->acquireSlot();
+        linkSlot.store (slot, std::memory_order_release);
+    }
+
+    if (slot >= 0)
+        linkBus->setGroup (slot, LinkBus::makeGroupKey (trimmed));
+}
+
+juce::String TwoCCompressorAudioProcessor::getLinkGroup() const
+{
+    const juce::ScopedLock sl (linkGroupLock);
+    return linkGroupName;
+}
+
+int TwoCCompressorAudioProcessor::getLinkGroupSize() const
+{
+    return linkBus->countMembers (LinkBus::makeGroupKey (getLinkGroup()));
+}
+
+juce::int64 TwoCCompressorAudioProcessor::getMemoryFootprintBytes() const noexcept
+{
+    return static_cast<juce::int64> (sizeof (*this)) + scratchBytes.load (std::memory_order_relaxed);
+}
+
+int TwoCCompressorAudioProcessor::countPendingOversamplerBuilds()
+{
+    auto& registry = getInstanceRegistry();
+    const juce::ScopedLock sl (registry.lock);
+    auto pending = 0;
+
+    for (const auto* instance : registry.instances)
+        pending += instance->saturationStage.isBuildPending() ? 1 : 0;
+
+    return pending;
+}
+
+#if TWOC_TEST_HOOKS
+juce::String TwoCCompressorAudioProcessor::createProbeReportForNewestInstance()
+{
+    auto& registry = getInstanceRegistry();
+    const juce::ScopedLock sl (registry.lock);
+
+    if (registry.instances.isEmpty())
+        return {};
+
+    return registry.instances.getLast()->createProbeReport();
+}
+
+bool TwoCCompressorAudioProcessor::storePresetSlotForNewestInstance (int slot)
+{
+    auto& registry = getInstanceRegistry();
+    const juce::ScopedLock sl (registry.lock);
+
+    if (registry.instances.isEmpty())
+        return false;
+
+    registry.instances.getLast()->storePresetSlot (slot);
+    return true;
+}
+
+bool TwoCCompressorAudioProcessor::setMeterConsumerForNewestInstance (bool attach)
+{
+    auto& registry = getInstanceRegistry();
+    const juce::ScopedLock sl (registry.lock);
+
+    if (registry.instances.isEmpty())
+        return false;
+
+    auto& consumer = registry.instances.getLast()->harnessMeterConsumer;
+
+    if (! attach)
+        consumer.reset();
+    else if (! consumer.has_value())
+        consumer.emplace (*registry.instances.getLast(), false);
+
+    return true;
+}
+
+bool TwoCCompressorAudioProcessor::setLinkGroupForNewestInstance (const juce::String& groupName)
+{
+    auto& registry = getInstanceRegistry();
+    const juce::ScopedLock sl (registry.lock);
+
+    if (registry.instances.isEmpty())
+        return false;
+
+    registry.instances.getLast()->setLinkGroup (groupName);
+    return true;
+}
+
+bool TwoCCompressorAudioProcessor::setEcoLoadScaleForNewestInstance (double scale)
+{
+    auto& registry = getInstanceRegistry();
+    const juce::ScopedLock sl (registry.lock);
+
+    if (registry.instances.isEmpty())
+        return false;
+
+    registry.instances.getLast()->ecoLoadScale.store (juce::jmax (1.0, scale), std::memory_order_relaxed);
+    return true;
+}
+#endif
+
+// Audio thread (or prepareToPlay): the dry path follows at once, while the host hears
+// about it from the message thread; useTimeSlice() notices the difference and posts it.
+void TwoCCompressorAudioProcessor::applyTruePeakLatency (bool truePeakActive) noexcept
+{
+    truePeakLatencyApplied = truePeakActive;
+    const auto latency = truePeakActive ? truePeakLimiter.getLatencySamples() : 0;
+    bypassDelay.setDelay (latency);
+    reportedLatencySamples.store (latency, std::memory_order_relaxed);
+    TWOC_RT_LOG (realtimeLog, latencyChanged, latency, 0.0f, 0.0f);
+}
+
+void TwoCCompressorAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples (reportedLatencySamples.load (std::memory_order_relaxed));
+}
+
+int TwoCCompressorAudioProcessor::useTimeSlice()
+{
+    saturationStage.runBackgroundWork();
+
+    if (reportedLatencySamples.load (std::memory_order_relaxed) != getLatencySamples())
+        triggerAsyncUpdate();
+
+   #if TWOC_REALTIME_LOG
+    realtimeLogWriter->drain (realtimeLog, instanceId);
+   #endif
+
+    constexpr auto pollIntervalMs = 50;
+    return pollIntervalMs;
 }
 
 void TwoCCompressorAudioProcessor::cacheParameterPointers()
 {
     inputDbParam = apvts.getRawParameterValue (Parameters::IDs::inputDb);
-    thresholdDbParam = apvts.getRawParameterValue (Parameters::IDs::thresholdDb);
-    ratioParam = apvts.getRawParameterValue (Parameters::IDs::ratio);
-    timingModeParam = apvts.getRawParameterValue (Parameters::IDs::timingMode);
-    characterParam = apvts.getRawParameterValue (Parameters::IDs::character);
-    attackMsParam = apvts.getRawParameterValue (Parameters::IDs::attackMs);
-    releaseMsParam = apvts.getRawParameterValue (Parameters::IDs::releaseMs);
-    scHpfHzParam = apvts.getRawParameterValue (Parameters::IDs::scHpfHz);
-    scHpfEnabledParam = apvts.getRawParameterValue (Parameters::IDs::scHpfEnabled);
-    kneeDbParam = apvts.getRawParameterValue (Parameters::IDs::kneeDb);
-    makeupDbParam = apvts.getRawParameterValue (Parameters::IDs::makeupDb);
-    autoMakeupParam = apvts.getRawParameterValue (Parameters::IDs::autoMakeup);
-    satDriveParam = apvts.getRawParameterValue (Parameters::IDs::satDrive);
-    satMixParam = apvts.getRawParameterValue (Parameters::IDs::satMix);
     osModeParam = apvts.getRawParameterValue (Parameters::IDs::osMode);
-    mixParam = apvts.getRawParameterValue (Parameters::IDs::mix);
-    outputDbParam = apvts.getRawParameterValue (Parameters::IDs::outputDb);
+    truePeakEnabledParam = apvts.getRawParameterValue (Parameters::IDs::truePeakEnabled);
+    bypassParam = apvts.getRawParameterValue (Parameters::IDs::bypass);
+    ecoModeParam = apvts.getRawParameterValue (Parameters::IDs::ecoMode);
+    presetCompareParam = apvts.getRawParameterValue (Parameters::IDs::presetCompare);
+    presetMorphParam = apvts.getRawParameterValue (Parameters::IDs::presetMorph);
+
+    for (size_t index = 0; index < morphTargetParams.size(); ++index)
+        morphTargetParams[index] = apvts.getRawParameterValue (Parameters::MorphTargets::targets[index].parameterID);
 }
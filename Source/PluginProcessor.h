@@ -3,22 +3,50 @@
 #include <JuceHeader.h>
 #include <atomic>
 #include <memory>
+#include <optional>
 
+#include "DSP/AnalysisFifo.h"
+#include "DSP/BackgroundBuildThread.h"
+#include "DSP/CompensationDelay.h"
 #include "DSP/CompressorDSP.h"
+#include "DSP/GainMixKernel.h"
+#include "DSP/LinkBus.h"
+#include "DSP/LoudnessMeter.h"
 #include "DSP/MeterBallistics.h"
-#include "DSP/Saturation.h"
+#include "DSP/MeterFrameFifo.h"
+#include "DSP/QualityGovernor.h"
+#include "DSP/SaturationStage.h"
+#include "DSP/ScratchArena.h"
+#include "DSP/TruePeakLimiter.h"
+#include "Diagnostics/HostCallTrace.h"
+#include "Diagnostics/RealtimeLog.h"
+#include "Diagnostics/StageProfiler.h"
+#include "Diagnostics/TelemetryPublisher.h"
 #include "Parameters.h"
+#include "PresetSlots.h"
+#include "StateFormat.h"
 
-class TwoCCompressorAudioProcessor : public juce::AudioProcessor
+// Compiled in with -DTWOC_TEST_HOOKS=1 (CMake option TWOC_TEST_HOOKS) for the harness
+// tests. When it is 0 the plugin exports nothing but its format entry points.
+#ifndef TWOC_TEST_HOOKS
+ #define TWOC_TEST_HOOKS 0
+#endif
+
+class TwoCCompressorAudioProcessor : public juce::AudioProcessor,
+                                     private juce::TimeSliceClient,
+                                     private juce::AsyncUpdater
 {
 public:
     TwoCCompressorAudioProcessor();
-    ~TwoCCompressorAudioProcessor() override = default;
+    ~TwoCCompressorAudioProcessor() override;
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void reset() override;
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    juce::AudioProcessorParameter* getBypassParameter() const override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
@@ -41,47 +69,292 @@ public:
     juce::AudioProcessorValueTreeState& getAPVTS() noexcept { return apvts; }
     const juce::AudioProcessorValueTreeState& getAPVTS() const noexcept { return apvts; }
 
+    // While at least one of these is alive the processor runs its meters. Editors (and any
+    // other reader of the meter atomics) hold one; without any, metering costs nothing.
+    // The per-block frames have a single reader: one consumer per processor pops them, a
+    // second one asking to gets none. Consumers that only want the meters running pass
+    // popsFrames = false.
+    class MeterConsumer
+    {
+    public:
+        explicit MeterConsumer (TwoCCompressorAudioProcessor& processorToWatch, bool popsFrames = true)
+            : owner (processorToWatch)
+        {
+            if (popsFrames)
+            {
+                const auto readerAttached = owner.meterFrameReaderAttached.exchange (true, std::memory_order_acq_rel);
+                jassert (! readerAttached);
+                readsFrames = ! readerAttached;
+            }
+
+            if (readsFrames)
+                owner.meterFrames.discardPending();
+
+            owner.meterConsumerCount.fetch_add (1, std::memory_order_relaxed);
+        }
+
+        ~MeterConsumer()
+        {
+            owner.meterConsumerCount.fetch_sub (1, std::memory_order_relaxed);
+
+            if (readsFrames)
+                owner.meterFrameReaderAttached.store (false, std::memory_order_release);
+        }
+
+        // Every block's levels since the last call, oldest first.
+        int popFrames (MeterFrame* destination, int maxFrames) noexcept
+        {
+            return readsFrames ? owner.meterFrames.pop (destination, maxFrames) : 0;
+        }
+
+    private:
+        TwoCCompressorAudioProcessor& owner;
+        bool readsFrames = false;
+
+        JUCE_DECLARE_NON_COPYABLE (MeterConsumer)
+    };
+
+    // The sidechain spectrum feed. While one of these is alive the audio thread pushes the
+    // detector input (after the input trim, channels summed, box-averaged down to about
+    // analysisRateHz) into a FIFO, and this is its only reader: one per processor.
+    class SpectrumConsumer
+    {
+    public:
+        explicit SpectrumConsumer (TwoCCompressorAudioProcessor& processorToWatch)
+            : owner (processorToWatch)
+        {
+            jassert (owner.spectrumConsumerCount.load (std::memory_order_relaxed) == 0);
+            owner.sidechainFifo.discardPending();
+            owner.spectrumConsumerCount.fetch_add (1, std::memory_order_relaxed);
+        }
+
+        ~SpectrumConsumer()
+        {
+            owner.spectrumConsumerCount.fetch_sub (1, std::memory_order_relaxed);
+        }
+
+        int pop (float* destination, int maxSamples) noexcept { return owner.sidechainFifo.pop (destination, maxSamples); }
+
+        // Rate of the samples pop() returns; 0 before the first prepareToPlay().
+        double getSampleRate() const noexcept { return owner.sidechainAnalysisRate.load (std::memory_order_relaxed); }
+
+    private:
+        TwoCCompressorAudioProcessor& owner;
+
+        JUCE_DECLARE_NON_COPYABLE (SpectrumConsumer)
+    };
+
+    static constexpr double analysisRateHz = 12000.0;
+
+    // Link groups (any thread but the audio thread: hosts save and restore state from
+    // their own). Instances in the same process with the same non-empty group name
+    // compress from the group's loudest detector; the name is saved with the state. An
+    // empty name unlinks.
+    void setLinkGroup (const juce::String& groupName);
+    juce::String getLinkGroup() const;
+    int getLinkGroupSize() const;
+
+    // A/B preset slots (message thread). Storing captures the controls' current values;
+    // with the A/B parameter on, the audio thread runs from the slots and Morph blends
+    // between them. The slots are saved with the state.
+    void storePresetSlot (int slot);
+    bool isPresetSlotStored (int slot) const noexcept { return presetSlots.isStored (slot); }
+
+    // Restarts both integrated loudness measurements from the next block (any thread).
+    void resetIntegratedLoudness() noexcept { loudnessResetRequested.store (true, std::memory_order_release); }
+
+    // The instance object plus its scratch arena. Oversampler filters are allocated by JUCE
+    // and are not included.
+    juce::int64 getMemoryFootprintBytes() const noexcept;
+
+    // JSON snapshot of the counters below, read by the harness through the exported probe.
+    juce::String createProbeReport() const;
+
+   #if TWOC_TEST_HOOKS
+    // Behind the harness exports in PluginEntry.cpp; they act on the newest instance.
+    static juce::String createProbeReportForNewestInstance();
+    static bool storePresetSlotForNewestInstance (int slot);
+
+    // Holds a meter consumer for the newest instance, or lets it go, as an editor opening
+    // and closing would; lets the harness meter renders without an editor.
+    static bool setMeterConsumerForNewestInstance (bool attach);
+
+    // Joins the newest instance to a link group (or leaves with an empty name), as the
+    // editor's group field does.
+    static bool setLinkGroupForNewestInstance (const juce::String& groupName);
+
+    // Makes the newest instance's eco governor see each block as taking scale times longer
+    // than it did, as on a slower machine.
+    static bool setEcoLoadScaleForNewestInstance (double scale);
+   #endif
+
+    // Live instances, in this process, still waiting for their oversampler to be built.
+    static int countPendingOversamplerBuilds();
+
+   #if TWOC_STAGE_PROFILER
+    const Diagnostics::StageProfiler& getStageProfiler() const noexcept { return stageProfiler; }
+   #endif
+
     std::atomic<float> inputMeterDb { 0.0f };
     std::atomic<float> outputMeterDb { 0.0f };
     std::atomic<float> gainReductionDb { 0.0f };
+    std::atomic<float> truePeakReductionDb { 0.0f };
+    std::atomic<float> inputMomentaryLufs { LoudnessMeter::minimumLufs };
+    std::atomic<float> inputShortTermLufs { LoudnessMeter::minimumLufs };
+    std::atomic<float> inputIntegratedLufs { LoudnessMeter::minimumLufs };
+    std::atomic<float> outputMomentaryLufs { LoudnessMeter::minimumLufs };
+    std::atomic<float> outputShortTermLufs { LoudnessMeter::minimumLufs };
+    std::atomic<float> outputIntegratedLufs { LoudnessMeter::minimumLufs };
     std::atomic<int> osModeInUse { 0 };
+    std::atomic<bool> osSkippedLastBlock { false };
+    std::atomic<juce::int64> osBlocksRequested { 0 };
+    std::atomic<juce::int64> osBlocksSkipped { 0 };
+    std::atomic<juce::int64> gainStageBytesPerBlock { 0 };
+    std::atomic<juce::int64> estimatedLegacyGainStageBytesPerBlock { 0 };
+    std::atomic<juce::int64> scratchBytes { 0 };
+    std::atomic<juce::int64> meteredBlocks { 0 };
+    std::atomic<int> qualityTier { QualityGovernor::full };
+    std::atomic<float> ecoLoad { 0.0f };
+
+    // Gain computer settings in use last block (after any A/B morph) and the level it saw
+    // at its peak, for the editor's transfer curve. Updated while metering runs, with
+    // curveUpdates counting the blocks that wrote them.
+    std::atomic<float> curveThresholdDb { -18.0f };
+    std::atomic<float> curveRatio { 4.0f };
+    std::atomic<float> curveKneeDb { 6.0f };
+    std::atomic<int> curveCharacterMode { 0 };
+    std::atomic<juce::uint32> curveUpdates { 0 };
+    std::atomic<float> gainComputerInputDb { -120.0f };
+
+    // The gain computer settings the controls (or, with A/B on, the slots at the Morph
+    // setting) ask for, for when no block is running to report the ones in use. Any thread.
+    CompressorDSP::Parameters getCurveFromControls() const noexcept;
 
 private:
     void cacheParameterPointers();
+    void applyTruePeakLatency (bool truePeakActive) noexcept;
+    void handleAsyncUpdate() override;
+    void updateMeteringState() noexcept;
+    void updateQualityTier (bool ecoActive, juce::int64 startTicks, int numSamples) noexcept;
+    void processWithBypass (juce::AudioBuffer<float>& buffer, bool bypassed);
+    void processBypassed (juce::AudioBuffer<float>& buffer);
+    void processActive (juce::AudioBuffer<float>& buffer);
+    void processTruePeak (juce::AudioBuffer<float>& buffer, bool enabled, float ceilingDb) noexcept;
+    void checkBlockIsFinite (const juce::AudioBuffer<float>& buffer, bool isOutput) noexcept;
+    void measureLoudness (const juce::AudioBuffer<float>& buffer, bool isOutput) noexcept;
+    void pushSidechainSpectrum (const juce::AudioBuffer<float>& buffer, int numChannels) noexcept;
+    void loadParameterValues (PresetSlots::Values& values, int numSamples) noexcept;
+    void publishTelemetry (const juce::AudioBuffer<float>& buffer, juce::int64 startTicks) noexcept;
+    int useTimeSlice() override;
+
+    int instanceId = 0;
+    std::atomic<int> meterConsumerCount { 0 };
+    std::atomic<bool> meterFrameReaderAttached { false };
+    bool meteringActive = false;
+    bool meterFramesRead = false; // only frame readers show the block RMS
+    MeterFrameFifo meterFrames;
 
     juce::AudioProcessorValueTreeState apvts;
+    juce::SharedResourcePointer<BackgroundBuildThread> backgroundBuildThread;
+    std::vector<StateFormat::ParameterEntry> stateEntries;
+    StateFormat::Snapshot stateSnapshot;
+    std::unique_ptr<Diagnostics::HostCallTrace> hostCallTrace;
+    Diagnostics::TelemetryPublisher telemetry;
+    juce::uint64 telemetryBlocks = 0;
+    double telemetryEpochMs = 0.0;
+    float lastOutputPeak = 0.0f;
+
+   #if TWOC_TEST_HOOKS
+    std::optional<MeterConsumer> harnessMeterConsumer;
+    std::atomic<double> ecoLoadScale { 1.0 };
+   #endif
+
+    juce::SharedResourcePointer<LinkBus> linkBus;
+    std::atomic<int> linkSlot { -1 };
+    juce::CriticalSection linkGroupLock; // guards linkGroupName and slot changes
+    juce::String linkGroupName;
+    PresetSlots presetSlots;
     CompressorDSP compressor;
-    Saturation saturation;
+    SaturationStage saturationStage;
+    TruePeakLimiter truePeakLimiter;
+    QualityGovernor qualityGovernor;
 
+    ScratchArena scratchArena;
     juce::AudioBuffer<float> dryBuffer;
-    juce::AudioBuffer<float> saturationDryBuffer;
+    juce::AudioBuffer<float> bypassDryBuffer;
+    CompensationDelay bypassDelay;
+    BlockGainRamp inputGainRamp;
+    BlockGainRamp makeupGainRamp;
+    BlockGainRamp mixRamp;
+    BlockGainRamp outputGainRamp;
     MeterBallistics inputMeterBallistics;
     MeterBallistics outputMeterBallistics;
 
-    std::unique_ptr<juce::dsp::Oversampling<float>> oversampling2x;
-    std::unique_ptr<juce::dsp::Oversampling<float>> oversampling4x;
+    // Gated with the meters above, so integrated loudness covers the program from when a
+    // consumer attached; it restarts each time metering does.
+    LoudnessMeter inputLoudness;
+    LoudnessMeter outputLoudness;
+    std::atomic<bool> loudnessResetRequested { false };
+
+    std::atomic<int> spectrumConsumerCount { 0 };
+    AnalysisFifo sidechainFifo;
+    std::atomic<double> sidechainAnalysisRate { 0.0 };
+    int sidechainDecimation = 1;
+    float sidechainAccumulator = 0.0f;
+    int sidechainAccumulated = 0;
 
     std::atomic<float>* inputDbParam = nullptr;
-    std::atomic<float>* thresholdDbParam = nullptr;
-    std::atomic<float>* ratioParam = nullptr;
-    std::atomic<float>* timingModeParam = nullptr;
-    std::atomic<float>* characterParam = nullptr;
-    std::atomic<float>* attackMsParam = nullptr;
-    std::atomic<float>* releaseMsParam = nullptr;
-    std::atomic<float>* scHpfHzParam = nullptr;
-    std::atomic<float>* scHpfEnabledParam = nullptr;
-    std::atomic<float>* kneeDbParam = nullptr;
-    std::atomic<float>* makeupDbParam = nullptr;
-    std::atomic<float>* autoMakeupParam = nullptr;
-    std::atomic<float>* satDriveParam = nullptr;
-    std::atomic<float>* satMixParam = nullptr;
     std::atomic<float>* osModeParam = nullptr;
-    std::atomic<float>* mixParam = nullptr;
-    std::atomic<float>* outputDbParam = nullptr;
+    std::atomic<float>* truePeakEnabledParam = nullptr;
+    std::atomic<float>* bypassParam = nullptr;
+    std::atomic<float>* ecoModeParam = nullptr;
+    std::atomic<float>* presetCompareParam = nullptr;
+    std::atomic<float>* presetMorphParam = nullptr;
+    std::array<std::atomic<float>*, Parameters::MorphTargets::count> morphTargetParams {};
+
+    struct PreparedConfiguration
+    {
+        double sampleRate = 0.0;
+        int maxBlockSize = 0;
+        int numChannels = 0;
+
+        bool operator== (const PreparedConfiguration& other) const noexcept
+        {
+            return sampleRate == other.sampleRate && maxBlockSize == other.maxBlockSize && numChannels == other.numChannels;
+        }
+    };
 
+    PreparedConfiguration preparedConfiguration;
     double processingSampleRate = 44100.0;
-    float autoMakeupAverageGrDb = 0.0f;
-    float autoMakeupAppliedDb = 0.0f;
+    bool truePeakLatencyApplied = false;
+    std::atomic<int> reportedLatencySamples { 0 };
+
+    // 0 = limiter out, 1 = limiter in; crosses over at the bypass fade rate.
+    float truePeakMix = 0.0f;
+
+    // 0 = processing, 1 = bypassed; moves linearly over bypassFadeMs between the two.
+    static constexpr double bypassFadeMs = 10.0;
+    float bypassMix = 0.0f;
+    float bypassFadeStep = 1.0f;
+
+    // The morph position the audio thread blends at, gliding toward the parameter.
+    static constexpr double morphSmoothingMs = 40.0;
+    float morphPosition = 0.0f;
+    float compareAmount = 0.0f; // 0 = controls, 1 = slots; glides like the morph
+
+   #if TWOC_REALTIME_LOG
+    // Written only from the audio thread (and prepareToPlay, which never overlaps it),
+    // drained from useTimeSlice().
+    Diagnostics::RealtimeLog realtimeLog;
+    juce::SharedResourcePointer<Diagnostics::RealtimeLogWriter> realtimeLogWriter;
+    juce::int64 saturationFallbacksLogged = 0;
+    std::array<juce::int32, 2> nonFiniteRunBlocks {}; // input, output
+   #endif
+
+   #if TWOC_STAGE_PROFILER
+    // Filled by the audio thread; cleared in prepareToPlay().
+    Diagnostics::StageProfiler stageProfiler;
+   #endif
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TwoCCompressorAudioProcessor)
 };
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+
+#include "Parameters.h"
+
+// Preallocated preset snapshots for A/B compare and morphing. Each slot holds one plain
+// value per MorphTargets entry. Slots are captured on the message thread and blended on
+// the audio thread from fixed arrays of atomics, so switching or morphing allocates nothing
+// and never goes through the APVTS.
+//
+// A slot's values are stored one by one, so a block that overlaps a store can see a mix of
+// the old and new snapshot. That is no different from the host writing the same parameters
+// one at a time, and the next block sees the whole new snapshot.
+class PresetSlots
+{
+public:
+    static constexpr int numSlots = 2;
+
+    using Values = std::array<float, Parameters::MorphTargets::count>;
+
+    // Message thread.
+    void store (int slot, const Values& values) noexcept
+    {
+        if (! juce::isPositiveAndBelow (slot, numSlots))
+            return;
+
+        auto& target = slots[static_cast<size_t> (slot)];
+
+        for (size_t index = 0; index < values.size(); ++index)
+            target.values[index].store (values[index], std::memory_order_relaxed);
+
+        target.stored.store (true, std::memory_order_release);
+    }
+
+    void clear (int slot) noexcept
+    {
+        if (juce::isPositiveAndBelow (slot, numSlots))
+            slots[static_cast<size_t> (slot)].stored.store (false, std::memory_order_release);
+    }
+
+    bool isStored (int slot) const noexcept
+    {
+        return juce::isPositiveAndBelow (slot, numSlots)
+            && slots[static_cast<size_t> (slot)].stored.load (std::memory_order_acquire);
+    }
+
+    // Copies slot into values; false, leaving values untouched, when the slot is empty.
+    bool load (int slot, Values& values) const noexcept
+    {
+        if (! isStored (slot))
+            return false;
+
+        const auto& source = slots[static_cast<size_t> (slot)];
+
+        for (size_t index = 0; index < values.size(); ++index)
+            values[index] = source.values[index].load (std::memory_order_relaxed);
+
+        return true;
+    }
+
+    // Any thread. values holds the live parameters on entry and the blend at position
+    // (0 = first slot, 1 = last) on return. An empty slot stands in for the live values,
+    // so engaging A/B before storing anything changes nothing.
+    void blend (float position, Values& values) const noexcept
+    {
+        const auto scaled = juce::jlimit (0.0f, 1.0f, position) * static_cast<float> (numSlots - 1);
+        const auto lower = juce::jmin (static_cast<int> (scaled), numSlots - 2);
+        const auto amount = scaled - static_cast<float> (lower);
+
+        auto from = values;
+        auto to = values;
+        load (lower, from);
+        load (lower + 1, to);
+
+        for (size_t index = 0; index < values.size(); ++index)
+            values[index] = blendValue (Parameters::MorphTargets::targets[index].blend, from[index], to[index], amount);
+    }
+
+    // Audio thread. Moves values amount of the way to target, each value blended the same
+    // way the slots are; for fading between the live controls and a slot blend.
+    static void blendTowards (const Values& target, float amount, Values& values) noexcept
+    {
+        for (size_t index = 0; index < values.size(); ++index)
+            values[index] = blendValue (Parameters::MorphTargets::targets[index].blend, values[index], target[index], amount);
+    }
+
+private:
+    static float blendValue (Parameters::MorphTargets::Blend blend, float from, float to, float amount) noexcept
+    {
+        if (from == to || amount <= 0.0f)
+            return from;
+
+        if (amount >= 1.0f)
+            return to;
+
+        switch (blend)
+        {
+            case Parameters::MorphTargets::Blend::stepped:
+                return amount < 0.5f ? from : to;
+
+            case Parameters::MorphTargets::Blend::logarithmic:
+                if (from > 0.0f && to > 0.0f)
+                    return from * std::pow (to / from, amount);
+                break;
+
+            case Parameters::MorphTargets::Blend::linear:
+                break;
+        }
+
+        return from + amount * (to - from);
+    }
+
+    struct Slot
+    {
+        std::array<std::atomic<float>, Parameters::MorphTargets::count> values {};
+        std::atomic<bool> stored { false };
+    };
+
+    std::array<Slot, numSlots> slots;
+};
@@ -0,0 +1,330 @@
+#include "StateFormat.h"
+#include "Parameters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+// Parameters added after the first release, and the value a state saved before them
+// implies. Anything else a state lacks falls back to the parameter's default.
+struct Migration
+{
+    const char* parameterID;
+    float legacyValue;
+};
+
+constexpr Migration migrations[] {
+    { Parameters::IDs::scHpfEnabled, 1.0f }, // the detector HPF used to be always on
+    { Parameters::IDs::timingMode, 0.0f },   // Manual
+    { Parameters::IDs::character, 0.0f },    // Clean
+    { Parameters::IDs::autoMakeup, 0.0f },
+    { Parameters::IDs::bypass, 0.0f },
+    { Parameters::IDs::ecoMode, 0.0f },
+    { Parameters::IDs::presetCompare, 0.0f },
+    { Parameters::IDs::presetMorph, 0.0f },
+};
+
+constexpr size_t headerBytes = 4 + 2 + 2;
+constexpr size_t entryBytes = 4 + 4;
+constexpr size_t linkGroupLengthBytes = 2;
+constexpr size_t slotCountBytes = 2;
+constexpr size_t slotHeaderBytes = 1 + 2;
+
+const std::array<juce::uint32, Parameters::MorphTargets::count>& getMorphTargetHashes()
+{
+    static const auto hashes = []
+    {
+        std::array<juce::uint32, Parameters::MorphTargets::count> result {};
+
+        for (size_t index = 0; index < result.size(); ++index)
+            result[index] = StateFormat::hashParameterID (Parameters::MorphTargets::targets[index].parameterID);
+
+        return result;
+    }();
+
+    return hashes;
+}
+
+int findEntry (const std::vector<StateFormat::ParameterEntry>& entries, juce::uint32 idHash, size_t likelyIndex) noexcept
+{
+    // States are normally written in the same order they are read back.
+    if (likelyIndex < entries.size() && entries[likelyIndex].idHash == idHash)
+        return static_cast<int> (likelyIndex);
+
+    for (size_t index = 0; index < entries.size(); ++index)
+        if (entries[index].idHash == idHash)
+            return static_cast<int> (index);
+
+    return -1;
+}
+
+void writeUInt8 (char*& destination, juce::uint8 value) noexcept
+{
+    *destination++ = static_cast<char> (value);
+}
+
+void writeUInt16 (char*& destination, juce::uint16 value) noexcept
+{
+    value = juce::ByteOrder::swapIfBigEndian (value);
+    std::memcpy (destination, &value, sizeof (value));
+    destination += sizeof (value);
+}
+
+void writeUInt32 (char*& destination, juce::uint32 value) noexcept
+{
+    value = juce::ByteOrder::swapIfBigEndian (value);
+    std::memcpy (destination, &value, sizeof (value));
+    destination += sizeof (value);
+}
+
+juce::uint32 floatBits (float value) noexcept
+{
+    juce::uint32 bits = 0;
+    std::memcpy (&bits, &value, sizeof (bits));
+    return bits;
+}
+
+float bitsToFloat (juce::uint32 bits) noexcept
+{
+    auto value = 0.0f;
+    std::memcpy (&value, &bits, sizeof (value));
+    return value;
+}
+
+bool readBinary (const char* data, size_t size, const std::vector<StateFormat::ParameterEntry>& entries, StateFormat::Snapshot& snapshot)
+{
+    if (size < headerBytes || juce::ByteOrder::littleEndianInt (data) != StateFormat::magic)
+        return false;
+
+    // A later version may lay its fields out differently, so this build does not guess at
+    // it; every version up to this one is a prefix of the current layout.
+    const auto version = juce::ByteOrder::littleEndianShort (data + 4);
+
+    if (version == 0 || version > StateFormat::formatVersion)
+        return false;
+
+    const auto count = static_cast<size_t> (juce::ByteOrder::littleEndianShort (data + 6));
+    auto* position = data + headerBytes;
+    const auto* end = data + size;
+
+    if (static_cast<size_t> (end - position) < count * entryBytes)
+        return false;
+
+    for (size_t index = 0; index < count; ++index, position += entryBytes)
+    {
+        const auto entryIndex = findEntry (entries, juce::ByteOrder::littleEndianInt (position), index);
+
+        if (entryIndex >= 0)
+            snapshot.values[static_cast<size_t> (entryIndex)] = bitsToFloat (juce::ByteOrder::littleEndianInt (position + 4));
+    }
+
+    if (static_cast<size_t> (end - position) >= linkGroupLengthBytes)
+    {
+        const auto length = static_cast<size_t> (juce::ByteOrder::littleEndianShort (position));
+        position += linkGroupLengthBytes;
+
+        if (static_cast<size_t> (end - position) < length)
+            return false;
+
+        snapshot.linkGroup = juce::String::fromUTF8 (position, static_cast<int> (length));
+        position += length;
+    }
+
+    if (version >= 2 && static_cast<size_t> (end - position) >= slotCountBytes)
+    {
+        const auto slotCount = static_cast<int> (juce::ByteOrder::littleEndianShort (position));
+        position += slotCountBytes;
+        const auto& targetHashes = getMorphTargetHashes();
+
+        for (auto slot = 0; slot < slotCount && static_cast<size_t> (end - position) >= slotHeaderBytes; ++slot)
+        {
+            const auto stored = *position != 0;
+            const auto valueCount = static_cast<size_t> (juce::ByteOrder::littleEndianShort (position + 1));
+            position += slotHeaderBytes;
+
+            if (static_cast<size_t> (end - position) < valueCount * entryBytes)
+                break;
+
+            // Slots beyond the ones this build has are skipped over.
+            const auto known = slot < PresetSlots::numSlots;
+
+            for (size_t index = 0; index < valueCount; ++index, position += entryBytes)
+            {
+                if (! known)
+                    continue;
+
+                const auto hash = juce::ByteOrder::littleEndianInt (position);
+                auto& values = snapshot.slotValues[static_cast<size_t> (slot)];
+
+                for (size_t target = 0; target < targetHashes.size(); ++target)
+                    if (targetHashes[target] == hash)
+                        values[target] = bitsToFloat (juce::ByteOrder::littleEndianInt (position + 4));
+            }
+
+            if (known)
+                snapshot.slotStored[static_cast<size_t> (slot)] = stored;
+        }
+    }
+
+    return true;
+}
+
+// The ValueTree XML written before the binary format: <PARAMETERS linkGroup="...">
+// holding one <PARAM id="..." value="..."/> per parameter. Each child is visited once.
+bool readLegacyXml (const void* data, int sizeInBytes, const std::vector<StateFormat::ParameterEntry>& entries, StateFormat::Snapshot& snapshot)
+{
+    const auto xml = juce::AudioProcessor::getXmlFromBinary (data, sizeInBytes);
+
+    if (xml == nullptr || ! xml->hasTagName ("PARAMETERS"))
+        return false;
+
+    snapshot.linkGroup = xml->getStringAttribute ("linkGroup");
+    size_t childIndex = 0;
+
+    for (auto* child : xml->getChildWithTagNameIterator ("PARAM"))
+    {
+        const auto entryIndex = findEntry (entries, StateFormat::hashParameterID (child->getStringAttribute ("id").toRawUTF8()), childIndex++);
+
+        if (entryIndex >= 0 && child->hasAttribute ("value"))
+            snapshot.values[static_cast<size_t> (entryIndex)] = static_cast<float> (child->getDoubleAttribute ("value"));
+    }
+
+    return true;
+}
+
+void applyMigrations (const std::vector<StateFormat::ParameterEntry>& entries, StateFormat::Snapshot& snapshot) noexcept
+{
+    for (size_t index = 0; index < entries.size(); ++index)
+    {
+        auto& value = snapshot.values[index];
+
+        if (! std::isnan (value))
+            continue;
+
+        const auto& entry = entries[index];
+        value = entry.parameter->convertFrom0to1 (entry.parameter->getDefaultValue());
+
+        for (const auto& migration : migrations)
+            if (StateFormat::hashParameterID (migration.parameterID) == entry.idHash)
+                value = migration.legacyValue;
+    }
+
+    // A slot saved before a parameter existed holds what the state itself holds for it.
+    const auto& targetHashes = getMorphTargetHashes();
+
+    for (auto& slotValues : snapshot.slotValues)
+    {
+        for (size_t target = 0; target < slotValues.size(); ++target)
+        {
+            if (! std::isnan (slotValues[target]))
+                continue;
+
+            const auto entryIndex = findEntry (entries, targetHashes[target], target);
+            slotValues[target] = entryIndex >= 0 ? snapshot.values[static_cast<size_t> (entryIndex)] : 0.0f;
+        }
+    }
+}
+}
+
+juce::uint32 StateFormat::hashParameterID (const char* parameterID) noexcept
+{
+    auto hash = static_cast<juce::uint32> (2166136261u);
+
+    for (auto* c = parameterID; *c != 0; ++c)
+    {
+        hash ^= static_cast<juce::uint8> (*c);
+        hash *= static_cast<juce::uint32> (16777619u);
+    }
+
+    return hash;
+}
+
+std::vector<StateFormat::ParameterEntry> StateFormat::makeEntries (juce::AudioProcessor& processor, juce::AudioProcessorValueTreeState& apvts)
+{
+    std::vector<ParameterEntry> entries;
+
+    for (auto* parameter : processor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+        {
+            const auto& parameterID = ranged->getParameterID();
+            entries.push_back ({ ranged, apvts.getRawParameterValue (parameterID), hashParameterID (parameterID.toRawUTF8()) });
+        }
+    }
+
+    for (size_t index = 0; index < entries.size(); ++index)
+        for (auto other = index + 1; other < entries.size(); ++other)
+            jassert (entries[index].idHash != entries[other].idHash); // rename the newer parameter
+
+    return entries;
+}
+
+void StateFormat::write (const std::vector<ParameterEntry>& entries, const juce::String& linkGroup,
+                         const PresetSlots& presetSlots, juce::MemoryBlock& destination)
+{
+    const auto linkGroupBytes = juce::jmin (linkGroup.getNumBytesAsUTF8(), static_cast<size_t> (std::numeric_limits<juce::uint16>::max()));
+    const auto slotBytes = slotCountBytes + PresetSlots::numSlots * (slotHeaderBytes + Parameters::MorphTargets::count * entryBytes);
+    destination.setSize (headerBytes + entries.size() * entryBytes + linkGroupLengthBytes + linkGroupBytes + slotBytes);
+
+    auto* position = static_cast<char*> (destination.getData());
+    writeUInt32 (position, magic);
+    writeUInt16 (position, formatVersion);
+    writeUInt16 (position, static_cast<juce::uint16> (entries.size()));
+
+    for (const auto& entry : entries)
+    {
+        writeUInt32 (position, entry.idHash);
+        writeUInt32 (position, floatBits (entry.value->load (std::memory_order_relaxed)));
+    }
+
+    writeUInt16 (position, static_cast<juce::uint16> (linkGroupBytes));
+    std::memcpy (position, linkGroup.toRawUTF8(), linkGroupBytes);
+    position += linkGroupBytes;
+
+    // Empty slots are written too, so every state has the same size.
+    const auto& targetHashes = getMorphTargetHashes();
+    writeUInt16 (position, static_cast<juce::uint16> (PresetSlots::numSlots));
+
+    for (auto slot = 0; slot < PresetSlots::numSlots; ++slot)
+    {
+        PresetSlots::Values values {};
+        const auto stored = presetSlots.load (slot, values);
+
+        writeUInt8 (position, stored ? 1 : 0);
+        writeUInt16 (position, static_cast<juce::uint16> (values.size()));
+
+        for (size_t index = 0; index < values.size(); ++index)
+        {
+            writeUInt32 (position, targetHashes[index]);
+            writeUInt32 (position, floatBits (values[index]));
+        }
+    }
+}
+
+bool StateFormat::read (const void* data, int sizeInBytes, const std::vector<ParameterEntry>& entries, Snapshot& snapshot)
+{
+    if (data == nullptr || sizeInBytes <= 0)
+        return false;
+
+    std::fill (snapshot.values.begin(), snapshot.values.end(), std::numeric_limits<float>::quiet_NaN());
+    snapshot.linkGroup = {};
+    snapshot.slotStored.fill (false);
+
+    for (auto& slotValues : snapshot.slotValues)
+        slotValues.fill (std::numeric_limits<float>::quiet_NaN());
+
+    // Data with the magic is never handed on to the XML reader, so a binary state from a
+    // later version is rejected rather than misread.
+    const auto* bytes = static_cast<const char*> (data);
+    const auto isBinary = static_cast<size_t> (sizeInBytes) >= sizeof (magic) && juce::ByteOrder::littleEndianInt (bytes) == magic;
+
+    if (isBinary ? ! readBinary (bytes, static_cast<size_t> (sizeInBytes), entries, snapshot)
+                 : ! readLegacyXml (data, sizeInBytes, entries, snapshot))
+        return false;
+
+    applyMigrations (entries, snapshot);
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+#include "PresetSlots.h"
+
+// Binary plugin state, all little-endian:
+//   uint32 magic, uint16 format version, uint16 parameter count,
+//   count x { uint32 FNV-1a hash of the parameter ID, float32 plain value },
+//   uint16 link group byte count, link group as UTF-8,
+//   (v2) uint16 preset slot count, per slot { uint8 stored, uint16 value count,
+//   value count x { uint32 ID hash, float32 plain value } }.
+// Parameters are matched by ID hash, so reordering or adding parameters never breaks an
+// older state. Anything without the magic is read as the XML states saved before it.
+namespace StateFormat
+{
+inline constexpr juce::uint32 magic = 0x53433243; // "C2CS"
+inline constexpr juce::uint16 formatVersion = 2;
+
+struct ParameterEntry
+{
+    juce::RangedAudioParameter* parameter = nullptr;
+    std::atomic<float>* value = nullptr;
+    juce::uint32 idHash = 0;
+};
+
+// A decoded state: one plain value per entry (NaN where the state had none), the link
+// group and the preset slots. Sized once by prepare() and reused for every load.
+struct Snapshot
+{
+    void prepare (size_t numEntries) { values.assign (numEntries, 0.0f); }
+
+    std::vector<float> values;
+    juce::String linkGroup;
+    std::array<PresetSlots::Values, PresetSlots::numSlots> slotValues {};
+    std::array<bool, PresetSlots::numSlots> slotStored {};
+};
+
+juce::uint32 hashParameterID (const char* parameterID) noexcept;
+
+// Builds the entry list for every ranged parameter in apvts.
+std::vector<ParameterEntry> makeEntries (juce::AudioProcessor& processor, juce::AudioProcessorValueTreeState& apvts);
+
+void write (const std::vector<ParameterEntry>& entries, const juce::String& linkGroup,
+            const PresetSlots& presetSlots, juce::MemoryBlock& destination);
+
+// Reads a binary or legacy XML state into snapshot, then fills what it lacked from the
+// migration table or the parameter defaults. A stored slot missing a value takes the
+// state's own value for it; states older than v2 have no stored slots. False, leaving the
+// snapshot unusable, when the data is neither or is a binary state of a later format
+// version than this build writes.
+bool read (const void* data, int sizeInBytes, const std::vector<ParameterEntry>& entries, Snapshot& snapshot);
+}
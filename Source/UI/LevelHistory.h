@@ -0,0 +1,209 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "../DSP/MeterFrameFifo.h"
+
+// Input level and gain reduction over time, as min/max pairs in 16-bit hundredths of a dB,
+// kept at doubling resolutions: level 0 has one entry per 5 ms of audio and level k one
+// per 5 ms * 2^k. Every level is a ring of the same length, so each spans twice the time
+// of the one below and the top one well over ten minutes. Appending costs one write plus
+// at most one merge per level; a span of any length reads from the level whose entries
+// are about its width, touching a handful of entries.
+class LevelHistory
+{
+public:
+    static constexpr int numLevels = 8;
+    static constexpr int entriesPerLevel = 4096; // power of two; also the widest view in pixels
+    static constexpr double entrySeconds = 0.005;
+
+    struct Entry
+    {
+        juce::int16 levelMin = std::numeric_limits<juce::int16>::max();
+        juce::int16 levelMax = std::numeric_limits<juce::int16>::min();
+        juce::int16 grMin = std::numeric_limits<juce::int16>::max();
+        juce::int16 grMax = std::numeric_limits<juce::int16>::min();
+
+        bool isEmpty() const noexcept { return levelMin > levelMax; }
+
+        void merge (const Entry& other) noexcept
+        {
+            levelMin = juce::jmin (levelMin, other.levelMin);
+            levelMax = juce::jmax (levelMax, other.levelMax);
+            grMin = juce::jmin (grMin, other.grMin);
+            grMax = juce::jmax (grMax, other.grMax);
+        }
+
+        static juce::int16 fromDb (float db) noexcept
+        {
+            return static_cast<juce::int16> (std::lround (juce::jlimit (-320.0f, 320.0f, db) * 100.0f));
+        }
+
+        static float toDb (juce::int16 value) noexcept
+        {
+            return static_cast<float> (value) * 0.01f;
+        }
+    };
+
+    LevelHistory()
+    {
+        for (auto& level : levels)
+            level.resize (static_cast<size_t> (entriesPerLevel));
+    }
+
+    void clear() noexcept
+    {
+        numEntries = 0;
+        current = {};
+        currentSamples = 0.0;
+
+        for (auto& pending : pendingHalves)
+            pending.reset();
+
+        numGaps = 0;
+    }
+
+    // Records that the frames pushed next do not follow on from the ones before, e.g. after
+    // nothing was metered for a while. A part-filled entry is closed first so that no entry
+    // spans the gap. Only the newest maxGaps are kept.
+    void markGap() noexcept
+    {
+        if (currentSamples > 0.0)
+        {
+            append (0, current);
+            current = {};
+            currentSamples = 0.0;
+        }
+
+        if (numEntries == 0 || (numGaps > 0 && gaps[static_cast<size_t> ((numGaps - 1) & (maxGaps - 1))] == numEntries))
+            return;
+
+        gaps[static_cast<size_t> (numGaps & (maxGaps - 1))] = numEntries;
+        ++numGaps;
+    }
+
+    // True if a gap falls between level-0 positions start (inclusive) and end.
+    bool hasGapWithin (juce::int64 start, juce::int64 end) const noexcept
+    {
+        for (auto index = juce::jmax<juce::int64> (0, numGaps - maxGaps); index < numGaps; ++index)
+        {
+            const auto position = gaps[static_cast<size_t> (index & (maxGaps - 1))];
+
+            if (position >= start && position < end)
+                return true;
+        }
+
+        return false;
+    }
+
+    // One block's levels: its RMS to peak, and its GR range. Blocks shorter than an entry
+    // are combined; a longer block fills every entry it spans.
+    void push (const MeterFrame& frame, double sampleRate) noexcept
+    {
+        const auto samplesPerEntry = juce::jmax (1.0, sampleRate * entrySeconds);
+
+        Entry block;
+        block.levelMin = Entry::fromDb (juce::Decibels::gainToDecibels (frame.inputRms, -100.0f));
+        block.levelMax = Entry::fromDb (juce::Decibels::gainToDecibels (frame.inputPeak, -100.0f));
+        block.grMin = Entry::fromDb (frame.minGainReductionDb);
+        block.grMax = Entry::fromDb (frame.maxGainReductionDb);
+
+        for (auto remaining = static_cast<double> (frame.numSamples); remaining > 0.0;)
+        {
+            const auto taken = juce::jmin (remaining, samplesPerEntry - currentSamples);
+            current.merge (block);
+            currentSamples += taken;
+            remaining -= taken;
+
+            if (currentSamples >= samplesPerEntry - 1.0e-6)
+            {
+                append (0, current);
+                current = {};
+                currentSamples = 0.0;
+            }
+        }
+    }
+
+    // Level-0 entries appended so far; positions below count in these units.
+    juce::int64 getNumEntries() const noexcept { return numEntries; }
+
+    // Everything between level-0 positions start and end combined, rounded outwards to
+    // the entries of the level that fits the span. Empty where history has run out.
+    Entry getRange (juce::int64 start, juce::int64 end) const noexcept
+    {
+        const auto span = juce::jmax<juce::int64> (1, end - start);
+        auto level = 0;
+
+        while (level + 1 < numLevels && (juce::int64 { 2 } << level) <= span)
+            ++level;
+
+        return getRange (start, end, level);
+    }
+
+private:
+    Entry getRange (juce::int64 start, juce::int64 end, int level) const noexcept
+    {
+        Entry result;
+        const auto& ring = levels[static_cast<size_t> (level)];
+        const auto completeAtLevel = numEntries >> level;
+
+        for (auto index = juce::jmax<juce::int64> (0, start) >> level; index <= (end - 1) >> level; ++index)
+        {
+            if (index < completeAtLevel)
+            {
+                if (index >= completeAtLevel - entriesPerLevel)
+                    result.merge (ring[static_cast<size_t> (index & (entriesPerLevel - 1))]);
+            }
+            else if (level > 0)
+            {
+                // The newest coarse entry is still being combined; read its finer halves.
+                result.merge (getRange (juce::jmax (start, index << level),
+                                        juce::jmin (end, (index + 1) << level),
+                                        level - 1));
+            }
+        }
+
+        return result;
+    }
+
+    void append (int level, const Entry& entry) noexcept
+    {
+        if (level == 0)
+            ++numEntries;
+
+        // A level-k entry closes whenever numEntries reaches a multiple of 2^k.
+        const auto index = (numEntries >> level) - 1;
+        levels[static_cast<size_t> (level)][static_cast<size_t> (index & (entriesPerLevel - 1))] = entry;
+
+        if (level + 1 >= numLevels)
+            return;
+
+        auto& pending = pendingHalves[static_cast<size_t> (level + 1)];
+
+        if (! pending.has_value())
+        {
+            pending = entry;
+            return;
+        }
+
+        auto combined = *pending;
+        combined.merge (entry);
+        pending.reset();
+        append (level + 1, combined);
+    }
+
+    std::array<std::vector<Entry>, numLevels> levels;
+    std::array<std::optional<Entry>, numLevels> pendingHalves;
+    juce::int64 numEntries = 0;
+    Entry current;
+    double currentSamples = 0.0;
+
+    static constexpr int maxGaps = 16; // power of two
+    std::array<juce::int64, maxGaps> gaps {};
+    juce::int64 numGaps = 0;
+};
@@ -0,0 +1,206 @@
+#include "LevelHistoryComponent.h"
+
+namespace
+{
+constexpr std::array<double, 10> zoomSeconds { 1.0, 2.0, 5.0, 10.0, 20.0, 30.0, 60.0, 120.0, 300.0, 600.0 };
+}
+
+void LevelHistoryComponent::addFrame (const MeterFrame& frame, double sampleRate) noexcept
+{
+    history.push (frame, sampleRate);
+}
+
+void LevelHistoryComponent::markGap() noexcept
+{
+    history.markGap();
+}
+
+juce::int64 LevelHistoryComponent::getNewestCompleteColumn() const noexcept
+{
+    return static_cast<juce::int64> (std::floor (static_cast<double> (history.getNumEntries()) / entriesPerColumn)) - 1;
+}
+
+int LevelHistoryComponent::getNumColumns() const noexcept
+{
+    return juce::roundToInt (static_cast<float> (getWidth()) * layerScale);
+}
+
+void LevelHistoryComponent::update()
+{
+    const auto width = getNumColumns();
+
+    if (width <= 0 || getHeight() <= 0)
+        return;
+
+    const auto newestColumn = getNewestCompleteColumn();
+
+    if (needsFullRedraw || ! graph.isValid() || newestColumn - lastDrawnColumn >= width)
+    {
+        redrawAll (newestColumn);
+        repaint();
+        return;
+    }
+
+    const auto newColumns = static_cast<int> (newestColumn - lastDrawnColumn);
+
+    if (newColumns <= 0)
+        return;
+
+    graph.moveImageSection (0, 0, newColumns, 0, width - newColumns, graph.getHeight());
+    graph.clear ({ width - newColumns, 0, newColumns, graph.getHeight() });
+
+    juce::Graphics g (graph);
+
+    for (auto column = lastDrawnColumn + 1; column <= newestColumn; ++column)
+        drawColumn (g, width - 1 - static_cast<int> (newestColumn - column), column);
+
+    lastDrawnColumn = newestColumn;
+
+    // Left of the oldest column there is nothing to move until the history fills the width.
+    const auto firstColumn = juce::jmax<juce::int64> (0, width - 1 - newestColumn);
+    repaint (getLocalBounds().withLeft (static_cast<int> (static_cast<float> (firstColumn) / layerScale)));
+}
+
+void LevelHistoryComponent::redrawAll (juce::int64 newestColumn)
+{
+    const auto width = getNumColumns();
+    graph = juce::Image (juce::Image::ARGB, juce::jmax (1, width), juce::jmax (1, juce::roundToInt (static_cast<float> (getHeight()) * layerScale)), true);
+
+    juce::Graphics g (graph);
+
+    for (auto x = 0; x < width; ++x)
+        drawColumn (g, x, newestColumn - (width - 1 - x));
+
+    lastDrawnColumn = newestColumn;
+    needsFullRedraw = false;
+}
+
+void LevelHistoryComponent::drawColumn (juce::Graphics& g, int x, juce::int64 column) const
+{
+    if (column < 0)
+        return;
+
+    const auto start = static_cast<juce::int64> (std::floor (static_cast<double> (column) * entriesPerColumn));
+    const auto end = juce::jmax (start + 1, static_cast<juce::int64> (std::floor (static_cast<double> (column + 1) * entriesPerColumn)));
+    const auto entry = history.getRange (start, end);
+
+    if (entry.isEmpty())
+        return;
+
+    const auto height = static_cast<float> (graph.getHeight());
+    const auto levelToY = [height] (float db) { return height * juce::jlimit (0.0f, 1.0f, -db / levelRangeDb); };
+    const auto grToY = [height] (float db) { return height * juce::jlimit (0.0f, 1.0f, db / grRangeDb); };
+    const auto left = static_cast<float> (x);
+
+    const auto levelTop = levelToY (LevelHistory::Entry::toDb (entry.levelMax));
+    const auto rmsTop = levelToY (LevelHistory::Entry::toDb (entry.levelMin));
+
+    g.setColour (juce::Colour::fromRGB (45, 150, 110).withAlpha (0.55f));
+    g.fillRect (left, levelTop, 1.0f, height - levelTop);
+    g.setColour (juce::Colour::fromRGB (99, 210, 160).withAlpha (0.8f));
+    g.fillRect (left, rmsTop, 1.0f, height - rmsTop);
+
+    const auto grLeast = grToY (LevelHistory::Entry::toDb (entry.grMin));
+    const auto grMost = grToY (LevelHistory::Entry::toDb (entry.grMax));
+
+    g.setColour (juce::Colour::fromRGB (240, 160, 75).withAlpha (0.3f));
+    g.fillRect (left, 0.0f, 1.0f, grLeast);
+    g.setColour (juce::Colour::fromRGB (240, 160, 75).withAlpha (0.9f));
+    g.fillRect (left, grLeast, 1.0f, juce::jmax (1.0f, grMost - grLeast));
+
+    // History resumes here after a stretch that was never metered.
+    if (history.hasGapWithin (start, end))
+    {
+        g.setColour (juce::Colours::white.withAlpha (0.5f));
+        g.fillRect (left, 0.0f, 1.0f, height);
+    }
+}
+
+void LevelHistoryComponent::renderLayers()
+{
+    const auto bounds = getLocalBounds().toFloat();
+    const auto imageWidth = juce::jmax (1, juce::roundToInt (bounds.getWidth() * layerScale));
+    const auto imageHeight = juce::jmax (1, juce::roundToInt (bounds.getHeight() * layerScale));
+
+    background = juce::Image (juce::Image::ARGB, imageWidth, imageHeight, true);
+    overlay = juce::Image (juce::Image::ARGB, imageWidth, imageHeight, true);
+
+    {
+        juce::Graphics g (background);
+        g.addTransform (juce::AffineTransform::scale (layerScale));
+
+        g.setColour (juce::Colours::black.withAlpha (0.25f));
+        g.fillRoundedRectangle (bounds, 8.0f);
+    }
+
+    {
+        juce::Graphics g (overlay);
+        g.addTransform (juce::AffineTransform::scale (layerScale));
+
+        // 6 dB of gain reduction per line from the top.
+        g.setColour (juce::Colours::white.withAlpha (0.08f));
+
+        for (auto db = 6.0f; db < grRangeDb; db += 6.0f)
+            g.drawHorizontalLine (juce::roundToInt (bounds.getHeight() * db / grRangeDb), 0.0f, bounds.getWidth());
+
+        const auto seconds = zoomSeconds[static_cast<size_t> (zoomIndex)];
+        const auto span = seconds >= 60.0 ? juce::String (juce::roundToInt (seconds / 60.0)) + " min"
+                                          : juce::String (juce::roundToInt (seconds)) + " s";
+
+        g.setFont (juce::FontOptions { 11.0f });
+        g.setColour (juce::Colours::white.withAlpha (0.45f));
+        g.drawText ("GR / IN  " + span, bounds.reduced (6.0f, 3.0f), juce::Justification::bottomLeft);
+    }
+}
+
+void LevelHistoryComponent::paint (juce::Graphics& g)
+{
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    // Moving to a display of another scale changes the column count, so the zoom is
+    // worked out again and every column redrawn.
+    if (scale != layerScale || ! background.isValid())
+    {
+        layerScale = scale;
+        setZoomIndex (zoomIndex);
+    }
+
+    if (needsFullRedraw || ! graph.isValid())
+        redrawAll (getNewestCompleteColumn());
+
+    const auto unscale = juce::AffineTransform::scale (1.0f / layerScale);
+    g.drawImageTransformed (background, unscale);
+
+    if (graph.isValid())
+        g.drawImageTransformed (graph, unscale);
+
+    g.drawImageTransformed (overlay, unscale);
+}
+
+void LevelHistoryComponent::resized()
+{
+    setZoomIndex (zoomIndex);
+    repaint();
+}
+
+void LevelHistoryComponent::mouseWheelMove (const juce::MouseEvent&, const juce::MouseWheelDetails& wheel)
+{
+    // Up zooms in.
+    if (wheel.deltaY != 0.0f)
+    {
+        setZoomIndex (zoomIndex + (wheel.deltaY > 0.0f ? -1 : 1));
+        update();
+    }
+}
+
+// Works out the column span for the zoom and size and re-renders the static layers; the
+// graph itself is redrawn by the next update() or paint().
+void LevelHistoryComponent::setZoomIndex (int newIndex)
+{
+    zoomIndex = juce::jlimit (0, static_cast<int> (zoomSeconds.size()) - 1, newIndex);
+
+    const auto entries = zoomSeconds[static_cast<size_t> (zoomIndex)] / LevelHistory::entrySeconds;
+    entriesPerColumn = entries / static_cast<double> (juce::jlimit (1, LevelHistory::entriesPerLevel, getNumColumns()));
+    needsFullRedraw = true;
+    renderLayers();
+}
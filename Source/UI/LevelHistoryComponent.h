@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "LevelHistory.h"
+
+// Scrolling input level (RMS to peak, rising from the bottom) and gain reduction (hanging
+// from the top) over the last 1 s to 10 min; the mouse wheel zooms. The graph is kept in
+// an image at the display's physical resolution, one column per physical pixel: each
+// update() shifts it left by the columns that completed since the last one, draws only
+// those and repaints only the part holding history. Only a zoom, size or scale change
+// renders every column again. The background, grid and label are cached in layers of
+// their own, so painting is three image blits.
+class LevelHistoryComponent : public juce::Component
+{
+public:
+    void addFrame (const MeterFrame& frame, double sampleRate) noexcept;
+
+    // Call when frames resume after a stretch that was not metered, e.g. the editor being
+    // hidden; the graph marks the join with a line.
+    void markGap() noexcept;
+
+    // Call after adding frames, e.g. from the editor's timer.
+    void update();
+
+private:
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+    void mouseWheelMove (const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
+
+    void setZoomIndex (int newIndex);
+    void renderLayers();
+    void redrawAll (juce::int64 newestColumn);
+    void drawColumn (juce::Graphics& g, int x, juce::int64 column) const;
+    juce::int64 getNewestCompleteColumn() const noexcept;
+    int getNumColumns() const noexcept;
+
+    static constexpr float levelRangeDb = 60.0f;
+    static constexpr float grRangeDb = 24.0f;
+
+    LevelHistory history;
+    juce::Image background;
+    juce::Image graph;
+    juce::Image overlay;
+    float layerScale = 1.0f;
+    int zoomIndex = 3;
+    double entriesPerColumn = 1.0;
+    juce::int64 lastDrawnColumn = -1;
+    bool needsFullRedraw = true;
+};
@@ -7,57 +7,132 @@ MeterComponent::MeterComponent (juce::String meterName, Type meterType)
     {
         minDb = 0.0f;
         maxDb = 30.0f;
-        targetDb = 0.0f;
         displayedDb = 0.0f;
-        lastPaintedDb = 0.0f;
+        rangeLowDb = 0.0f;
+        rangeHighDb = 0.0f;
+        heldPeakDb = 0.0f;
     }
+
+    displayedText = formatValueText (displayedDb);
 }
 
 void MeterComponent::setDbValue (float newDb) noexcept
 {
-    targetDb = juce::jlimit (minDb, maxDb, newDb);
-    displayedDb = targetDb;
+    newDb = juce::jlimit (minDb, maxDb, newDb);
 
     // Repaint only when movement is meaningful to keep GUI work low.
-    if (std::abs (displayedDb - lastPaintedDb) >= 0.05f)
+    if (std::abs (newDb - displayedDb) < 0.05f)
+        return;
+
+    repaint (getRowsBetween (displayedDb, newDb, 1));
+    displayedDb = newDb;
+
+    auto text = formatValueText (displayedDb);
+
+    if (text != displayedText)
     {
-        lastPaintedDb = displayedDb;
-        repaint();
+        displayedText = std::move (text);
+        repaint (valueArea);
     }
 }
 
-void MeterComponent::paint (juce::Graphics& g)
+void MeterComponent::setBlockRangeDb (float lowDb, float highDb) noexcept
 {
-    auto bounds = getLocalBounds().toFloat();
+    if (type == Type::inputOutput && highDb >= 0.0f && ! clipped)
+    {
+        clipped = true;
+        repaint (clipArea);
+    }
 
-    g.setColour (juce::Colours::white.withAlpha (0.08f));
-    g.fillRoundedRectangle (bounds, 8.0f);
+    lowDb = juce::jlimit (minDb, maxDb, lowDb);
+    highDb = juce::jlimit (minDb, maxDb, juce::jmax (lowDb, highDb));
 
-    g.setColour (juce::Colours::white.withAlpha (0.16f));
-    g.drawRoundedRectangle (bounds.reduced (0.5f), 8.0f, 1.0f);
+    const auto nowMs = juce::Time::getMillisecondCounter();
 
+    if (highDb >= heldPeakDb || nowMs - heldPeakMs > peakHoldMs)
+    {
+        if (std::abs (highDb - heldPeakDb) >= 0.05f)
+        {
+            repaint (getRowsBetween (heldPeakDb, heldPeakDb, 2));
+            repaint (getRowsBetween (highDb, highDb, 2));
+        }
+
+        heldPeakDb = highDb;
+        heldPeakMs = nowMs;
+    }
+
+    if (std::abs (lowDb - rangeLowDb) < 0.05f && std::abs (highDb - rangeHighDb) < 0.05f)
+        return;
+
+    // Only the rows between the old and new edges change; the marker at the top is 2 px.
+    repaint (getRowsBetween (rangeLowDb, lowDb, 1));
+    repaint (getRowsBetween (rangeHighDb, highDb, 2));
+    rangeLowDb = lowDb;
+    rangeHighDb = highDb;
+}
+
+void MeterComponent::resized()
+{
     auto content = getLocalBounds().reduced (8);
-    auto nameArea = content.removeFromTop (20);
-    auto valueArea = content.removeFromBottom (18);
-    auto meterArea = content.reduced (4, 0);
+    nameArea = content.removeFromTop (20);
+    valueArea = content.removeFromBottom (18);
+    meterArea = content.reduced (4, 0);
+    clipArea = nameArea.withLeft (nameArea.getRight() - 12).withSizeKeepingCentre (10, 8);
+    layerScale = 0.0f;
+}
 
-    g.setColour (juce::Colours::white.withAlpha (0.9f));
-    g.setFont (juce::FontOptions { 13.0f, juce::Font::bold });
-    g.drawText (name, nameArea, juce::Justification::centred);
+void MeterComponent::mouseDown (const juce::MouseEvent&)
+{
+    if (clipped)
+    {
+        clipped = false;
+        repaint (clipArea);
+    }
+}
 
-    g.setColour (juce::Colours::white.withAlpha (0.85f));
-    g.setFont (juce::FontOptions { 12.0f });
-    g.drawText (formatValueText (displayedDb), valueArea, juce::Justification::centred);
+void MeterComponent::renderLayers (float scale)
+{
+    layerScale = scale;
+
+    const auto toPixels = [scale] (int size) { return juce::jmax (1, juce::roundToInt (static_cast<float> (size) * scale)); };
+
+    staticLayer = juce::Image (juce::Image::ARGB, toPixels (getWidth()), toPixels (getHeight()), true);
+
+    {
+        juce::Graphics g (staticLayer);
+        g.addTransform (juce::AffineTransform::scale (scale));
+
+        auto bounds = getLocalBounds().toFloat();
+
+        g.setColour (juce::Colours::white.withAlpha (0.08f));
+        g.fillRoundedRectangle (bounds, 8.0f);
+
+        g.setColour (juce::Colours::white.withAlpha (0.16f));
+        g.drawRoundedRectangle (bounds.reduced (0.5f), 8.0f, 1.0f);
 
-    g.setColour (juce::Colours::black.withAlpha (0.28f));
-    g.fillRoundedRectangle (meterArea.toFloat(), 5.0f);
+        g.setColour (juce::Colours::white.withAlpha (0.9f));
+        g.setFont (juce::FontOptions { 13.0f, juce::Font::bold });
+        g.drawText (name, nameArea, juce::Justification::centred);
+
+        g.setColour (juce::Colours::black.withAlpha (0.28f));
+        g.fillRoundedRectangle (meterArea.toFloat(), 5.0f);
+
+        // Scale ticks along the left edge.
+        const auto ticks = type == Type::gainReduction ? juce::Array<float> { 3.0f, 6.0f, 12.0f, 20.0f }
+                                                       : juce::Array<float> { -6.0f, -12.0f, -24.0f, -48.0f };
+        g.setColour (juce::Colours::white.withAlpha (0.25f));
+
+        for (const auto db : ticks)
+            g.fillRect (static_cast<float> (meterArea.getX()), dbToY (db), 5.0f, 1.0f);
+    }
 
-    const auto normalised = dbToNormalised (displayedDb);
-    const auto fillHeight = meterArea.getHeight() * normalised;
-    auto fillArea = meterArea.withTop (meterArea.getBottom() - juce::roundToInt (fillHeight));
+    fillLayer = juce::Image (juce::Image::ARGB, toPixels (meterArea.getWidth()), toPixels (meterArea.getHeight()), true);
 
-    if (! fillArea.isEmpty())
     {
+        juce::Graphics g (fillLayer);
+        g.addTransform (juce::AffineTransform::scale (scale));
+
+        const auto area = meterArea.withZeroOrigin().toFloat();
         const auto topColour = type == Type::gainReduction
                                   ? juce::Colour::fromRGB (240, 160, 75)
                                   : juce::Colour::fromRGB (99, 210, 160);
@@ -65,14 +140,60 @@ void MeterComponent::paint (juce::Graphics& g)
                                      ? juce::Colour::fromRGB (208, 112, 52)
                                      : juce::Colour::fromRGB (45, 150, 110);
 
-        const auto fillAreaF = fillArea.toFloat();
-        juce::ColourGradient gradient (topColour, fillAreaF.getCentreX(), fillAreaF.getY(),
-                                       bottomColour, fillAreaF.getCentreX(), fillAreaF.getBottom(),
-                                       false);
+        g.setGradientFill (juce::ColourGradient (topColour, area.getCentreX(), area.getY(),
+                                                 bottomColour, area.getCentreX(), area.getBottom(),
+                                                 false));
+        g.fillRoundedRectangle (area, 4.0f);
+    }
+}
+
+void MeterComponent::paint (juce::Graphics& g)
+{
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (scale != layerScale || ! staticLayer.isValid())
+        renderLayers (scale);
+
+    const auto unscale = juce::AffineTransform::scale (1.0f / layerScale);
+    g.drawImageTransformed (staticLayer, unscale);
+
+    const auto fillTop = juce::roundToInt (dbToY (displayedDb));
+
+    if (fillTop < meterArea.getBottom())
+    {
+        juce::Graphics::ScopedSaveState state (g);
+        g.reduceClipRegion (meterArea.withTop (fillTop));
+        g.drawImageTransformed (fillLayer, unscale.translated (meterArea.getPosition().toFloat()));
+    }
+
+    const auto meterAreaF = meterArea.toFloat();
+
+    if (rangeHighDb > minDb)
+    {
+        const auto highY = dbToY (rangeHighDb);
+
+        g.setColour (juce::Colours::white.withAlpha (0.14f));
+        g.fillRect (meterAreaF.withTop (highY).withBottom (dbToY (rangeLowDb)));
 
-        g.setGradientFill (gradient);
-        g.fillRoundedRectangle (fillAreaF, 4.0f);
+        g.setColour (juce::Colours::white.withAlpha (0.85f));
+        g.fillRect (meterAreaF.getX(), highY - 1.0f, meterAreaF.getWidth(), 2.0f);
     }
+
+    if (heldPeakDb > minDb)
+    {
+        g.setColour (juce::Colours::white.withAlpha (0.5f));
+        g.fillRect (meterAreaF.getX(), dbToY (heldPeakDb) - 1.0f, meterAreaF.getWidth(), 1.0f);
+    }
+
+    if (type == Type::inputOutput)
+    {
+        g.setColour (clipped ? juce::Colour::fromRGB (235, 70, 60) : juce::Colours::white.withAlpha (0.12f));
+        g.fillRoundedRectangle (clipArea.toFloat(), 2.0f);
+    }
+
+    g.setColour (juce::Colours::white.withAlpha (0.85f));
+    g.setFont (juce::FontOptions { 12.0f });
+    g.drawText (displayedText, valueArea, juce::Justification::centred);
 }
 
 float MeterComponent::dbToNormalised (float db) const noexcept
@@ -80,6 +201,22 @@ float MeterComponent::dbToNormalised (float db) const noexcept
     return juce::jlimit (0.0f, 1.0f, (db - minDb) / juce::jmax (0.0001f, maxDb - minDb));
 }
 
+float MeterComponent::dbToY (float db) const noexcept
+{
+    return static_cast<float> (meterArea.getBottom()) - static_cast<float> (meterArea.getHeight()) * dbToNormalised (db);
+}
+
+// The full-width rows of the meter between two levels, widened by margin pixels.
+juce::Rectangle<int> MeterComponent::getRowsBetween (float dbA, float dbB, int margin) const noexcept
+{
+    const auto yA = dbToY (dbA);
+    const auto yB = dbToY (dbB);
+    const auto top = static_cast<int> (std::floor (juce::jmin (yA, yB))) - margin;
+    const auto bottom = static_cast<int> (std::ceil (juce::jmax (yA, yB))) + margin;
+
+    return meterArea.withTop (top).withBottom (bottom).getIntersection (meterArea.expanded (0, margin));
+}
+
 juce::String MeterComponent::formatValueText (float db) const
 {
     if (type == Type::gainReduction)
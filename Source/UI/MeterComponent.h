@@ -2,6 +2,10 @@
 
 #include <JuceHeader.h>
 
+// Vertical level or gain reduction meter. The frame, name and scale are rendered once per
+// size and display scale into an image, and so is the full-height gradient the bar is cut
+// from; a paint is then a few clipped blits. Value changes repaint only the rows of the
+// bar, band or marker that moved, and the readout only when its text changes.
 class MeterComponent : public juce::Component
 {
 public:
@@ -15,10 +19,20 @@ public:
 
     void setDbValue (float newDb) noexcept;
 
+    // Range the signal covered since the last call, drawn as a band over the bar with a line
+    // at its top: RMS to peak for levels, least to most reduction for GR. Also drives the
+    // peak hold and, for levels, the clip indicator (latched until clicked).
+    void setBlockRangeDb (float lowDb, float highDb) noexcept;
+
 private:
     void paint (juce::Graphics& g) override;
+    void resized() override;
+    void mouseDown (const juce::MouseEvent& event) override;
 
+    void renderLayers (float scale);
     float dbToNormalised (float db) const noexcept;
+    float dbToY (float db) const noexcept;
+    juce::Rectangle<int> getRowsBetween (float dbA, float dbB, int margin) const noexcept;
     juce::String formatValueText (float db) const;
 
     juce::String name;
@@ -26,7 +40,22 @@ private:
 
     float minDb = -60.0f;
     float maxDb = 0.0f;
-    float targetDb = -60.0f;
     float displayedDb = -60.0f;
-    float lastPaintedDb = -60.0f;
+    juce::String displayedText;
+    float rangeLowDb = -60.0f;
+    float rangeHighDb = -60.0f;
+    float heldPeakDb = -60.0f;
+    juce::uint32 heldPeakMs = 0;
+    bool clipped = false;
+
+    static constexpr juce::uint32 peakHoldMs = 1500;
+
+    juce::Rectangle<int> nameArea;
+    juce::Rectangle<int> clipArea;
+    juce::Rectangle<int> valueArea;
+    juce::Rectangle<int> meterArea;
+
+    juce::Image staticLayer;
+    juce::Image fillLayer;
+    float layerScale = 0.0f;
 };
@@ -0,0 +1,190 @@
+#include "SidechainSpectrumComponent.h"
+#include "../Parameters.h"
+
+SidechainSpectrumComponent::SidechainSpectrumComponent (TwoCCompressorAudioProcessor& processorToWatch)
+    : processor (processorToWatch),
+      fftData (static_cast<size_t> (2 * fftSize), 0.0f)
+{
+    setInterceptsMouseClicks (false, false);
+    smoothedDb.fill (minDb);
+
+    scHpfHzParam = processorToWatch.getAPVTS().getRawParameterValue (Parameters::IDs::scHpfHz);
+    scHpfEnabledParam = processorToWatch.getAPVTS().getRawParameterValue (Parameters::IDs::scHpfEnabled);
+}
+
+void SidechainSpectrumComponent::setActive (bool shouldBeActive)
+{
+    if (shouldBeActive == consumer.has_value())
+        return;
+
+    if (shouldBeActive)
+    {
+        consumer.emplace (processor);
+        startTimerHz (30);
+    }
+    else
+    {
+        stopTimer();
+        consumer.reset();
+    }
+}
+
+void SidechainSpectrumComponent::timerCallback()
+{
+    const auto rate = consumer->getSampleRate();
+
+    // New sample rate: what is in the history no longer lines up with the bins.
+    if (rate != analysisRate)
+    {
+        analysisRate = rate;
+        history.fill (0.0f);
+        historyPosition = 0;
+        samplesSinceFrame = 0;
+        smoothedDb.fill (minDb);
+    }
+
+    auto framesAnalysed = 0;
+
+    for (;;)
+    {
+        const auto count = consumer->pop (incoming.data(), static_cast<int> (incoming.size()));
+
+        if (count <= 0)
+            break;
+
+        for (auto i = 0; i < count; ++i)
+        {
+            history[static_cast<size_t> (historyPosition)] = incoming[static_cast<size_t> (i)];
+            historyPosition = (historyPosition + 1) % fftSize;
+
+            if (++samplesSinceFrame >= hopSize)
+            {
+                samplesSinceFrame = 0;
+                analyseFrame();
+                ++framesAnalysed;
+            }
+        }
+    }
+
+    const auto hpfHz = scHpfHzParam != nullptr ? scHpfHzParam->load (std::memory_order_relaxed) : 0.0f;
+    const auto hpfEnabled = scHpfEnabledParam != nullptr && scHpfEnabledParam->load (std::memory_order_relaxed) >= 0.5f;
+
+    if (framesAnalysed > 0 || hpfHz != paintedHpfHz || hpfEnabled != paintedHpfEnabled)
+    {
+        paintedHpfHz = hpfHz;
+        paintedHpfEnabled = hpfEnabled;
+        repaint();
+    }
+}
+
+// Fast attack, slow release per bin, so transients register and the floor stays readable.
+void SidechainSpectrumComponent::analyseFrame()
+{
+    const auto oldest = history.begin() + historyPosition;
+    std::copy (history.begin(), oldest, std::copy (oldest, history.end(), fftData.begin()));
+    std::fill (fftData.begin() + fftSize, fftData.end(), 0.0f);
+    window.multiplyWithWindowingTable (fftData.data(), static_cast<size_t> (fftSize));
+    fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+
+    // Hann coherent gain is 1/2, so a full-scale sine reads 0 dB.
+    const auto scale = 4.0f / static_cast<float> (fftSize);
+
+    for (auto bin = 0; bin < numBins; ++bin)
+    {
+        const auto db = juce::jmax (minDb, juce::Decibels::gainToDecibels (fftData[static_cast<size_t> (bin)] * scale, minDb));
+        auto& smoothed = smoothedDb[static_cast<size_t> (bin)];
+        smoothed = db > smoothed ? db : smoothed + 0.15f * (db - smoothed);
+    }
+}
+
+float SidechainSpectrumComponent::frequencyToX (float hz, float width) const noexcept
+{
+    const auto maxHz = juce::jmax (minHz * 2.0f, static_cast<float> (0.5 * analysisRate));
+    return width * std::log (juce::jmax (hz, minHz) / minHz) / std::log (maxHz / minHz);
+}
+
+void SidechainSpectrumComponent::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+
+    g.setColour (juce::Colours::black.withAlpha (0.25f));
+    g.fillRoundedRectangle (bounds, 8.0f);
+
+    const auto width = bounds.getWidth();
+    const auto height = bounds.getHeight();
+    const auto dbToY = [height] (float db)
+    {
+        return juce::jmap (juce::jlimit (minDb, maxDb, db), minDb, maxDb, height, 0.0f);
+    };
+
+    // Decades and 30 dB lines.
+    g.setColour (juce::Colours::white.withAlpha (0.08f));
+
+    for (const auto hz : { 100.0f, 1000.0f })
+        g.drawVerticalLine (juce::roundToInt (frequencyToX (hz, width)), 0.0f, height);
+
+    for (const auto db : { -30.0f, -60.0f })
+        g.drawHorizontalLine (juce::roundToInt (dbToY (db)), 0.0f, width);
+
+    g.setFont (juce::FontOptions { 11.0f });
+    g.setColour (juce::Colours::white.withAlpha (0.45f));
+    g.drawText ("SC", bounds.reduced (6.0f, 3.0f), juce::Justification::topLeft);
+
+    if (analysisRate <= 0.0)
+        return;
+
+    juce::Path spectrum;
+    const auto binHz = static_cast<float> (analysisRate / fftSize);
+
+    for (auto bin = 1; bin < numBins; ++bin)
+    {
+        const auto point = juce::Point<float> (frequencyToX (static_cast<float> (bin) * binHz, width),
+                                               dbToY (smoothedDb[static_cast<size_t> (bin)]));
+
+        if (bin == 1)
+            spectrum.startNewSubPath (point);
+        else
+            spectrum.lineTo (point);
+    }
+
+    auto fill = spectrum;
+    fill.lineTo (width, height);
+    fill.lineTo (0.0f, height);
+    fill.closeSubPath();
+
+    g.setColour (juce::Colour::fromRGB (99, 210, 160).withAlpha (0.18f));
+    g.fillPath (fill);
+    g.setColour (juce::Colour::fromRGB (99, 210, 160).withAlpha (0.8f));
+    g.strokePath (spectrum, juce::PathStrokeType (1.2f));
+
+    // The detector HPF is one-pole, rolling off 6 dB per octave under the cutoff; it is
+    // drawn from the top of the scale so its shape reads against the spectrum.
+    if (paintedHpfHz <= 0.0f)
+        return;
+
+    const auto cutoff = juce::jlimit (20.0f, 250.0f, paintedHpfHz);
+    juce::Path response;
+
+    for (auto x = 0; x <= juce::roundToInt (width); x += 2)
+    {
+        const auto hz = minHz * std::pow (juce::jmax (minHz * 2.0f, static_cast<float> (0.5 * analysisRate)) / minHz,
+                                          static_cast<float> (x) / width);
+        const auto db = 20.0f * std::log10 (hz / std::sqrt (hz * hz + cutoff * cutoff));
+        const auto point = juce::Point<float> (static_cast<float> (x), dbToY (db));
+
+        if (x == 0)
+            response.startNewSubPath (point);
+        else
+            response.lineTo (point);
+    }
+
+    const auto hpfColour = juce::Colour::fromRGB (75, 174, 224).withAlpha (paintedHpfEnabled ? 0.95f : 0.35f);
+    const auto cutoffX = frequencyToX (cutoff, width);
+
+    g.setColour (hpfColour);
+    g.strokePath (response, juce::PathStrokeType (1.5f));
+    g.drawVerticalLine (juce::roundToInt (cutoffX), 0.0f, height);
+    g.drawText (juce::String (juce::roundToInt (cutoff)) + " Hz",
+                juce::Rectangle<float> (cutoffX + 4.0f, 2.0f, 60.0f, 14.0f),
+                juce::Justification::centredLeft);
+}
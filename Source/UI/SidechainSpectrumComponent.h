@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "../PluginProcessor.h"
+
+// Spectrum of the compressor's detector input with the sidechain HPF response drawn over
+// it. The audio thread only copies decimated samples into a FIFO; the FFTs run here on the
+// message thread, from the timer. The FIFO is fed only while the component is active, so
+// a hidden or closed editor stops the analysis entirely.
+class SidechainSpectrumComponent : public juce::Component,
+                                   private juce::Timer
+{
+public:
+    explicit SidechainSpectrumComponent (TwoCCompressorAudioProcessor& processorToWatch);
+
+    // Starts or stops the feed and the analysis; starts inactive.
+    void setActive (bool shouldBeActive);
+
+private:
+    void paint (juce::Graphics& g) override;
+    void timerCallback() override;
+
+    void analyseFrame();
+    float frequencyToX (float hz, float width) const noexcept;
+
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+    static constexpr int numBins = fftSize / 2;
+    static constexpr float minDb = -90.0f;
+    static constexpr float maxDb = 0.0f;
+    static constexpr float minHz = 20.0f;
+
+    TwoCCompressorAudioProcessor& processor;
+    std::optional<TwoCCompressorAudioProcessor::SpectrumConsumer> consumer;
+    std::atomic<float>* scHpfHzParam = nullptr;
+    std::atomic<float>* scHpfEnabledParam = nullptr;
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { static_cast<size_t> (fftSize), juce::dsp::WindowingFunction<float>::hann };
+
+    std::array<float, fftSize> history {};        // ring of the last fftSize samples
+    int historyPosition = 0;                      // where the next sample goes, i.e. the oldest
+    int samplesSinceFrame = 0;
+    std::vector<float> fftData;                   // 2 * fftSize, as performFrequencyOnlyForwardTransform wants
+    std::array<float, numBins> smoothedDb {};
+    std::array<float, 512> incoming {};
+
+    double analysisRate = 0.0;
+    float paintedHpfHz = -1.0f;
+    bool paintedHpfEnabled = false;
+};
@@ -0,0 +1,69 @@
+#include "StageProfileOverlay.h"
+
+StageProfileOverlay::StageProfileOverlay (const Diagnostics::StageProfiler& profilerToShow)
+    : profiler (profilerToShow)
+{
+    setInterceptsMouseClicks (false, false);
+
+    for (auto stage = 0; stage < Diagnostics::StageProfiler::numStages; ++stage)
+        rows[static_cast<size_t> (stage)].name = Diagnostics::StageProfiler::getStageName (stage);
+}
+
+void StageProfileOverlay::refresh()
+{
+    const auto total = profiler.getSummary (Diagnostics::StageProfiler::total);
+
+    // Nothing new has been processed since the last refresh.
+    if (total.blocks == blocksShown)
+        return;
+
+    blocksShown = total.blocks;
+
+    for (auto stage = 0; stage < Diagnostics::StageProfiler::numStages; ++stage)
+    {
+        const auto summary = profiler.getSummary (stage);
+        auto& row = rows[static_cast<size_t> (stage)];
+        row.meanPerSample = summary.meanPerSample;
+        row.p99PerSample = summary.p99PerSample;
+
+        // Stages that skip blocks (saturation, true peak) are weighted by how often they ran.
+        const auto totalCost = total.meanPerSample * static_cast<double> (total.blocks);
+        row.share = totalCost > 0.0 ? static_cast<float> (summary.meanPerSample * static_cast<double> (summary.blocks) / totalCost) : 0.0f;
+    }
+
+    repaint();
+}
+
+void StageProfileOverlay::paint (juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+
+    g.setColour (juce::Colours::black.withAlpha (0.78f));
+    g.fillRoundedRectangle (bounds, 8.0f);
+
+    auto content = getLocalBounds().reduced (8);
+    const auto rowHeight = juce::jmin (18, content.getHeight() / (static_cast<int> (rows.size()) + 1));
+
+    g.setFont (juce::FontOptions { 12.0f, juce::Font::bold });
+    g.setColour (juce::Colours::white.withAlpha (0.6f));
+
+    auto header = content.removeFromTop (rowHeight);
+    g.drawText ("stage", header.removeFromLeft (header.proportionOfWidth (0.4f)), juce::Justification::centredLeft);
+    g.drawText ("mean / p99 ns per sample", header, juce::Justification::centredRight);
+
+    g.setFont (juce::FontOptions { 12.0f });
+
+    for (const auto& row : rows)
+    {
+        auto line = content.removeFromTop (rowHeight);
+
+        // Share of the total cost as a bar behind the text.
+        g.setColour (juce::Colour::fromRGB (90, 170, 255).withAlpha (0.25f));
+        g.fillRect (line.withWidth (juce::roundToInt (static_cast<float> (line.getWidth()) * juce::jlimit (0.0f, 1.0f, row.share))));
+
+        g.setColour (juce::Colours::white.withAlpha (0.9f));
+        g.drawText (row.name, line.removeFromLeft (line.proportionOfWidth (0.4f)), juce::Justification::centredLeft);
+        g.drawText (juce::String (row.meanPerSample, 1) + " / " + juce::String (row.p99PerSample, 1),
+                    line, juce::Justification::centredRight);
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+#include "../Diagnostics/StageProfiler.h"
+
+// Small table of the processor's stage timings (mean and p99 nanoseconds per sample, and each
+// stage's share of the total), drawn over the meters. Only built into the editor when the
+// stage profiler is compiled in; refresh() is called from the editor's timer.
+class StageProfileOverlay : public juce::Component
+{
+public:
+    explicit StageProfileOverlay (const Diagnostics::StageProfiler& profilerToShow);
+
+    void refresh();
+
+private:
+    void paint (juce::Graphics& g) override;
+
+    struct Row
+    {
+        juce::String name;
+        double meanPerSample = 0.0;
+        double p99PerSample = 0.0;
+        float share = 0.0f;
+    };
+
+    const Diagnostics::StageProfiler& profiler;
+    std::array<Row, Diagnostics::StageProfiler::numStages> rows;
+    juce::int64 blocksShown = -1;
+};
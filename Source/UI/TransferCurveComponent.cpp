@@ -0,0 +1,135 @@
+#include "TransferCurveComponent.h"
+
+TransferCurveComponent::TransferCurveComponent (const TwoCCompressorAudioProcessor& processorToShow)
+    : processor (processorToShow)
+{
+    setInterceptsMouseClicks (false, false);
+}
+
+void TransferCurveComponent::update()
+{
+    // The settings the last block ran with; with no block since the previous frame (transport
+    // stopped, or bypassed) the controls, so edits still move the curve.
+    CompressorDSP::Parameters latest;
+    const auto updates = processor.curveUpdates.load (std::memory_order_acquire);
+
+    if (updates != lastCurveUpdates)
+    {
+        latest.thresholdDb = processor.curveThresholdDb.load (std::memory_order_relaxed);
+        latest.ratio = processor.curveRatio.load (std::memory_order_relaxed);
+        latest.kneeDb = processor.curveKneeDb.load (std::memory_order_relaxed);
+        latest.characterMode = processor.curveCharacterMode.load (std::memory_order_relaxed);
+        lastCurveUpdates = updates;
+    }
+    else
+    {
+        latest = processor.getCurveFromControls();
+    }
+
+    if (latest.thresholdDb != curve.thresholdDb || latest.ratio != curve.ratio
+        || latest.kneeDb != curve.kneeDb || latest.characterMode != curve.characterMode)
+    {
+        curve = latest;
+        curveScale = 0.0f;
+        repaint();
+    }
+
+    const auto inputDb = juce::jmin (maxDb, processor.gainComputerInputDb.load (std::memory_order_relaxed));
+    const auto visible = inputDb > minDb;
+    const auto newDot = toPoint (inputDb, inputDb - CompressorDSP::computeGainReductionDb (curve, inputDb));
+
+    if (visible == dotVisible && (! visible || newDot.getDistanceFrom (dot) < 0.5f))
+        return;
+
+    if (dotVisible)
+        repaint (getDotBounds());
+
+    dot = newDot;
+    dotVisible = visible;
+
+    if (dotVisible)
+        repaint (getDotBounds());
+}
+
+void TransferCurveComponent::resized()
+{
+    curveScale = 0.0f;
+}
+
+juce::Point<float> TransferCurveComponent::toPoint (float inputDb, float outputDb) const noexcept
+{
+    const auto area = getLocalBounds().reduced (6).toFloat();
+    const auto toUnit = [] (float db) { return juce::jlimit (0.0f, 1.0f, (db - minDb) / (maxDb - minDb)); };
+
+    return { area.getX() + area.getWidth() * toUnit (inputDb),
+             area.getBottom() - area.getHeight() * toUnit (outputDb) };
+}
+
+juce::Rectangle<int> TransferCurveComponent::getDotBounds() const noexcept
+{
+    return juce::Rectangle<float> (dotRadius * 2.0f, dotRadius * 2.0f).withCentre (dot).getSmallestIntegerContainer().expanded (1);
+}
+
+void TransferCurveComponent::renderCurve (float scale)
+{
+    curveScale = scale;
+    curveImage = juce::Image (juce::Image::ARGB,
+                              juce::jmax (1, juce::roundToInt (static_cast<float> (getWidth()) * scale)),
+                              juce::jmax (1, juce::roundToInt (static_cast<float> (getHeight()) * scale)),
+                              true);
+
+    juce::Graphics g (curveImage);
+    g.addTransform (juce::AffineTransform::scale (scale));
+
+    g.setColour (juce::Colours::black.withAlpha (0.25f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 8.0f);
+
+    // 12 dB grid and the unity line.
+    g.setColour (juce::Colours::white.withAlpha (0.08f));
+
+    for (auto db = minDb + 12.0f; db < maxDb; db += 12.0f)
+    {
+        const auto point = toPoint (db, db);
+        g.drawVerticalLine (juce::roundToInt (point.x), toPoint (minDb, maxDb).y, toPoint (minDb, minDb).y);
+        g.drawHorizontalLine (juce::roundToInt (point.y), toPoint (minDb, minDb).x, toPoint (maxDb, minDb).x);
+    }
+
+    g.drawLine ({ toPoint (minDb, minDb), toPoint (maxDb, maxDb) }, 1.0f);
+
+    juce::Path path;
+    const auto steps = juce::jmax (2, getWidth());
+
+    for (auto step = 0; step <= steps; ++step)
+    {
+        const auto inputDb = juce::jmap (static_cast<float> (step) / static_cast<float> (steps), minDb, maxDb);
+        const auto point = toPoint (inputDb, inputDb - CompressorDSP::computeGainReductionDb (curve, inputDb));
+
+        if (step == 0)
+            path.startNewSubPath (point);
+        else
+            path.lineTo (point);
+    }
+
+    g.setColour (juce::Colour::fromRGB (75, 174, 224).withAlpha (0.95f));
+    g.strokePath (path, juce::PathStrokeType (1.5f));
+
+    g.setFont (juce::FontOptions { 11.0f });
+    g.setColour (juce::Colours::white.withAlpha (0.45f));
+    g.drawText ("CURVE", getLocalBounds().reduced (6, 3).toFloat(), juce::Justification::topLeft);
+}
+
+void TransferCurveComponent::paint (juce::Graphics& g)
+{
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (scale != curveScale || ! curveImage.isValid())
+        renderCurve (scale);
+
+    g.drawImageTransformed (curveImage, juce::AffineTransform::scale (1.0f / curveScale));
+
+    if (dotVisible)
+    {
+        g.setColour (juce::Colour::fromRGB (240, 160, 75));
+        g.fillEllipse (juce::Rectangle<float> (dotRadius * 2.0f, dotRadius * 2.0f).withCentre (dot));
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "../PluginProcessor.h"
+
+// The compressor's static input/output curve, computed by the same gain computer the DSP
+// runs, with a dot at the level the detector is currently feeding it. The curve is drawn
+// into an image that is rebuilt only when threshold, ratio, knee or character change (or
+// the size or display scale); a frame otherwise only repaints the dot's old and new spot.
+class TransferCurveComponent : public juce::Component
+{
+public:
+    explicit TransferCurveComponent (const TwoCCompressorAudioProcessor& processorToShow);
+
+    // Once per display frame.
+    void update();
+
+private:
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+    void renderCurve (float scale);
+    juce::Point<float> toPoint (float inputDb, float outputDb) const noexcept;
+    juce::Rectangle<int> getDotBounds() const noexcept;
+
+    static constexpr float minDb = -60.0f;
+    static constexpr float maxDb = 0.0f;
+    static constexpr float dotRadius = 3.5f;
+
+    const TwoCCompressorAudioProcessor& processor;
+    CompressorDSP::Parameters curve;
+    juce::uint32 lastCurveUpdates = 0;
+    juce::Image curveImage;
+    float curveScale = 0.0f;
+    juce::Point<float> dot;
+    bool dotVisible = false;
+};
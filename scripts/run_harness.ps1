@@ -21,7 +21,7 @@ try {
     $buildDir = "build"
     $config = "Release"
 
-    Invoke-Step "Configure CMake" { cmake -S . -B $buildDir }
+    Invoke-Step "Configure CMake" { cmake -S . -B $buildDir -DTWOC_TEST_HOOKS=ON }
     Invoke-Step "Build Release" { cmake --build $buildDir --config $config }
 
     $harness = Get-ChildItem -Path $buildDir -Recurse -File -Filter "vst3_harness.exe" |
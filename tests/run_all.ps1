@@ -104,6 +104,57 @@ function Resolve-WetPath {
   return (Get-FirstWavOrThrow $Directory)
 }
 
+# Writes a stereo 32-bit float WAV of 1 kHz sine segments, each @{ Seconds = n; Db = level }
+# with the same level in both channels. Whole seconds hold whole periods, so one second
+# per segment is computed and repeated.
+function New-SineWav {
+  param(
+    [Parameter(Mandatory = $true)][string]$Path,
+    [Parameter(Mandatory = $true)][int]$SampleRate,
+    [Parameter(Mandatory = $true)][object[]]$Segments
+  )
+
+  $totalSeconds = 0
+  foreach ($segment in $Segments) {
+    $totalSeconds += [int]$segment.Seconds
+  }
+  $dataBytes = [int64]$totalSeconds * $SampleRate * 2 * 4
+
+  $writer = [System.IO.BinaryWriter]::new([System.IO.File]::Create($Path))
+  try {
+    $writer.Write([System.Text.Encoding]::ASCII.GetBytes("RIFF"))
+    $writer.Write([uint32](36 + $dataBytes))
+    $writer.Write([System.Text.Encoding]::ASCII.GetBytes("WAVEfmt "))
+    $writer.Write([uint32]16)
+    $writer.Write([uint16]3)              # IEEE float
+    $writer.Write([uint16]2)
+    $writer.Write([uint32]$SampleRate)
+    $writer.Write([uint32]($SampleRate * 8))
+    $writer.Write([uint16]8)
+    $writer.Write([uint16]32)
+    $writer.Write([System.Text.Encoding]::ASCII.GetBytes("data"))
+    $writer.Write([uint32]$dataBytes)
+
+    foreach ($segment in $Segments) {
+      $amplitude = [Math]::Pow(10.0, [double]$segment.Db / 20.0)
+      $second = New-Object float[] ($SampleRate * 2)
+      for ($i = 0; $i -lt $SampleRate; $i++) {
+        $value = [float]($amplitude * [Math]::Sin(2.0 * [Math]::PI * 1000.0 * $i / $SampleRate))
+        $second[2 * $i] = $value
+        $second[2 * $i + 1] = $value
+      }
+      $bytes = New-Object byte[] ($second.Length * 4)
+      [System.Buffer]::BlockCopy($second, 0, $bytes, 0, $bytes.Length)
+      for ($s = 0; $s -lt [int]$segment.Seconds; $s++) {
+        $writer.Write($bytes)
+      }
+    }
+  }
+  finally {
+    $writer.Dispose()
+  }
+}
+
 function Invoke-RenderCase {
   param(
     [Parameter(Mandatory = $true)][string]$OutDir,
@@ -263,6 +314,43 @@ Invoke-TestCase -Name "P0 bypass null" -Body {
   Write-Host ""
 }
 
+Invoke-TestCase -Name "P0c bypass null with true-peak latency" -Body {
+  # -------------------------
+  # Test P0c: Bypass with the true-peak stage on is a pure delayed copy of the input
+  # -------------------------
+  $P0cDir = ".\artifacts\test_p0c_bypass_latency"
+  $P0cParams = Build-SetParams -ParameterIndexMap $paramIndexMap -ValuesByName @{
+    "Bypass" = 1.0
+    "True Peak" = 1.0
+    "Threshold" = 0.0
+    "Makeup" = 1.0
+  }
+  Reset-Directory $P0cDir
+  & $Harness render --plugin $Plugin --in $Dry --outdir $P0cDir --sr $Sr --bs $Bs --ch $Ch --warmup $Warmup --set-params $P0cParams
+  if ($LASTEXITCODE -ne 0) {
+    throw "Harness render failed in P0c (exit code $LASTEXITCODE)"
+  }
+  $WetP0c = Resolve-WetPath $P0cDir
+
+  # Aligned at the latency the plugin reports, not at whatever lag nulls best: a host
+  # compensates by exactly that much.
+  $P0cLatency = [int](Get-Content (Join-Path $P0cDir "probe.json") -Raw | ConvertFrom-Json).latency_samples
+  if ($P0cLatency -le 0) {
+    throw "P0c: true peak on but no latency reported"
+  }
+  $P0cAnalysisDir = Join-Path $P0cDir "analysis"
+  Reset-Directory $P0cAnalysisDir
+  & $Harness analyze --dry $Dry --wet $WetP0c --outdir $P0cAnalysisDir --lag $P0cLatency --null
+  if ($LASTEXITCODE -ne 0) {
+    throw "Harness analyze failed in P0c (exit code $LASTEXITCODE)"
+  }
+  $P0cMetrics = Read-Metrics $P0cAnalysisDir
+  $results.Add([pscustomobject]@{ Test = "P0c bypass null with true-peak latency"; Rms_dB = $P0cMetrics.RmsDb; Peak_dB = $P0cMetrics.PeakDb })
+  Assert-Lt "P0c RMS" $P0cMetrics.RmsDb -120
+  Assert-Lt "P0c Peak" $P0cMetrics.PeakDb -100
+  Write-Host ""
+}
+
 Invoke-TestCase -Name "P0b neutral controls" -Body {
   # -------------------------
   # Test P0b: Neutral controls null-ish (informational, no hard fail)
@@ -559,6 +647,396 @@ Invoke-TestCase -Name "OS mode differences" -Body {
   }
 }
 
+Invoke-TestCase -Name "Auto makeup block-size invariance" -Body {
+  # -------------------------
+  # Test: auto makeup runs on a sample clock, so renders at any host block size must null.
+  # No warmup: silent warmup blocks would otherwise cover different durations per block size.
+  # -------------------------
+  $InvarianceParams = Build-SetParams -ParameterIndexMap $paramIndexMap -ValuesByName @{
+    "Timing" = 1.0
+    "Threshold" = 0.15
+    "Ratio" = 0.95
+    "Auto Makeup" = 1.0
+    "Drive" = 0.0
+    "Sat Mix" = 0.0
+    "Oversampling" = 0.0
+    "Mix" = 1.0
+    "Bypass" = 0.0
+  }
+
+  $InvarianceWet = @{}
+  foreach ($blockSize in @(32, 512, 8192)) {
+    $InvarianceDir = ".\artifacts\test_auto_makeup_bs$blockSize"
+    Reset-Directory $InvarianceDir
+    & $Harness render --plugin $Plugin --in $DryKick --outdir $InvarianceDir --sr $Sr --bs $blockSize --ch $Ch --warmup 0 --set-params $InvarianceParams
+    if ($LASTEXITCODE -ne 0) {
+      throw "Harness render failed at block size $blockSize (exit code $LASTEXITCODE)"
+    }
+    $InvarianceWet[$blockSize] = Resolve-WetPath $InvarianceDir
+  }
+
+  foreach ($blockSize in @(32, 8192)) {
+    $InvarianceAnalysisDir = ".\artifacts\test_auto_makeup_bs512_vs_bs$blockSize\analysis"
+    Invoke-AnalyzeCase -DryPath $InvarianceWet[512] -WetPath $InvarianceWet[$blockSize] -OutDir $InvarianceAnalysisDir -DoNull
+    $InvarianceMetrics = Read-Metrics $InvarianceAnalysisDir
+    $results.Add([pscustomobject]@{ Test = "Auto makeup bs512 vs bs$blockSize"; Rms_dB = $InvarianceMetrics.RmsDb; Peak_dB = $InvarianceMetrics.PeakDb })
+    Assert-Lt "Auto makeup bs512 vs bs$blockSize RMS" $InvarianceMetrics.RmsDb -120
+    Assert-Lt "Auto makeup bs512 vs bs$blockSize Peak" $InvarianceMetrics.PeakDb -100
+  }
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "Eco mode offline null" -Body {
+  # -------------------------
+  # Test: offline renders have no deadline, so eco mode must never change them.
+  # -------------------------
+  $EcoWet = @{}
+  foreach ($eco in @(0, 1)) {
+    $EcoParams = Build-SetParams -ParameterIndexMap $paramIndexMap -ValuesByName @{
+      "Threshold" = 0.3
+      "Ratio" = 0.6
+      "Drive" = 0.7
+      "Sat Mix" = 1.0
+      "Oversampling" = 1.0
+      "Bypass" = 0.0
+      "Eco" = [double]$eco
+    }
+    $EcoDir = ".\artifacts\test_eco_offline_$eco"
+    Reset-Directory $EcoDir
+    # Under the same simulated load that makes the realtime case below step down.
+    & $Harness render --plugin $Plugin --in $Dry --outdir $EcoDir --sr $Sr --bs $Bs --ch $Ch --warmup $Warmup --set-params $EcoParams --load-scale 1000
+    if ($LASTEXITCODE -ne 0) {
+      throw "Harness render failed with Eco=$eco (exit code $LASTEXITCODE)"
+    }
+    $EcoWet[$eco] = Resolve-WetPath $EcoDir
+  }
+
+  $EcoAnalysisDir = ".\artifacts\test_eco_offline_null\analysis"
+  Invoke-AnalyzeCase -DryPath $EcoWet[0] -WetPath $EcoWet[1] -OutDir $EcoAnalysisDir -DoNull
+  $EcoMetrics = Read-Metrics $EcoAnalysisDir
+  $results.Add([pscustomobject]@{ Test = "Eco mode offline null"; Rms_dB = $EcoMetrics.RmsDb; Peak_dB = $EcoMetrics.PeakDb })
+  Assert-Lt "Eco offline RMS" $EcoMetrics.RmsDb -120
+  Assert-Lt "Eco offline Peak" $EcoMetrics.PeakDb -100
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "Eco mode steps down under load" -Body {
+  # -------------------------
+  # Test: a realtime render on a simulated slow machine (every block timed 1000x longer)
+  # drops below full quality with Eco on, and never does with Eco off.
+  # -------------------------
+  $EcoTier = @{}
+  foreach ($eco in @(0, 1)) {
+    $EcoLoadParams = Build-SetParams -ParameterIndexMap $paramIndexMap -ValuesByName @{
+      "Drive" = 0.7
+      "Sat Mix" = 1.0
+      "Oversampling" = 1.0
+      "Bypass" = 0.0
+      "Eco" = [double]$eco
+    }
+    $EcoLoadDir = ".\artifacts\test_eco_load_$eco"
+    Reset-Directory $EcoLoadDir
+    & $Harness render --plugin $Plugin --in $Dry --outdir $EcoLoadDir --sr $Sr --bs $Bs --ch $Ch --warmup $Warmup --set-params $EcoLoadParams --realtime --load-scale 1000
+    if ($LASTEXITCODE -ne 0) {
+      throw "Harness realtime render failed with Eco=$eco (exit code $LASTEXITCODE)"
+    }
+    $ProbePath = Join-Path $EcoLoadDir "probe.json"
+    if (-not (Test-Path $ProbePath)) {
+      throw "No probe written to $ProbePath"
+    }
+    $EcoTier[$eco] = [int](Get-Content $ProbePath -Raw | ConvertFrom-Json).quality_tier
+  }
+
+  Write-Host "Quality tier under load: Eco off $($EcoTier[0]), Eco on $($EcoTier[1])"
+  if ($EcoTier[0] -ne 0) {
+    throw "Eco off left full quality (tier $($EcoTier[0]))"
+  }
+  if ($EcoTier[1] -le 0) {
+    throw "Eco on never stepped down under load (tier $($EcoTier[1]))"
+  }
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "A/B with empty slots null" -Body {
+  # -------------------------
+  # Test: engaging A/B before anything is stored keeps running from the controls, at any morph.
+  # -------------------------
+  $CompareWet = @{}
+  foreach ($compare in @(0, 1)) {
+    $CompareParams = Build-SetParams -ParameterIndexMap $paramIndexMap -ValuesByName @{
+      "Threshold" = 0.3
+      "Ratio" = 0.6
+      "Attack" = 0.2
+      "Drive" = 0.5
+      "Sat Mix" = 0.5
+      "Mix" = 0.8
+      "A/B" = [double]$compare
+      "Morph" = 0.5 * $compare
+    }
+    $CompareDir = ".\artifacts\test_ab_empty_$compare"
+    Reset-Directory $CompareDir
+    & $Harness render --plugin $Plugin --in $Dry --outdir $CompareDir --sr $Sr --bs $Bs --ch $Ch --warmup $Warmup --set-params $CompareParams
+    if ($LASTEXITCODE -ne 0) {
+      throw "Harness render failed with A/B=$compare (exit code $LASTEXITCODE)"
+    }
+    $CompareWet[$compare] = Resolve-WetPath $CompareDir
+  }
+
+  $CompareAnalysisDir = ".\artifacts\test_ab_empty_null\analysis"
+  Invoke-AnalyzeCase -DryPath $CompareWet[0] -WetPath $CompareWet[1] -OutDir $CompareAnalysisDir -DoNull
+  $CompareMetrics = Read-Metrics $CompareAnalysisDir
+  $results.Add([pscustomobject]@{ Test = "A/B with empty slots null"; Rms_dB = $CompareMetrics.RmsDb; Peak_dB = $CompareMetrics.PeakDb })
+  Assert-Lt "A/B empty slots RMS" $CompareMetrics.RmsDb -120
+  Assert-Lt "A/B empty slots Peak" $CompareMetrics.PeakDb -100
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "A/B slots glide and survive state" -Body {
+  # -------------------------
+  # Test: with two stored slots (Output -6 dB and +6 dB, compressor neutral), engaging A/B
+  # and morphing from A to B both glide instead of stepping, and a state round-trip
+  # brings both slots back.
+  # -------------------------
+  $NeutralValues = @{
+    "Threshold" = 1.0
+    "Ratio" = 0.0
+    "Drive" = 0.0
+    "Sat Mix" = 0.0
+    "Mix" = 1.0
+    "True Peak" = 0.0
+    "Bypass" = 0.0
+  }
+  $SlotParams = @{}
+  foreach ($slot in @(@{ Name = "A"; Output = 0.25 }, @{ Name = "B"; Output = 0.75 }, @{ Name = "Controls"; Output = 0.5 })) {
+    $Values = $NeutralValues.Clone()
+    $Values["Output"] = $slot.Output
+    $SlotParams[$slot.Name] = Build-SetParams -ParameterIndexMap $paramIndexMap -ValuesByName $Values
+  }
+
+  & $Harness preset-check --plugin $Plugin --sr $Sr --bs $Bs --ch $Ch --slot-a $SlotParams["A"] --slot-b $SlotParams["B"] --set-params $SlotParams["Controls"]
+  if ($LASTEXITCODE -ne 0) {
+    throw "A/B preset check failed (exit code $LASTEXITCODE)"
+  }
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "Link group follows peer, goes stale, frees slot" -Body {
+  # -------------------------
+  # Test: two linked instances in one process. The quiet one follows its louder peer's
+  # gain reduction, drops it once the peer has been silent past the stale time, and
+  # leaving the group releases its slot to the next instance that joins.
+  # -------------------------
+  & $Harness link-check --plugin $Plugin --sr $Sr --bs $Bs --ch $Ch
+  if ($LASTEXITCODE -ne 0) {
+    throw "Link group check failed (exit code $LASTEXITCODE)"
+  }
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "State round-trip" -Body {
+  # -------------------------
+  # Test: non-default settings survive getStateInformation -> setStateInformation exactly,
+  # and the same state is refused when stamped with a later format version or when its
+  # link group runs past the end.
+  # -------------------------
+  $StateParams = Build-SetParams -ParameterIndexMap $paramIndexMap -ValuesByName @{
+    "Input" = 0.7
+    "Threshold" = 0.25
+    "Ratio" = 0.8
+    "Timing" = 1.0
+    "Character" = 1.0
+    "SC HPF On" = 0.0
+    "Auto Makeup" = 1.0
+    "Drive" = 0.4
+    "Oversampling" = 1.0
+    "Mix" = 0.6
+    "True Peak" = 1.0
+  }
+  & $Harness state-bench --plugin $Plugin --iterations 500 --set-params $StateParams
+  if ($LASTEXITCODE -ne 0) {
+    throw "State round-trip failed (exit code $LASTEXITCODE)"
+  }
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "Host call trace replay" -Body {
+  # -------------------------
+  # Test: a render recorded through TWOC_TRACE_FILE replays call for call.
+  # -------------------------
+  $TraceDir = ".\artifacts\test_trace"
+  Reset-Directory $TraceDir
+  $TraceFile = Join-Path (Resolve-Path $TraceDir) "render.c2trace"
+
+  $env:TWOC_TRACE_FILE = $TraceFile
+  try {
+    & $Harness render --plugin $Plugin --in $Dry --outdir $TraceDir --sr $Sr --bs $Bs --ch $Ch --warmup $Warmup
+  }
+  finally {
+    Remove-Item Env:\TWOC_TRACE_FILE -ErrorAction SilentlyContinue
+  }
+  if ($LASTEXITCODE -ne 0) {
+    throw "Harness render failed while tracing (exit code $LASTEXITCODE)"
+  }
+  if (-not (Test-Path $TraceFile)) {
+    throw "No trace written to $TraceFile"
+  }
+
+  & $Harness replay --plugin $Plugin --trace $TraceFile --in $Dry --csv (Join-Path $TraceDir "replay.csv")
+  if ($LASTEXITCODE -ne 0) {
+    throw "Trace replay failed (exit code $LASTEXITCODE)"
+  }
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "Loudness EBU Tech 3341" -Body {
+  # -------------------------
+  # Test: the input loudness meter reads the EBU Tech 3341 sine cases to within 0.1 LU:
+  # a -23 dBFS tone, a -33 dBFS tone, and the relative (case 3) and absolute (case 4)
+  # gating sequences, which must still integrate to -23 LUFS.
+  # -------------------------
+  $LoudnessCases = @(
+    @{ Name = "1"; Expected = -23.0; Segments = @(@{ Seconds = 20; Db = -23.0 }) },
+    @{ Name = "2"; Expected = -33.0; Segments = @(@{ Seconds = 20; Db = -33.0 }) },
+    @{ Name = "3"; Expected = -23.0; Segments = @(@{ Seconds = 10; Db = -36.0 }, @{ Seconds = 60; Db = -23.0 }, @{ Seconds = 10; Db = -36.0 }) },
+    @{ Name = "4"; Expected = -23.0; Segments = @(@{ Seconds = 10; Db = -72.0 }, @{ Seconds = 10; Db = -36.0 }, @{ Seconds = 60; Db = -23.0 }, @{ Seconds = 10; Db = -36.0 }, @{ Seconds = 10; Db = -72.0 }) }
+  )
+
+  foreach ($case in $LoudnessCases) {
+    $LoudnessDir = ".\artifacts\test_loudness_case$($case.Name)"
+    Reset-Directory $LoudnessDir
+    $ToneFile = Join-Path (Resolve-Path $LoudnessDir) "tone.wav"
+    New-SineWav -Path $ToneFile -SampleRate $Sr -Segments $case.Segments
+
+    $RenderDir = Join-Path $LoudnessDir "render"
+    Reset-Directory $RenderDir
+    & $Harness render --plugin $Plugin --in $ToneFile --outdir $RenderDir --sr $Sr --bs $Bs --ch 2 --warmup $Warmup --meter
+    if ($LASTEXITCODE -ne 0) {
+      throw "Harness render failed for loudness case $($case.Name) (exit code $LASTEXITCODE)"
+    }
+    $Probe = Get-Content (Join-Path $RenderDir "probe.json") -Raw | ConvertFrom-Json
+
+    $Integrated = [double]$Probe.loudness_in_integrated_lufs
+    Write-Host "Tech 3341 case $($case.Name): integrated $Integrated LUFS (expected $($case.Expected))"
+    if ([Math]::Abs($Integrated - $case.Expected) -gt 0.1) {
+      throw "Loudness case $($case.Name): integrated $Integrated LUFS, expected $($case.Expected) +/- 0.1"
+    }
+
+    # Steady tones: the sliding windows end on the tone as well.
+    if ($case.Segments.Count -eq 1) {
+      foreach ($window in @("loudness_in_momentary_lufs", "loudness_in_short_term_lufs")) {
+        $Reading = [double]$Probe.$window
+        if ([Math]::Abs($Reading - $case.Expected) -gt 0.1) {
+          throw "Loudness case $($case.Name): $window $Reading LUFS, expected $($case.Expected) +/- 0.1"
+        }
+      }
+    }
+  }
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "Metering skipped without a consumer" -Body {
+  # -------------------------
+  # Test: with no editor nothing reads the meters, so no block runs them; opting in to
+  # telemetry does not change that, since it publishes from levels the block already has.
+  # -------------------------
+  $MeterDir = ".\artifacts\test_metering"
+  Reset-Directory $MeterDir
+
+  & $Harness render --plugin $Plugin --in $Dry --outdir $MeterDir --sr $Sr --bs $Bs --ch $Ch --warmup $Warmup
+  if ($LASTEXITCODE -ne 0) {
+    throw "Harness render failed (exit code $LASTEXITCODE)"
+  }
+  $Probe = Get-Content (Join-Path $MeterDir "probe.json") -Raw | ConvertFrom-Json
+  Write-Host "Metered blocks without a consumer: $($Probe.metered_blocks)"
+  if ($Probe.telemetry_attached) {
+    throw "Telemetry attached without TWOC_TELEMETRY=1"
+  }
+  if ([int64]$Probe.metered_blocks -ne 0) {
+    throw "Metering ran for $($Probe.metered_blocks) blocks with no consumer"
+  }
+
+  $env:TWOC_TELEMETRY = "1"
+  try {
+    & $Harness render --plugin $Plugin --in $Dry --outdir $MeterDir --sr $Sr --bs $Bs --ch $Ch --warmup $Warmup
+  }
+  finally {
+    Remove-Item Env:\TWOC_TELEMETRY -ErrorAction SilentlyContinue
+  }
+  if ($LASTEXITCODE -ne 0) {
+    throw "Harness render failed with telemetry (exit code $LASTEXITCODE)"
+  }
+  $Probe = Get-Content (Join-Path $MeterDir "probe.json") -Raw | ConvertFrom-Json
+  Write-Host "Metered blocks with telemetry attached ($($Probe.telemetry_attached)): $($Probe.metered_blocks)"
+  if ([int64]$Probe.metered_blocks -ne 0) {
+    throw "Telemetry ran the meters for $($Probe.metered_blocks) blocks"
+  }
+
+  # A consumer attached through the plugin's consumer API turns them on for every block.
+  & $Harness render --plugin $Plugin --in $Dry --outdir $MeterDir --sr $Sr --bs $Bs --ch $Ch --warmup $Warmup --meter
+  if ($LASTEXITCODE -ne 0) {
+    throw "Harness render failed with a meter consumer (exit code $LASTEXITCODE)"
+  }
+  $Probe = Get-Content (Join-Path $MeterDir "probe.json") -Raw | ConvertFrom-Json
+  Write-Host "Metered blocks with a consumer: $($Probe.metered_blocks)"
+  if ([int64]$Probe.metered_blocks -le 0) {
+    throw "A meter consumer was attached but no block was metered"
+  }
+  Write-Host ""
+}
+
+Invoke-TestCase -Name "Telemetry top" -Body {
+  # -------------------------
+  # Test: a live instance publishes into the shared telemetry segment, top reads it while
+  # it runs, and the segment is unlinked once the last instance is gone.
+  # POSIX only; Windows hosts have no segment to attach to.
+  # -------------------------
+  if ($IsWindows -or $env:OS -eq "Windows_NT") {
+    Write-Host "Skipped: POSIX shared memory only"
+    return
+  }
+
+  $TopDir = ".\artifacts\test_top"
+  Reset-Directory $TopDir
+
+  # A paced render stays live for the length of the input; top has to find it publishing.
+  # Telemetry is opt-in, so the render inherits TWOC_TELEMETRY=1.
+  $RenderArgs = @("render", "--plugin", $Plugin, "--in", $Dry, "--outdir", $TopDir, "--sr", $Sr, "--bs", $Bs, "--ch", $Ch, "--warmup", $Warmup, "--paced")
+  $env:TWOC_TELEMETRY = "1"
+  try {
+    $Render = Start-Process -FilePath $Harness -ArgumentList $RenderArgs -PassThru -NoNewWindow
+  }
+  finally {
+    Remove-Item Env:\TWOC_TELEMETRY -ErrorAction SilentlyContinue
+  }
+  $null = $Render.Handle  # keeps ExitCode readable after the process exits
+
+  $TopCsv = Join-Path $TopDir "top.csv"
+  $LiveRow = $null
+  try {
+    for ($attempt = 0; $attempt -lt 50 -and $null -eq $LiveRow -and -not $Render.HasExited; $attempt++) {
+      Start-Sleep -Milliseconds 100
+      & $Harness top --count 1 --sort id --csv $TopCsv | Out-Null
+      if ($LASTEXITCODE -eq 0 -and (Test-Path $TopCsv)) {
+        $LiveRow = Import-Csv $TopCsv | Where-Object { [int]$_.pid -eq $Render.Id -and [int64]$_.blocks -gt 0 } | Select-Object -First 1
+      }
+    }
+  }
+  finally {
+    $Render.WaitForExit()
+  }
+  if ($Render.ExitCode -ne 0) {
+    throw "Harness paced render failed (exit code $($Render.ExitCode))"
+  }
+  if ($null -eq $LiveRow) {
+    throw "top never showed the live render (pid $($Render.Id)) with blocks processed"
+  }
+  Write-Host "top saw pid $($LiveRow.pid) at $($LiveRow.blocks) blocks, $($LiveRow.cpu_us) us per block"
+  if ($IsLinux -and (Test-Path "/dev/shm/twoc_telemetry")) {
+    throw "Telemetry segment still linked after the last instance exited"
+  }
+  Write-Host ""
+}
+
 Write-Host ""
 Write-Host "=== Metrics Summary ==="
 $results | Format-Table -AutoSize
@@ -4,12 +4,28 @@
 #include <juce_core/juce_core.h>
 #include <juce_events/juce_events.h>
 
+#include "Diagnostics/HostCallTraceFormat.h"
+#include "Diagnostics/TelemetryFormat.h"
+
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <numeric>
 #include <optional>
 #include <vector>
 
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <unistd.h>
+ #define TWOC_HARNESS_TELEMETRY 1
+#else
+ #define TWOC_HARNESS_TELEMETRY 0
+#endif
+
 namespace
 {
 struct ParsedOptions
@@ -45,14 +61,38 @@ struct ParameterOverride
     float normalised = 0.0f;
 };
 
+struct ParameterToggle
+{
+    int index = -1;
+    std::vector<float> values;
+};
+
+struct BlockTimingStats
+{
+    int blocks = 0;
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+    int worstBlock = -1;
+    int overDeadline = 0;
+};
+
 void printUsage()
 {
     std::cout
         << "vst3_harness commands:\n"
         << "  --help\n"
         << "  dump-params --plugin <path/to/plugin.vst3>\n"
-        << "  render --plugin <plugin.vst3> --in <dry.wav> --outdir <dir> --sr <sampleRate> --bs <blockSize> --ch <channels> [--warmup <blocks>] [--set-params \"index=value,...\"]\n"
-        << "  analyze --dry <dry.wav> --wet <wet.wav> --outdir <dir> [--auto-align] [--null]\n";
+        << "  render --plugin <plugin.vst3> --in <dry.wav> --outdir <dir> --sr <sampleRate> --bs <blockSize> --ch <channels> [--warmup <blocks>] [--set-params \"index=value,...\"] [--realtime] [--load-scale <factor>] [--paced] [--meter]\n"
+        << "  analyze --dry <dry.wav> --wet <wet.wav> --outdir <dir> [--auto-align | --lag <samples>] [--null]\n"
+        << "  bench --plugin <plugin.vst3> --sr <sampleRate> --bs <blockSize> --ch <channels> [--in <dry.wav>] [--seconds <s>] [--set-params \"index=value,...\"] [--toggle \"index=v1/v2/...,...\"] [--toggle-every <blocks>] [--offline] [--csv <file>]\n"
+        << "  prepare-bench --plugin <plugin.vst3> --sr <sampleRate> --bs <blockSize> --ch <channels> [--instances <n>] [--alt-sr <sampleRate>] [--alt-bs <blockSize>] [--set-params \"index=value,...\"] [--offline]\n"
+        << "  state-bench --plugin <plugin.vst3> [--iterations <n>] [--set-params \"index=value,...\"]\n"
+        << "  preset-check --plugin <plugin.vst3> --sr <sampleRate> --bs <blockSize> --ch <channels> --slot-a \"index=value,...\" --slot-b \"index=value,...\" [--set-params \"index=value,...\"]\n"
+        << "  link-check --plugin <plugin.vst3> --sr <sampleRate> --bs <blockSize> --ch <channels> [--set-params \"index=value,...\"]\n"
+        << "  replay --plugin <plugin.vst3> --trace <file> [--in <dry.wav>] [--csv <file>]\n"
+        << "  top [--count <refreshes>] [--interval <ms>] [--sort cpu|gr|id] [--csv <file>]\n";
 }
 
 juce::File resolvePath (const juce::String& path)
@@ -189,6 +229,146 @@ bool parseParameterOverrides (const juce::String& text, std::vector<ParameterOve
     return true;
 }
 
+bool parseParameterToggles (const juce::String& text, std::vector<ParameterToggle>& toggles, juce::String& error)
+{
+    toggles.clear();
+
+    const auto entries = juce::StringArray::fromTokens (text, ",", "\"'");
+    for (const auto& entryRaw : entries)
+    {
+        const auto entry = entryRaw.trim();
+        if (entry.isEmpty())
+            continue;
+
+        const auto eqIndex = entry.indexOfChar ('=');
+        if (eqIndex <= 0 || eqIndex >= entry.length() - 1)
+        {
+            error = "Invalid --toggle token: " + entry + " (expected index=v1/v2/...)";
+            return false;
+        }
+
+        ParameterToggle toggle;
+        const auto indexText = entry.substring (0, eqIndex).trim();
+        toggle.index = indexText.getIntValue();
+
+        if (indexText != juce::String (toggle.index) || toggle.index < 0)
+        {
+            error = "Invalid parameter index in --toggle: " + indexText;
+            return false;
+        }
+
+        for (const auto& valueText : juce::StringArray::fromTokens (entry.substring (eqIndex + 1), "/", {}))
+        {
+            const auto value = static_cast<float> (valueText.trim().getDoubleValue());
+            if (! std::isfinite (value) || value < 0.0f || value > 1.0f)
+            {
+                error = "Invalid normalised value in --toggle: " + valueText + " (expected 0..1)";
+                return false;
+            }
+
+            toggle.values.push_back (value);
+        }
+
+        if (toggle.values.size() < 2)
+        {
+            error = "--toggle needs at least two values for parameter " + indexText;
+            return false;
+        }
+
+        toggles.push_back (std::move (toggle));
+    }
+
+    return true;
+}
+
+BlockTimingStats summariseBlockTimes (const std::vector<double>& blockTimesUs, double deadlineUs)
+{
+    BlockTimingStats stats;
+    stats.blocks = static_cast<int> (blockTimesUs.size());
+
+    if (blockTimesUs.empty())
+        return stats;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < blockTimesUs.size(); ++i)
+    {
+        sum += blockTimesUs[i];
+
+        if (blockTimesUs[i] > stats.maxUs)
+        {
+            stats.maxUs = blockTimesUs[i];
+            stats.worstBlock = static_cast<int> (i);
+        }
+
+        if (deadlineUs > 0.0 && blockTimesUs[i] > deadlineUs)
+            ++stats.overDeadline;
+    }
+
+    auto sorted = blockTimesUs;
+    std::sort (sorted.begin(), sorted.end());
+
+    const auto percentile = [&sorted] (double p)
+    {
+        const auto index = static_cast<size_t> (std::ceil (p * static_cast<double> (sorted.size()))) - 1;
+        return sorted[juce::jmin (sorted.size() - 1, index)];
+    };
+
+    stats.meanUs = sum / static_cast<double> (blockTimesUs.size());
+    stats.p50Us = percentile (0.50);
+    stats.p99Us = percentile (0.99);
+    return stats;
+}
+
+void printBlockTimingStats (const BlockTimingStats& stats, double deadlineUs)
+{
+    std::cout << "blocks        : " << stats.blocks << "\n"
+              << "deadline_us   : " << juce::String (deadlineUs, 2) << "\n"
+              << "mean_us       : " << juce::String (stats.meanUs, 2) << "\n"
+              << "p50_us        : " << juce::String (stats.p50Us, 2) << "\n"
+              << "p99_us        : " << juce::String (stats.p99Us, 2) << "\n"
+              << "max_us        : " << juce::String (stats.maxUs, 2) << " (block " << stats.worstBlock << ")\n"
+              << "over_deadline : " << stats.overDeadline << std::endl;
+}
+
+bool writeBlockTimesCsv (const juce::File& file, const std::vector<double>& blockTimesUs, juce::String& error)
+{
+    juce::String text ("block,time_us\n");
+    text.preallocateBytes (blockTimesUs.size() * 16);
+
+    for (size_t i = 0; i < blockTimesUs.size(); ++i)
+        text << juce::String (static_cast<int> (i)) << "," << juce::String (blockTimesUs[i], 3) << "\n";
+
+    if (! file.replaceWithText (text))
+    {
+        error = "Failed to write CSV: " + file.getFullPathName();
+        return false;
+    }
+
+    return true;
+}
+
+void fillBenchNoise (juce::AudioBuffer<float>& buffer)
+{
+    juce::Random random (0x2c);
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        auto* data = buffer.getWritePointer (ch);
+        auto lowpassed = 0.0f;
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            lowpassed = 0.9f * lowpassed + 0.1f * (random.nextFloat() * 2.0f - 1.0f);
+            data[i] = lowpassed;
+        }
+    }
+}
+
+double ticksToMicroseconds (juce::int64 ticks)
+{
+    return juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e6;
+}
+
 bool loadWaveFile (const juce::File& file, LoadedWave& loaded, juce::String& error)
 {
     if (! file.existsAsFile())
@@ -518,6 +698,110 @@ bool writeMetricsJson (const juce::File& outputFile,
     return true;
 }
 
+// Plugins built with TWOC_TEST_HOOKS export twoCCompressorReadProbe and the other hooks
+// below; release builds export none of them. The module is already loaded by the host
+// code, so opening it again hands back the same image and the same instances.
+juce::File findPluginBinary (const juce::File& pluginPath)
+{
+    if (pluginPath.existsAsFile())
+        return pluginPath;
+
+    const auto name = pluginPath.getFileNameWithoutExtension();
+    const auto contents = pluginPath.getChildFile ("Contents");
+
+    for (const auto& candidate : contents.findChildFiles (juce::File::findFiles, true, name + "*"))
+    {
+        if (candidate.getParentDirectory().getFileName() != "Resources")
+            return candidate;
+    }
+
+    return {};
+}
+
+std::optional<juce::var> readPluginProbe (const juce::File& pluginPath)
+{
+    using ProbeFunction = int (*) (char*, int);
+
+    const auto binary = findPluginBinary (pluginPath);
+    juce::DynamicLibrary library;
+
+    if (binary == juce::File() || ! library.open (binary.getFullPathName()))
+        return std::nullopt;
+
+    const auto probe = reinterpret_cast<ProbeFunction> (library.getFunction ("twoCCompressorReadProbe"));
+    if (probe == nullptr)
+        return std::nullopt;
+
+    const auto length = probe (nullptr, 0);
+    if (length < 0)
+        return std::nullopt;
+
+    juce::HeapBlock<char> text (static_cast<size_t> (length) + 1, true);
+    probe (text.get(), length + 1);
+
+    return juce::JSON::parse (juce::String::fromUTF8 (text.get(), length));
+}
+
+// Stores the newest instance's controls in an A/B slot through the exported test hook.
+bool storePluginPresetSlot (const juce::File& pluginPath, int slot)
+{
+    using StoreFunction = int (*) (int);
+
+    const auto binary = findPluginBinary (pluginPath);
+    juce::DynamicLibrary library;
+
+    if (binary == juce::File() || ! library.open (binary.getFullPathName()))
+        return false;
+
+    const auto store = reinterpret_cast<StoreFunction> (library.getFunction ("twoCCompressorStorePresetSlot"));
+    return store != nullptr && store (slot) == 0;
+}
+
+// Gives the newest instance a meter consumer (or takes it away), standing in for an editor.
+bool attachPluginMeterConsumer (const juce::File& pluginPath, bool attach)
+{
+    using AttachFunction = int (*) (int);
+
+    const auto binary = findPluginBinary (pluginPath);
+    juce::DynamicLibrary library;
+
+    if (binary == juce::File() || ! library.open (binary.getFullPathName()))
+        return false;
+
+    const auto attachConsumer = reinterpret_cast<AttachFunction> (library.getFunction ("twoCCompressorAttachMeterConsumer"));
+    return attachConsumer != nullptr && attachConsumer (attach ? 1 : 0) == 0;
+}
+
+// Joins the newest instance to a link group, or leaves with an empty name.
+bool setPluginLinkGroup (const juce::File& pluginPath, const juce::String& groupName)
+{
+    using GroupFunction = int (*) (const char*);
+
+    const auto binary = findPluginBinary (pluginPath);
+    juce::DynamicLibrary library;
+
+    if (binary == juce::File() || ! library.open (binary.getFullPathName()))
+        return false;
+
+    const auto setGroup = reinterpret_cast<GroupFunction> (library.getFunction ("twoCCompressorSetLinkGroup"));
+    return setGroup != nullptr && setGroup (groupName.toRawUTF8()) == 0;
+}
+
+// Makes the newest instance's eco governor see each block as taking scale times longer.
+bool setPluginEcoLoadScale (const juce::File& pluginPath, double scale)
+{
+    using ScaleFunction = int (*) (double);
+
+    const auto binary = findPluginBinary (pluginPath);
+    juce::DynamicLibrary library;
+
+    if (binary == juce::File() || ! library.open (binary.getFullPathName()))
+        return false;
+
+    const auto setScale = reinterpret_cast<ScaleFunction> (library.getFunction ("twoCCompressorSetEcoLoadScale"));
+    return setScale != nullptr && setScale (scale) == 0;
+}
+
 int runDumpParams (const ParsedOptions& options)
 {
     juce::String error;
@@ -566,6 +850,7 @@ int runRender (const ParsedOptions& options)
     int blockSize = 0;
     int channels = 0;
     int warmupBlocks = 0;
+    double loadScale = 1.0;
     std::vector<ParameterOverride> parameterOverrides;
 
     if (! parseFileOption (options, "--plugin", pluginFile, error)
@@ -604,6 +889,17 @@ int runRender (const ParsedOptions& options)
         return 1;
     }
 
+    // Makes the plugin see each block as taking loadScale times longer than it did, as on a
+    // slower machine. Only eco mode looks at block times, and only in realtime renders.
+    if (options.getValue ("--load-scale").has_value())
+    {
+        if (! parseDoubleOption (options, "--load-scale", loadScale, error) || loadScale < 1.0)
+        {
+            std::cerr << (error.isNotEmpty() ? error : juce::String ("--load-scale must be at least 1.")) << std::endl;
+            return 1;
+        }
+    }
+
     LoadedWave dryWave;
     if (! loadWaveFile (inputFile, dryWave, error))
     {
@@ -630,6 +926,23 @@ int runRender (const ParsedOptions& options)
 
     configurePlugin (*plugin, channels, sampleRate, blockSize);
 
+    if (options.hasFlag ("--realtime"))
+        plugin->setNonRealtime (false);
+
+    // Meters (loudness included) only run for a consumer; this stands in for an editor so
+    // probe.json carries the readings.
+    if (options.hasFlag ("--meter") && ! attachPluginMeterConsumer (pluginFile, true))
+    {
+        std::cerr << "Plugin does not export twoCCompressorAttachMeterConsumer (build it with TWOC_TEST_HOOKS)." << std::endl;
+        return 1;
+    }
+
+    if (loadScale > 1.0 && ! setPluginEcoLoadScale (pluginFile, loadScale))
+    {
+        std::cerr << "Plugin does not export twoCCompressorSetEcoLoadScale (build it with TWOC_TEST_HOOKS)." << std::endl;
+        return 1;
+    }
+
     if (! applyParameterOverrides (*plugin, parameterOverrides, error))
     {
         std::cerr << error << std::endl;
@@ -647,6 +960,11 @@ int runRender (const ParsedOptions& options)
         midiBuffer.clear();
     }
 
+    // Paced, blocks go out no faster than a device would ask for them, so the render stays
+    // live for the length of the input (for watching it with `top`).
+    const auto paced = options.hasFlag ("--paced");
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
     for (int pos = 0; pos < dryBuffer.getNumSamples(); pos += blockSize)
     {
         const auto numThisBlock = juce::jmin (blockSize, dryBuffer.getNumSamples() - pos);
@@ -663,8 +981,21 @@ int runRender (const ParsedOptions& options)
 
         for (int ch = 0; ch < channels; ++ch)
             wetBuffer.copyFrom (ch, pos, ioBuffer, ch, 0, numThisBlock);
+
+        if (paced)
+        {
+            const auto dueMs = startMs + 1000.0 * static_cast<double> (pos + numThisBlock) / sampleRate;
+            const auto waitMs = static_cast<int> (dueMs - juce::Time::getMillisecondCounterHiRes());
+
+            if (waitMs > 0)
+                juce::Thread::sleep (waitMs);
+        }
     }
 
+    // The plugin's own counters as they stood after the last block, for the tests to read.
+    if (const auto probe = readPluginProbe (pluginFile); probe.has_value())
+        outputDir.getChildFile ("probe.json").replaceWithText (juce::JSON::toString (*probe));
+
     plugin->releaseResources();
 
     const auto wetFile = outputDir.getChildFile ("wet.wav");
@@ -696,6 +1027,25 @@ int runAnalyze (const ParsedOptions& options)
     const auto autoAlign = options.hasFlag ("--auto-align");
     const auto nullRequested = options.hasFlag ("--null");
 
+    // A fixed lag checks the plugin against what it reports, where --auto-align would
+    // find whatever lag nulls best.
+    auto lagSamples = 0;
+
+    if (options.getValue ("--lag").has_value())
+    {
+        if (autoAlign)
+        {
+            std::cerr << "--lag and --auto-align are exclusive." << std::endl;
+            return 1;
+        }
+
+        if (! parseIntOption (options, "--lag", lagSamples, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
     LoadedWave dryWave;
     LoadedWave wetWave;
     if (! loadWaveFile (dryFile, dryWave, error) || ! loadWaveFile (wetFile, wetWave, error))
@@ -717,7 +1067,6 @@ int runAnalyze (const ParsedOptions& options)
         return 1;
     }
 
-    auto lagSamples = 0;
     if (autoAlign)
     {
         const auto dryMono = makeMonoSignal (dryWave.buffer, channels);
@@ -803,40 +1152,1597 @@ int runAnalyze (const ParsedOptions& options)
 
     return 0;
 }
-} // namespace
 
-int main (int argc, char* argv[])
+void printGainStageTraffic (const juce::var& probe)
 {
-    juce::ScopedJuceInitialiser_GUI juceInit;
+    const auto fused = static_cast<juce::int64> (probe.getProperty ("gain_stage_bytes_per_block", 0));
+    const auto legacy = static_cast<juce::int64> (probe.getProperty ("legacy_gain_stage_bytes_per_block_estimate", 0));
+    const auto saving = legacy > 0 ? 100.0 * static_cast<double> (legacy - fused) / static_cast<double> (legacy) : 0.0;
 
-    juce::StringArray args;
-    for (int i = 1; i < argc; ++i)
-        args.add (juce::String::fromUTF8 (argv[i]));
+    std::cout << "gain/mix memory traffic per block: " << fused << " bytes fused, "
+              << legacy << " bytes estimated for separate passes ("
+              << juce::String (saving, 1) << "% less)" << std::endl;
+}
 
-    if (args.isEmpty() || args[0] == "--help" || args[0] == "-h")
+void printLoudness (const juce::var& probe)
+{
+    if (! probe.hasProperty ("loudness_in_integrated_lufs"))
+        return;
+
+    if (static_cast<juce::int64> (probe.getProperty ("metered_blocks", 0)) == 0)
     {
-        printUsage();
-        return 0;
+        std::cout << "loudness: not measured (no meter consumer; render --meter keeps one)" << std::endl;
+        return;
     }
 
-    const auto command = args[0];
-    const auto options = parseOptions (args, 1);
+    const auto format = [&probe] (const char* property)
+    {
+        return juce::String (static_cast<double> (probe.getProperty (property, -100.0)), 1).paddedLeft (' ', 7);
+    };
+
+    std::cout << "loudness (LUFS)  momentary short-term integrated\n"
+              << "  input        " << format ("loudness_in_momentary_lufs") << "    " << format ("loudness_in_short_term_lufs")
+              << "    " << format ("loudness_in_integrated_lufs") << "\n"
+              << "  output       " << format ("loudness_out_momentary_lufs") << "    " << format ("loudness_out_short_term_lufs")
+              << "    " << format ("loudness_out_integrated_lufs") << std::endl;
+}
 
-    if (options.error.isNotEmpty())
+// Present only in plugins built with TWOC_STAGE_PROFILER. Values are nanoseconds per
+// sample, per block, since the plugin was last prepared; the plugin converts them from the
+// counter it times with, whose rate is printed alongside.
+void printStageProfile (const juce::var& probe)
+{
+    const auto stages = probe.getProperty ("stage_profile", {});
+
+    if (stages.getDynamicObject() == nullptr)
+        return;
+
+    std::cout << "stage profile (ns/sample, counter at "
+              << juce::String (static_cast<double> (probe.getProperty ("stage_profile_counter_hz", 0.0)) / 1.0e6, 1)
+              << " MHz): blocks, min, mean, p99, max" << std::endl;
+
+    for (const auto& stage : stages.getDynamicObject()->getProperties())
     {
-        std::cerr << options.error << std::endl;
-        printUsage();
+        const auto blocks = static_cast<juce::int64> (stage.value.getProperty ("blocks", 0));
+
+        if (blocks == 0)
+            continue;
+
+        std::cout << "  " << stage.name.toString().paddedRight (' ', 12)
+                  << " " << blocks
+                  << ", " << juce::String (static_cast<double> (stage.value.getProperty ("min", 0.0)), 1)
+                  << ", " << juce::String (static_cast<double> (stage.value.getProperty ("mean", 0.0)), 1)
+                  << ", " << juce::String (static_cast<double> (stage.value.getProperty ("p99", 0.0)), 1)
+                  << ", " << juce::String (static_cast<double> (stage.value.getProperty ("max", 0.0)), 1) << std::endl;
+    }
+}
+
+int runBench (const ParsedOptions& options)
+{
+    juce::String error;
+    juce::File pluginFile;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int channels = 0;
+    double seconds = 10.0;
+    int toggleEvery = 8;
+    std::vector<ParameterOverride> parameterOverrides;
+    std::vector<ParameterToggle> parameterToggles;
+
+    if (! parseFileOption (options, "--plugin", pluginFile, error)
+        || ! parseDoubleOption (options, "--sr", sampleRate, error)
+        || ! parseIntOption (options, "--bs", blockSize, error)
+        || ! parseIntOption (options, "--ch", channels, error))
+    {
+        std::cerr << error << std::endl;
         return 1;
     }
 
-    if (command == "dump-params")
-        return runDumpParams (options);
+    if (options.getValue ("--seconds").has_value() && ! parseDoubleOption (options, "--seconds", seconds, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
 
-    if (command == "render")
-        return runRender (options);
+    if (options.getValue ("--toggle-every").has_value() && ! parseIntOption (options, "--toggle-every", toggleEvery, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
 
-    if (command == "analyze")
-        return runAnalyze (options);
+    if (const auto overridesText = options.getValue ("--set-params"); overridesText.has_value())
+    {
+        if (! parseParameterOverrides (*overridesText, parameterOverrides, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (const auto togglesText = options.getValue ("--toggle"); togglesText.has_value())
+    {
+        if (! parseParameterToggles (*togglesText, parameterToggles, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (blockSize <= 0 || channels <= 0 || toggleEvery <= 0)
+    {
+        std::cerr << "Block size, channels and --toggle-every must be positive." << std::endl;
+        return 1;
+    }
+
+    juce::AudioBuffer<float> sourceBuffer;
+
+    if (options.getValue ("--in").has_value())
+    {
+        juce::File inputFile;
+        LoadedWave dryWave;
+
+        if (! parseFileOption (options, "--in", inputFile, error) || ! loadWaveFile (inputFile, dryWave, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+
+        sourceBuffer.setSize (channels, dryWave.buffer.getNumSamples());
+        copyWithChannelMatch (dryWave.buffer, sourceBuffer);
+    }
+    else
+    {
+        sourceBuffer.setSize (channels, juce::jmax (blockSize, static_cast<int> (seconds * sampleRate)));
+        fillBenchNoise (sourceBuffer);
+    }
+
+    const auto description = findPluginDescription (pluginFile, error);
+    if (! description.has_value())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    auto plugin = createPluginInstance (*description, sampleRate, blockSize, error);
+    if (plugin == nullptr)
+    {
+        std::cerr << "Failed to instantiate plugin: " << error << std::endl;
+        return 1;
+    }
+
+    configurePlugin (*plugin, channels, sampleRate, blockSize);
+    plugin->setNonRealtime (options.hasFlag ("--offline"));
+
+    if (! applyParameterOverrides (*plugin, parameterOverrides, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const auto parameters = plugin->getParameters();
+    for (const auto& toggle : parameterToggles)
+    {
+        if (! juce::isPositiveAndBelow (toggle.index, parameters.size()))
+        {
+            std::cerr << "Parameter index out of range: " << toggle.index << std::endl;
+            return 1;
+        }
+    }
+
+    juce::AudioBuffer<float> ioBuffer (channels, blockSize);
+    juce::MidiBuffer midiBuffer;
+    std::vector<double> blockTimesUs;
+    blockTimesUs.reserve (static_cast<size_t> (sourceBuffer.getNumSamples() / blockSize + 1));
+
+    auto blockIndex = 0;
+    for (int pos = 0; pos + blockSize <= sourceBuffer.getNumSamples(); pos += blockSize, ++blockIndex)
+    {
+        if (blockIndex > 0 && blockIndex % toggleEvery == 0)
+        {
+            const auto step = static_cast<size_t> (blockIndex / toggleEvery);
+
+            for (const auto& toggle : parameterToggles)
+                parameters[toggle.index]->setValueNotifyingHost (toggle.values[step % toggle.values.size()]);
+        }
+
+        for (int ch = 0; ch < channels; ++ch)
+            ioBuffer.copyFrom (ch, 0, sourceBuffer, ch, pos, blockSize);
+
+        midiBuffer.clear();
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        plugin->processBlock (ioBuffer, midiBuffer);
+        const auto endTicks = juce::Time::getHighResolutionTicks();
+
+        blockTimesUs.push_back (ticksToMicroseconds (endTicks - startTicks));
+    }
+
+    const auto probe = readPluginProbe (pluginFile);
+    plugin->releaseResources();
+
+    const auto deadlineUs = 1.0e6 * static_cast<double> (blockSize) / sampleRate;
+    printBlockTimingStats (summariseBlockTimes (blockTimesUs, deadlineUs), deadlineUs);
+
+    if (probe.has_value())
+    {
+        printGainStageTraffic (*probe);
+        printLoudness (*probe);
+        printStageProfile (*probe);
+    }
+
+    if (const auto csvPath = options.getValue ("--csv"); csvPath.has_value())
+    {
+        if (! writeBlockTimesCsv (resolvePath (*csvPath), blockTimesUs, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// readyUs, when given, runs from the first prepare until every oversampler is built.
+void printTimingPhase (const juce::String& phase, const std::vector<double>& prepareTimesUs, double readyUs = -1.0)
+{
+    auto totalUs = 0.0;
+    auto maxUs = 0.0;
+
+    for (const auto timeUs : prepareTimesUs)
+    {
+        totalUs += timeUs;
+        maxUs = juce::jmax (maxUs, timeUs);
+    }
+
+    const auto meanUs = prepareTimesUs.empty() ? 0.0 : totalUs / static_cast<double> (prepareTimesUs.size());
+
+    std::cout << phase.paddedRight (' ', 16)
+              << " total_ms " << juce::String (totalUs / 1000.0, 2).paddedLeft (' ', 10)
+              << "  mean_us " << juce::String (meanUs, 1).paddedLeft (' ', 10)
+              << "  max_us " << juce::String (maxUs, 1).paddedLeft (' ', 10);
+
+    if (readyUs >= 0.0)
+        std::cout << "  ready_ms " << juce::String (readyUs / 1000.0, 2).paddedLeft (' ', 10);
+
+    std::cout << std::endl;
+}
+
+// Polls the probe until no instance is waiting for an oversampler. False on timeout, or
+// when the plugin has no probe to ask.
+bool waitForOversamplerBuilds (const juce::File& pluginFile, int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32> (timeoutMs);
+
+    for (;;)
+    {
+        const auto probe = readPluginProbe (pluginFile);
+        if (! probe.has_value())
+            return false;
+
+        if (static_cast<int> (probe->getProperty ("os_builds_pending", 0)) == 0)
+            return true;
+
+        if (juce::Time::getMillisecondCounter() > deadline)
+            return false;
+
+        juce::Thread::sleep (1);
+    }
+}
+
+int runPrepareBench (const ParsedOptions& options)
+{
+    juce::String error;
+    juce::File pluginFile;
+    double sampleRate = 0.0;
+    double altSampleRate = 44100.0;
+    int blockSize = 0;
+    int altBlockSize = 1024;
+    int channels = 0;
+    int instances = 100;
+    std::vector<ParameterOverride> parameterOverrides;
+
+    if (! parseFileOption (options, "--plugin", pluginFile, error)
+        || ! parseDoubleOption (options, "--sr", sampleRate, error)
+        || ! parseIntOption (options, "--bs", blockSize, error)
+        || ! parseIntOption (options, "--ch", channels, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    if ((options.getValue ("--instances").has_value() && ! parseIntOption (options, "--instances", instances, error))
+        || (options.getValue ("--alt-sr").has_value() && ! parseDoubleOption (options, "--alt-sr", altSampleRate, error))
+        || (options.getValue ("--alt-bs").has_value() && ! parseIntOption (options, "--alt-bs", altBlockSize, error)))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    if (const auto overridesText = options.getValue ("--set-params"); overridesText.has_value())
+    {
+        if (! parseParameterOverrides (*overridesText, parameterOverrides, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (instances <= 0 || blockSize <= 0 || altBlockSize <= 0 || channels <= 0)
+    {
+        std::cerr << "Instances, block sizes and channels must be positive." << std::endl;
+        return 1;
+    }
+
+    const auto description = findPluginDescription (pluginFile, error);
+    if (! description.has_value())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<juce::AudioPluginInstance>> plugins;
+    plugins.reserve (static_cast<size_t> (instances));
+
+    for (int i = 0; i < instances; ++i)
+    {
+        auto plugin = createPluginInstance (*description, sampleRate, blockSize, error);
+        if (plugin == nullptr)
+        {
+            std::cerr << "Failed to instantiate plugin " << i << ": " << error << std::endl;
+            return 1;
+        }
+
+        auto layout = plugin->getBusesLayout();
+        const auto channelSet = channels == 1 ? juce::AudioChannelSet::mono()
+                                              : juce::AudioChannelSet::discreteChannels (channels);
+
+        if (layout.inputBuses.size() > 0)
+            layout.inputBuses.set (0, channelSet);
+
+        if (layout.outputBuses.size() > 0)
+            layout.outputBuses.set (0, channelSet);
+
+        plugin->setBusesLayout (layout);
+        plugin->setNonRealtime (options.hasFlag ("--offline"));
+
+        if (! applyParameterOverrides (*plugin, parameterOverrides, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+
+        plugins.push_back (std::move (plugin));
+    }
+
+    const auto timePreparePhase = [&plugins, &pluginFile, channels] (const juce::String& phase, double phaseSampleRate, int phaseBlockSize)
+    {
+        std::vector<double> prepareTimesUs;
+        prepareTimesUs.reserve (plugins.size());
+        const auto phaseStartTicks = juce::Time::getHighResolutionTicks();
+
+        for (auto& plugin : plugins)
+        {
+            plugin->setPlayConfigDetails (channels, channels, phaseSampleRate, phaseBlockSize);
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            plugin->prepareToPlay (phaseSampleRate, phaseBlockSize);
+            const auto endTicks = juce::Time::getHighResolutionTicks();
+
+            prepareTimesUs.push_back (ticksToMicroseconds (endTicks - startTicks));
+        }
+
+        // A prepare that returns before the oversampler exists only moves the cost.
+        if (! waitForOversamplerBuilds (pluginFile, 10000))
+            std::cerr << "warning: oversampler readiness not confirmed after " << phase << std::endl;
+
+        printTimingPhase (phase, prepareTimesUs, ticksToMicroseconds (juce::Time::getHighResolutionTicks() - phaseStartTicks));
+    };
+
+    std::cout << "instances: " << instances << std::endl;
+    timePreparePhase ("initial", sampleRate, blockSize);
+    timePreparePhase ("repeat", sampleRate, blockSize);
+    timePreparePhase ("sample-rate", altSampleRate, blockSize);
+    timePreparePhase ("block-size", altSampleRate, altBlockSize);
+
+    for (auto& plugin : plugins)
+        plugin->releaseResources();
+
+    return 0;
+}
+
+int runStateBench (const ParsedOptions& options)
+{
+    juce::String error;
+    juce::File pluginFile;
+    int iterations = 10000;
+    std::vector<ParameterOverride> parameterOverrides;
+
+    if (! parseFileOption (options, "--plugin", pluginFile, error)
+        || (options.getValue ("--iterations").has_value() && ! parseIntOption (options, "--iterations", iterations, error)))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    if (const auto overridesText = options.getValue ("--set-params"); overridesText.has_value())
+    {
+        if (! parseParameterOverrides (*overridesText, parameterOverrides, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (iterations <= 0)
+    {
+        std::cerr << "Iterations must be positive." << std::endl;
+        return 1;
+    }
+
+    const auto description = findPluginDescription (pluginFile, error);
+    if (! description.has_value())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    auto source = createPluginInstance (*description, 48000.0, 256, error);
+    auto destination = source != nullptr ? createPluginInstance (*description, 48000.0, 256, error) : nullptr;
+
+    if (source == nullptr || destination == nullptr)
+    {
+        std::cerr << "Failed to instantiate plugin: " << error << std::endl;
+        return 1;
+    }
+
+    if (! applyParameterOverrides (*source, parameterOverrides, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    // Hosts save and restore through the same block over and over (autosave, undo).
+    juce::MemoryBlock state;
+    std::vector<double> saveTimesUs;
+    std::vector<double> loadTimesUs;
+    saveTimesUs.reserve (static_cast<size_t> (iterations));
+    loadTimesUs.reserve (static_cast<size_t> (iterations));
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        source->getStateInformation (state);
+        saveTimesUs.push_back (ticksToMicroseconds (juce::Time::getHighResolutionTicks() - startTicks));
+    }
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        destination->setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+        loadTimesUs.push_back (ticksToMicroseconds (juce::Time::getHighResolutionTicks() - startTicks));
+    }
+
+    std::cout << "state_bytes: " << state.getSize() << std::endl;
+    printTimingPhase ("save", saveTimesUs);
+    printTimingPhase ("load", loadTimesUs);
+
+    // The restored instance must match the one that saved, parameter for parameter.
+    const auto sourceParameters = source->getParameters();
+    const auto destinationParameters = destination->getParameters();
+    auto mismatches = 0;
+
+    for (int i = 0; i < juce::jmin (sourceParameters.size(), destinationParameters.size()); ++i)
+    {
+        const auto expected = sourceParameters[i]->getValue();
+        const auto actual = destinationParameters[i]->getValue();
+
+        if (std::abs (expected - actual) > 1.0e-5f)
+        {
+            std::cerr << "Round-trip mismatch on " << sourceParameters[i]->getName (128)
+                      << ": saved " << expected << ", restored " << actual << std::endl;
+            ++mismatches;
+        }
+    }
+
+    std::cout << "round_trip_mismatches: " << mismatches << std::endl;
+
+    // Binary states claiming a later format version, or whose link group runs past the end,
+    // must be refused outright: a fresh instance that loads one keeps its defaults.
+    auto futureVersionAccepted = false;
+    auto truncatedAccepted = false;
+    const auto* stateBytes = static_cast<const char*> (state.getData());
+
+    // Whether a fresh instance took anything from the state.
+    const auto loadsIntoFreshInstance = [&] (const juce::MemoryBlock& candidate) -> std::optional<bool>
+    {
+        auto fresh = createPluginInstance (*description, 48000.0, 256, error);
+
+        if (fresh == nullptr)
+        {
+            std::cerr << "Failed to instantiate plugin: " << error << std::endl;
+            return std::nullopt;
+        }
+
+        std::vector<float> defaults;
+
+        for (auto* parameter : fresh->getParameters())
+            defaults.push_back (parameter->getValue());
+
+        fresh->setStateInformation (candidate.getData(), static_cast<int> (candidate.getSize()));
+
+        const auto freshParameters = fresh->getParameters();
+        auto changed = false;
+
+        for (int i = 0; i < freshParameters.size(); ++i)
+            changed = changed || std::abs (freshParameters[i]->getValue() - defaults[static_cast<size_t> (i)]) > 1.0e-5f;
+
+        return changed;
+    };
+
+    if (state.getSize() >= 8 && juce::ByteOrder::littleEndianInt (stateBytes) == 0x53433243)
+    {
+        // The format version is the uint16 after the magic.
+        juce::MemoryBlock futureState (state);
+        static_cast<char*> (futureState.getData())[4] = static_cast<char> (0xff);
+        static_cast<char*> (futureState.getData())[5] = static_cast<char> (0xff);
+
+        // The link group's byte count follows the header and the 8-byte entries, whose
+        // count is the uint16 after the version.
+        juce::MemoryBlock truncatedState (state);
+        const auto linkGroupOffset = 8 + 8 * static_cast<size_t> (juce::ByteOrder::littleEndianShort (stateBytes + 6));
+
+        if (linkGroupOffset + 2 > truncatedState.getSize())
+        {
+            std::cerr << "State has no link group field to truncate." << std::endl;
+            return 1;
+        }
+
+        static_cast<char*> (truncatedState.getData())[linkGroupOffset] = static_cast<char> (0xff);
+        static_cast<char*> (truncatedState.getData())[linkGroupOffset + 1] = static_cast<char> (0xff);
+
+        const auto future = loadsIntoFreshInstance (futureState);
+        const auto truncated = loadsIntoFreshInstance (truncatedState);
+
+        if (! future.has_value() || ! truncated.has_value())
+            return 1;
+
+        futureVersionAccepted = *future;
+        truncatedAccepted = *truncated;
+
+        std::cout << "future_version_rejected: " << (futureVersionAccepted ? "no" : "yes") << std::endl;
+        std::cout << "truncated_link_group_rejected: " << (truncatedAccepted ? "no" : "yes") << std::endl;
+    }
+
+    return mismatches == 0 && ! futureVersionAccepted && ! truncatedAccepted ? 0 : 1;
+}
+
+juce::AudioProcessorParameter* findParameterByName (juce::AudioPluginInstance& plugin, const juce::String& name)
+{
+    for (auto* parameter : plugin.getParameters())
+        if (parameter->getName (128) == name)
+            return parameter;
+
+    return nullptr;
+}
+
+// Stores two A/B slots, then plays a steady 1 kHz tone through three phases: the controls,
+// A/B engaged (gliding to slot A) and Morph at 1 (gliding to slot B). Every switch must
+// glide: no block may move the level by more than a fraction of the whole change, which a
+// switch made in one block ramp would. Then the state must carry both slots to a new instance.
+int runPresetCheck (const ParsedOptions& options)
+{
+    juce::String error;
+    juce::File pluginFile;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int channels = 0;
+    std::array<std::vector<ParameterOverride>, 2> slotOverrides;
+    std::vector<ParameterOverride> parameterOverrides;
+
+    if (! parseFileOption (options, "--plugin", pluginFile, error)
+        || ! parseDoubleOption (options, "--sr", sampleRate, error)
+        || ! parseIntOption (options, "--bs", blockSize, error)
+        || ! parseIntOption (options, "--ch", channels, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const std::array<const char*, 2> slotOptions { "--slot-a", "--slot-b" };
+
+    for (size_t slot = 0; slot < slotOptions.size(); ++slot)
+    {
+        const auto text = options.getValue (slotOptions[slot]);
+
+        if (! text.has_value())
+        {
+            std::cerr << "Missing required option: " << slotOptions[slot] << std::endl;
+            return 1;
+        }
+
+        if (! parseParameterOverrides (*text, slotOverrides[slot], error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (const auto overridesText = options.getValue ("--set-params"); overridesText.has_value())
+    {
+        if (! parseParameterOverrides (*overridesText, parameterOverrides, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (blockSize <= 0 || channels <= 0)
+    {
+        std::cerr << "Block size and channels must be positive." << std::endl;
+        return 1;
+    }
+
+    const auto description = findPluginDescription (pluginFile, error);
+    if (! description.has_value())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    auto plugin = createPluginInstance (*description, sampleRate, blockSize, error);
+    if (plugin == nullptr)
+    {
+        std::cerr << "Failed to instantiate plugin: " << error << std::endl;
+        return 1;
+    }
+
+    configurePlugin (*plugin, channels, sampleRate, blockSize);
+
+    auto* compareParameter = findParameterByName (*plugin, "A/B");
+    auto* morphParameter = findParameterByName (*plugin, "Morph");
+
+    if (compareParameter == nullptr || morphParameter == nullptr)
+    {
+        std::cerr << "Plugin has no A/B and Morph parameters." << std::endl;
+        return 1;
+    }
+
+    juce::AudioBuffer<float> ioBuffer (channels, blockSize);
+    juce::MidiBuffer midiBuffer;
+    juce::int64 tonePosition = 0;
+    const auto toneGain = juce::Decibels::decibelsToGain (-12.0f);
+
+    // Processes one block of the tone and returns its output RMS in dB.
+    const auto processToneBlock = [&]
+    {
+        for (int sample = 0; sample < blockSize; ++sample)
+        {
+            const auto phase = juce::MathConstants<double>::twoPi * 1000.0 * static_cast<double> (tonePosition++) / sampleRate;
+
+            for (int ch = 0; ch < channels; ++ch)
+                ioBuffer.setSample (ch, sample, toneGain * static_cast<float> (std::sin (phase)));
+        }
+
+        plugin->processBlock (ioBuffer, midiBuffer);
+        midiBuffer.clear();
+        return computeRmsDb (ioBuffer, 0, blockSize, channels);
+    };
+
+    // Slots capture the controls as they stand, the way the editor's store buttons do.
+    for (size_t slot = 0; slot < slotOverrides.size(); ++slot)
+    {
+        if (! applyParameterOverrides (*plugin, slotOverrides[slot], error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+
+        processToneBlock();
+
+        if (! storePluginPresetSlot (pluginFile, static_cast<int> (slot)))
+        {
+            std::cerr << "Plugin does not export twoCCompressorStorePresetSlot (build it with TWOC_TEST_HOOKS)." << std::endl;
+            return 1;
+        }
+    }
+
+    compareParameter->setValueNotifyingHost (0.0f);
+    morphParameter->setValueNotifyingHost (0.0f);
+
+    if (! applyParameterOverrides (*plugin, parameterOverrides, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    // A second per phase is many smoothing time constants; the level has settled by its end.
+    const auto blocksPerPhase = juce::jmax (16, static_cast<int> (std::ceil (sampleRate / blockSize)));
+    constexpr float maxStepFraction = 0.4f;
+    constexpr float levelToleranceDb = 0.2f;
+    auto failures = 0;
+
+    const auto settledLevel = [] (const std::vector<float>& levels)
+    {
+        return std::accumulate (levels.end() - 5, levels.end(), 0.0f) / 5.0f;
+    };
+
+    std::vector<float> levels;
+
+    for (int block = 0; block < blocksPerPhase; ++block)
+        levels.push_back (processToneBlock());
+
+    const std::array<std::pair<const char*, juce::AudioProcessorParameter*>, 2> switches { { { "engage A/B", compareParameter },
+                                                                                            { "morph to B", morphParameter } } };
+
+    for (const auto& [name, parameter] : switches)
+    {
+        const auto before = settledLevel (levels);
+        auto previous = levels.back();
+        auto largestStep = 0.0f;
+
+        parameter->setValueNotifyingHost (1.0f);
+        levels.clear();
+
+        for (int block = 0; block < blocksPerPhase; ++block)
+        {
+            levels.push_back (processToneBlock());
+            largestStep = juce::jmax (largestStep, std::abs (levels.back() - previous));
+            previous = levels.back();
+        }
+
+        const auto change = std::abs (settledLevel (levels) - before);
+        std::cout << name << ": " << juce::String (change, 2) << " dB change, largest block step "
+                  << juce::String (largestStep, 2) << " dB" << std::endl;
+
+        if (change < 1.0f)
+        {
+            std::cerr << name << ": the slots should differ by more than 1 dB of level" << std::endl;
+            ++failures;
+        }
+        else if (largestStep > maxStepFraction * change + levelToleranceDb)
+        {
+            std::cerr << name << ": level stepped instead of gliding" << std::endl;
+            ++failures;
+        }
+    }
+
+    // Both slots must come back from the saved state.
+    juce::MemoryBlock state;
+    plugin->getStateInformation (state);
+    const auto savedProbe = readPluginProbe (pluginFile);
+
+    auto restored = createPluginInstance (*description, sampleRate, blockSize, error);
+    if (restored == nullptr)
+    {
+        std::cerr << "Failed to instantiate plugin: " << error << std::endl;
+        return 1;
+    }
+
+    restored->setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+    const auto restoredProbe = readPluginProbe (pluginFile);
+
+    if (! savedProbe.has_value() || ! restoredProbe.has_value())
+    {
+        std::cerr << "Plugin has no probe to read the slots through." << std::endl;
+        return 1;
+    }
+
+    const auto* savedSlots = savedProbe->getProperty ("preset_slots", {}).getArray();
+    const auto* restoredSlots = restoredProbe->getProperty ("preset_slots", {}).getArray();
+    auto slotMismatches = 0;
+
+    for (int slot = 0; slot < 2; ++slot)
+    {
+        const auto* saved = savedSlots != nullptr ? (*savedSlots)[slot].getArray() : nullptr;
+        const auto* loaded = restoredSlots != nullptr ? (*restoredSlots)[slot].getArray() : nullptr;
+
+        if (saved == nullptr || loaded == nullptr || saved->size() != loaded->size())
+        {
+            std::cerr << "Slot " << slot << " missing after the state round-trip" << std::endl;
+            ++slotMismatches;
+            continue;
+        }
+
+        for (int index = 0; index < saved->size(); ++index)
+        {
+            if (std::abs (static_cast<double> ((*saved)[index]) - static_cast<double> ((*loaded)[index])) > 1.0e-5)
+            {
+                std::cerr << "Slot " << slot << " value " << index << ": saved " << (*saved)[index].toString()
+                          << ", restored " << (*loaded)[index].toString() << std::endl;
+                ++slotMismatches;
+            }
+        }
+    }
+
+    std::cout << "slot_round_trip_mismatches: " << slotMismatches << std::endl;
+    return failures == 0 && slotMismatches == 0 ? 0 : 1;
+}
+
+// Two instances in one process, linked: the quiet one compresses as hard as its loud peer
+// while that peer is running, goes back to its own level once the peer has been silent
+// for longer than the link's stale time, and leaving the group frees its slot for a
+// third instance to take.
+int runLinkCheck (const ParsedOptions& options)
+{
+    juce::String error;
+    juce::File pluginFile;
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    int channels = 0;
+    std::vector<ParameterOverride> parameterOverrides;
+
+    if (! parseFileOption (options, "--plugin", pluginFile, error)
+        || ! parseDoubleOption (options, "--sr", sampleRate, error)
+        || ! parseIntOption (options, "--bs", blockSize, error)
+        || ! parseIntOption (options, "--ch", channels, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    if (const auto overridesText = options.getValue ("--set-params"); overridesText.has_value())
+    {
+        if (! parseParameterOverrides (*overridesText, parameterOverrides, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (blockSize <= 0 || channels <= 0)
+    {
+        std::cerr << "Block size and channels must be positive." << std::endl;
+        return 1;
+    }
+
+    const auto description = findPluginDescription (pluginFile, error);
+    if (! description.has_value())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const juce::String groupName ("link-check");
+
+    // Hooks act on the newest instance, so each joins right after it is created.
+    const auto createLinkedInstance = [&]() -> std::unique_ptr<juce::AudioPluginInstance>
+    {
+        auto plugin = createPluginInstance (*description, sampleRate, blockSize, error);
+
+        if (plugin == nullptr)
+        {
+            std::cerr << "Failed to instantiate plugin: " << error << std::endl;
+            return nullptr;
+        }
+
+        configurePlugin (*plugin, channels, sampleRate, blockSize);
+
+        if (! applyParameterOverrides (*plugin, parameterOverrides, error))
+        {
+            std::cerr << error << std::endl;
+            return nullptr;
+        }
+
+        if (! setPluginLinkGroup (pluginFile, groupName))
+        {
+            std::cerr << "Plugin does not export twoCCompressorSetLinkGroup (build it with TWOC_TEST_HOOKS)." << std::endl;
+            return nullptr;
+        }
+
+        return plugin;
+    };
+
+    auto loud = createLinkedInstance();
+    auto quiet = loud != nullptr ? createLinkedInstance() : nullptr;
+
+    if (quiet == nullptr)
+        return 1;
+
+    juce::AudioBuffer<float> ioBuffer (channels, blockSize);
+    juce::MidiBuffer midiBuffer;
+    juce::int64 tonePosition = 0;
+
+    // Processes one block of the tone at levelDb and returns the gain it was given in dB.
+    const auto processToneBlock = [&] (juce::AudioPluginInstance& plugin, float levelDb)
+    {
+        const auto toneGain = juce::Decibels::decibelsToGain (levelDb);
+
+        for (int sample = 0; sample < blockSize; ++sample)
+        {
+            const auto phase = juce::MathConstants<double>::twoPi * 1000.0 * static_cast<double> (tonePosition + sample) / sampleRate;
+
+            for (int ch = 0; ch < channels; ++ch)
+                ioBuffer.setSample (ch, sample, toneGain * static_cast<float> (std::sin (phase)));
+        }
+
+        const auto inputDb = computeRmsDb (ioBuffer, 0, blockSize, channels);
+        plugin.processBlock (ioBuffer, midiBuffer);
+        midiBuffer.clear();
+        return computeRmsDb (ioBuffer, 0, blockSize, channels) - inputDb;
+    };
+
+    constexpr float loudDb = 0.0f;
+    constexpr float quietDb = -40.0f;
+    constexpr float followToleranceDb = 3.0f;
+    constexpr float minimumLinkedDb = 6.0f;
+    constexpr int linkStaleAfterMs = 250; // LinkBus::staleAfterMs
+
+    // A second per phase is many attack and release times at any setting the test uses.
+    const auto blocksPerPhase = juce::jmax (16, static_cast<int> (std::ceil (sampleRate / blockSize)));
+    auto failures = 0;
+
+    auto loudGainDb = 0.0f;
+    auto linkedGainDb = 0.0f;
+
+    for (int block = 0; block < blocksPerPhase; ++block)
+    {
+        loudGainDb = processToneBlock (*loud, loudDb);
+        linkedGainDb = processToneBlock (*quiet, quietDb);
+        tonePosition += blockSize;
+    }
+
+    const auto linkedProbe = readPluginProbe (pluginFile);
+
+    if (! linkedProbe.has_value())
+    {
+        std::cerr << "Plugin has no probe to read the link slots through." << std::endl;
+        return 1;
+    }
+
+    const auto groupSize = static_cast<int> (linkedProbe->getProperty ("link_group_size", 0));
+    const auto quietSlot = static_cast<int> (linkedProbe->getProperty ("link_slot", -1));
+
+    std::cout << "linked: loud " << juce::String (loudGainDb, 2) << " dB, quiet " << juce::String (linkedGainDb, 2)
+              << " dB, group size " << groupSize << std::endl;
+
+    if (groupSize != 2 || quietSlot < 0)
+    {
+        std::cerr << "Both instances should be in the group, each with a slot" << std::endl;
+        ++failures;
+    }
+
+    if (std::abs (linkedGainDb - loudGainDb) > followToleranceDb || linkedGainDb > -minimumLinkedDb)
+    {
+        std::cerr << "The quiet instance should follow its louder peer's gain reduction" << std::endl;
+        ++failures;
+    }
+
+    // The loud peer stops; once its level is stale the quiet one follows its own again.
+    juce::Thread::sleep (2 * linkStaleAfterMs);
+
+    auto staleGainDb = 0.0f;
+
+    for (int block = 0; block < blocksPerPhase; ++block)
+    {
+        staleGainDb = processToneBlock (*quiet, quietDb);
+        tonePosition += blockSize;
+    }
+
+    std::cout << "stale peer: quiet " << juce::String (staleGainDb, 2) << " dB" << std::endl;
+
+    if (staleGainDb < linkedGainDb + minimumLinkedDb)
+    {
+        std::cerr << "The quiet instance still follows a peer that stopped" << std::endl;
+        ++failures;
+    }
+
+    // Leaving gives the slot back: the next instance to join takes it.
+    if (! setPluginLinkGroup (pluginFile, {}))
+    {
+        std::cerr << "Could not leave the link group." << std::endl;
+        return 1;
+    }
+
+    const auto leftProbe = readPluginProbe (pluginFile);
+    const auto slotAfterLeaving = leftProbe.has_value() ? static_cast<int> (leftProbe->getProperty ("link_slot", -1)) : 0;
+
+    auto third = createLinkedInstance();
+
+    if (third == nullptr)
+        return 1;
+
+    const auto thirdProbe = readPluginProbe (pluginFile);
+    const auto thirdSlot = thirdProbe.has_value() ? static_cast<int> (thirdProbe->getProperty ("link_slot", -1)) : -1;
+    const auto groupSizeAfter = thirdProbe.has_value() ? static_cast<int> (thirdProbe->getProperty ("link_group_size", 0)) : 0;
+
+    std::cout << "after leaving: slot " << slotAfterLeaving << ", new member took slot " << thirdSlot
+              << " (left " << quietSlot << "), group size " << groupSizeAfter << std::endl;
+
+    if (slotAfterLeaving != -1 || thirdSlot != quietSlot || groupSizeAfter != 2)
+    {
+        std::cerr << "Leaving the group should release the slot" << std::endl;
+        ++failures;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
+
+struct HostCallTrace
+{
+    int numParameters = 0;
+    int dropped = 0;
+    double ticksPerSecond = 0.0;
+    std::vector<HostCallTraceFormat::Record> records;
+};
+
+bool loadHostCallTrace (const juce::File& file, HostCallTrace& trace, juce::String& error)
+{
+    juce::FileInputStream stream (file);
+
+    if (! stream.openedOk())
+    {
+        error = "Failed to open trace: " + file.getFullPathName();
+        return false;
+    }
+
+    if (static_cast<juce::uint32> (stream.readInt()) != HostCallTraceFormat::magic
+        || static_cast<juce::uint16> (stream.readShort()) != HostCallTraceFormat::version
+        || static_cast<size_t> (stream.readShort()) != HostCallTraceFormat::recordBytes)
+    {
+        error = "Not a version " + juce::String (HostCallTraceFormat::version) + " host call trace: " + file.getFullPathName();
+        return false;
+    }
+
+    trace.numParameters = stream.readInt();
+    const auto count = stream.readInt();
+    trace.dropped = stream.readInt();
+    trace.ticksPerSecond = stream.readDouble();
+
+    if (count < 0 || stream.getNumBytesRemaining() < static_cast<juce::int64> (count) * static_cast<juce::int64> (HostCallTraceFormat::recordBytes))
+    {
+        error = "Truncated trace: " + file.getFullPathName();
+        return false;
+    }
+
+    trace.records.resize (static_cast<size_t> (count));
+
+    for (auto& record : trace.records)
+    {
+        record.type = static_cast<std::uint16_t> (stream.readShort());
+        record.flags = static_cast<std::uint16_t> (stream.readShort());
+        record.index = stream.readInt();
+        record.numSamples = stream.readInt();
+        record.value = stream.readFloat();
+        record.ticks = stream.readInt64();
+    }
+
+    return true;
+}
+
+struct ReplayedBlock
+{
+    int numSamples = 0;
+    double recordedUs = 0.0;
+    double replayUs = 0.0;
+    double budgetUs = 0.0;
+};
+
+// Re-drives a plugin with the exact call sequence a host made: same prepares, block
+// sizes and parameter changes in the same order.
+int runReplay (const ParsedOptions& options)
+{
+    juce::String error;
+    juce::File pluginFile;
+    juce::File traceFile;
+
+    if (! parseFileOption (options, "--plugin", pluginFile, error)
+        || ! parseFileOption (options, "--trace", traceFile, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    HostCallTrace trace;
+
+    if (! loadHostCallTrace (traceFile, trace, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const auto firstPrepare = std::find_if (trace.records.begin(), trace.records.end(),
+                                            [] (const auto& record) { return record.type == HostCallTraceFormat::prepare; });
+
+    if (firstPrepare == trace.records.end())
+    {
+        std::cerr << "Trace has no prepare call to start from." << std::endl;
+        return 1;
+    }
+
+    auto channels = juce::jmax (1, static_cast<int> (firstPrepare->index));
+    auto sampleRate = static_cast<double> (firstPrepare->value);
+    auto maxBlockSize = juce::jmax (1, static_cast<int> (firstPrepare->numSamples));
+    auto largestBlock = maxBlockSize;
+
+    for (const auto& record : trace.records)
+        if (record.type == HostCallTraceFormat::process || record.type == HostCallTraceFormat::prepare)
+            largestBlock = juce::jmax (largestBlock, static_cast<int> (record.numSamples));
+
+    juce::AudioBuffer<float> sourceBuffer;
+
+    if (options.getValue ("--in").has_value())
+    {
+        juce::File inputFile;
+        LoadedWave dryWave;
+
+        if (! parseFileOption (options, "--in", inputFile, error) || ! loadWaveFile (inputFile, dryWave, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+
+        sourceBuffer.setSize (channels, juce::jmax (largestBlock, dryWave.buffer.getNumSamples()));
+        sourceBuffer.clear();
+        copyWithChannelMatch (dryWave.buffer, sourceBuffer);
+    }
+    else
+    {
+        sourceBuffer.setSize (channels, juce::jmax (largestBlock, static_cast<int> (10.0 * sampleRate)));
+        fillBenchNoise (sourceBuffer);
+    }
+
+    const auto description = findPluginDescription (pluginFile, error);
+    if (! description.has_value())
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    auto plugin = createPluginInstance (*description, sampleRate, maxBlockSize, error);
+    if (plugin == nullptr)
+    {
+        std::cerr << "Failed to instantiate plugin: " << error << std::endl;
+        return 1;
+    }
+
+    const auto parameters = plugin->getParameters();
+
+    if (parameters.size() != trace.numParameters)
+        std::cerr << "Warning: trace has " << trace.numParameters << " parameters, plugin has " << parameters.size() << std::endl;
+
+    juce::AudioBuffer<float> ioBuffer (channels, largestBlock);
+    juce::MidiBuffer midiBuffer;
+    std::vector<ReplayedBlock> blocks;
+    auto sourcePosition = 0;
+    auto prepares = 0;
+    auto parameterChanges = 0;
+    auto prepared = false;
+
+    for (const auto& record : trace.records)
+    {
+        switch (record.type)
+        {
+            case HostCallTraceFormat::prepare:
+            {
+                channels = juce::jmax (1, static_cast<int> (record.index));
+                sampleRate = static_cast<double> (record.value);
+                maxBlockSize = juce::jmax (1, static_cast<int> (record.numSamples));
+                configurePlugin (*plugin, channels, sampleRate, maxBlockSize);
+                ioBuffer.setSize (channels, largestBlock, false, false, true);
+                prepared = true;
+                ++prepares;
+                break;
+            }
+
+            case HostCallTraceFormat::release:
+                plugin->releaseResources();
+                prepared = false;
+                break;
+
+            case HostCallTraceFormat::reset:
+                plugin->reset();
+                break;
+
+            case HostCallTraceFormat::parameter:
+                if (juce::isPositiveAndBelow (static_cast<int> (record.index), parameters.size()))
+                {
+                    parameters[record.index]->setValueNotifyingHost (record.value);
+                    ++parameterChanges;
+                }
+                break;
+
+            case HostCallTraceFormat::process:
+            {
+                const auto numSamples = juce::jlimit (0, largestBlock, static_cast<int> (record.numSamples));
+
+                if (! prepared || numSamples <= 0)
+                    break;
+
+                if (sourcePosition + numSamples > sourceBuffer.getNumSamples())
+                    sourcePosition = 0;
+
+                juce::AudioBuffer<float> block (ioBuffer.getArrayOfWritePointers(), channels, numSamples);
+
+                for (int ch = 0; ch < channels; ++ch)
+                    block.copyFrom (ch, 0, sourceBuffer, juce::jmin (ch, sourceBuffer.getNumChannels() - 1), sourcePosition, numSamples);
+
+                sourcePosition += numSamples;
+                plugin->setNonRealtime ((record.flags & HostCallTraceFormat::nonRealtime) != 0);
+                midiBuffer.clear();
+
+                const auto startTicks = juce::Time::getHighResolutionTicks();
+
+                if ((record.flags & HostCallTraceFormat::bypassedCall) != 0)
+                    plugin->processBlockBypassed (block, midiBuffer);
+                else
+                    plugin->processBlock (block, midiBuffer);
+
+                const auto endTicks = juce::Time::getHighResolutionTicks();
+
+                blocks.push_back ({ numSamples,
+                                    static_cast<double> (record.value),
+                                    ticksToMicroseconds (endTicks - startTicks),
+                                    1.0e6 * static_cast<double> (numSamples) / sampleRate });
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    const auto probe = prepared ? readPluginProbe (pluginFile) : std::nullopt;
+
+    if (prepared)
+        plugin->releaseResources();
+
+    std::vector<double> replayUs;
+    std::vector<double> recordedUs;
+    auto overBudget = 0;
+    auto worstLoad = 0.0;
+    auto worstLoadBlock = -1;
+
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        const auto& block = blocks[i];
+        replayUs.push_back (block.replayUs);
+        recordedUs.push_back (block.recordedUs);
+
+        if (block.replayUs > block.budgetUs)
+            ++overBudget;
+
+        // Block sizes vary, so the worst block is the one using the largest share of its own budget.
+        if (const auto load = block.replayUs / block.budgetUs; load > worstLoad)
+        {
+            worstLoad = load;
+            worstLoadBlock = static_cast<int> (i);
+        }
+    }
+
+    std::cout << "trace_records : " << trace.records.size() << " (" << trace.dropped << " dropped while recording)\n"
+              << "prepares      : " << prepares << "\n"
+              << "param_changes : " << parameterChanges << std::endl;
+
+    printTimingPhase ("recorded", recordedUs);
+    printTimingPhase ("replay", replayUs);
+
+    const auto replayStats = summariseBlockTimes (replayUs, 0.0);
+    std::cout << "blocks        : " << replayStats.blocks << "\n"
+              << "p99_us        : " << juce::String (replayStats.p99Us, 2) << "\n"
+              << "over_budget   : " << overBudget << std::endl;
+
+    if (worstLoadBlock >= 0)
+    {
+        const auto& worst = blocks[static_cast<size_t> (worstLoadBlock)];
+        std::cout << "worst_block   : " << worstLoadBlock << " (" << worst.numSamples << " samples, "
+                  << juce::String (worst.replayUs, 2) << " us replayed, "
+                  << juce::String (worst.recordedUs, 2) << " us recorded, "
+                  << juce::String (100.0 * worstLoad, 1) << "% of budget)" << std::endl;
+    }
+
+    if (probe.has_value())
+    {
+        printLoudness (*probe);
+        printStageProfile (*probe);
+    }
+
+    if (const auto csvPath = options.getValue ("--csv"); csvPath.has_value())
+    {
+        juce::String text ("block,num_samples,recorded_us,replay_us,budget_us\n");
+        text.preallocateBytes (blocks.size() * 40);
+
+        for (size_t i = 0; i < blocks.size(); ++i)
+            text << juce::String (static_cast<int> (i)) << "," << blocks[i].numSamples << ","
+                 << juce::String (blocks[i].recordedUs, 3) << "," << juce::String (blocks[i].replayUs, 3) << ","
+                 << juce::String (blocks[i].budgetUs, 3) << "\n";
+
+        const auto csvFile = resolvePath (*csvPath);
+
+        if (! csvFile.replaceWithText (text))
+        {
+            std::cerr << "Failed to write CSV: " << csvFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Read-only view of the shared telemetry segment the plugin instances publish into.
+class TelemetryView
+{
+public:
+    TelemetryView()
+    {
+       #if TWOC_HARNESS_TELEMETRY
+        const auto fd = ::shm_open (TelemetryFormat::segmentName, O_RDONLY, 0);
+
+        if (fd < 0)
+            return;
+
+        auto* address = ::mmap (nullptr, TelemetryFormat::segmentBytes, PROT_READ, MAP_SHARED, fd, 0);
+        ::close (fd);
+
+        if (address == MAP_FAILED)
+            return;
+
+        const auto* header = static_cast<const TelemetryFormat::Header*> (address);
+
+        if (header->magic.load (std::memory_order_acquire) != TelemetryFormat::magic
+            || header->version.load (std::memory_order_relaxed) != TelemetryFormat::version
+            || header->slotBytes.load (std::memory_order_relaxed) != sizeof (TelemetryFormat::Slot))
+        {
+            ::munmap (address, TelemetryFormat::segmentBytes);
+            return;
+        }
+
+        mapping = address;
+       #endif
+    }
+
+    ~TelemetryView()
+    {
+       #if TWOC_HARNESS_TELEMETRY
+        if (mapping != nullptr)
+            ::munmap (mapping, TelemetryFormat::segmentBytes);
+       #endif
+    }
+
+    bool isOpen() const noexcept { return mapping != nullptr; }
+
+    const TelemetryFormat::Slot* getSlots() const noexcept { return TelemetryFormat::getSlots (static_cast<const void*> (mapping)); }
+
+private:
+    void* mapping = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE (TelemetryView)
+};
+
+struct TelemetryRow
+{
+    std::uint32_t pid = 0;
+    TelemetryFormat::Sample sample;
+    std::int64_t ageMs = 0;
+};
+
+// An instance that has not published for this long is no longer being processed.
+constexpr std::int64_t telemetryStalledMs = 2000;
+
+juce::String describeTelemetryState (const TelemetryRow& row)
+{
+    if (row.sample.blocks == 0)
+        return "unprepared";
+
+    if (row.ageMs > telemetryStalledMs)
+        return "stalled";
+
+    juce::StringArray state;
+
+    if ((row.sample.flags & TelemetryFormat::bypassed) != 0)
+        state.add ("bypassed");
+
+    if ((row.sample.flags & TelemetryFormat::silent) != 0)
+        state.add ("silent");
+
+    if ((row.sample.flags & TelemetryFormat::eco) != 0)
+        state.add ("eco");
+
+    return state.isEmpty() ? juce::String ("active") : state.joinIntoString ("+");
+}
+
+int runTop (const ParsedOptions& options)
+{
+    juce::String error;
+    auto count = 0;
+    auto intervalMs = 1000;
+    const auto sortKey = options.getValue ("--sort").value_or ("cpu");
+
+    if ((options.getValue ("--count").has_value() && ! parseIntOption (options, "--count", count, error))
+        || (options.getValue ("--interval").has_value() && ! parseIntOption (options, "--interval", intervalMs, error)))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    if (sortKey != "cpu" && sortKey != "gr" && sortKey != "id")
+    {
+        std::cerr << "--sort must be cpu, gr or id" << std::endl;
+        return 1;
+    }
+
+   #if ! TWOC_HARNESS_TELEMETRY
+    juce::ignoreUnused (count, intervalMs);
+    std::cerr << "top needs POSIX shared memory, which this platform does not have" << std::endl;
+    return 1;
+   #else
+    const TelemetryView view;
+
+    if (! view.isOpen())
+    {
+        std::cerr << "No telemetry segment (" << TelemetryFormat::segmentName << "); no instance has published yet (telemetry needs TWOC_TELEMETRY=1 in the host's environment)" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<juce::FileOutputStream> csv;
+
+    if (const auto csvPath = options.getValue ("--csv"); csvPath.has_value())
+    {
+        const auto csvFile = resolvePath (*csvPath);
+        csvFile.deleteFile();
+        csv = std::make_unique<juce::FileOutputStream> (csvFile);
+
+        if (csv->failedToOpen())
+        {
+            std::cerr << "Failed to write CSV: " << csvFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        csv->writeText ("time_ms,pid,instance,sample_rate,block_size,cpu_us,cpu_load,gr_db,input_db,output_db,os_mode,flags,blocks,age_ms\n", false, false, nullptr);
+    }
+
+    // Without --count, refresh until interrupted.
+    const auto live = count <= 0;
+    std::vector<TelemetryRow> rows;
+    rows.reserve (TelemetryFormat::numSlots);
+
+    for (auto refresh = 0; live || refresh < count; ++refresh)
+    {
+        if (refresh > 0)
+            juce::Thread::sleep (juce::jmax (10, intervalMs));
+
+        const auto nowMs = juce::Time::currentTimeMillis();
+        rows.clear();
+
+        for (std::uint32_t index = 0; index < TelemetryFormat::numSlots; ++index)
+        {
+            TelemetryRow row;
+
+            if (TelemetryFormat::read (view.getSlots()[index], row.sample, row.pid))
+            {
+                row.ageMs = nowMs - row.sample.updatedMs;
+                rows.push_back (row);
+            }
+        }
+
+        std::sort (rows.begin(), rows.end(), [&sortKey] (const TelemetryRow& a, const TelemetryRow& b)
+        {
+            if (sortKey == "gr")
+                return a.sample.gainReductionDb > b.sample.gainReductionDb;
+
+            if (sortKey == "id")
+                return a.pid != b.pid ? a.pid < b.pid : a.sample.instanceId < b.sample.instanceId;
+
+            return a.sample.cpuLoad > b.sample.cpuLoad;
+        });
+
+        auto active = 0;
+        auto silent = 0;
+        auto stalled = 0;
+        auto totalLoad = 0.0;
+
+        for (const auto& row : rows)
+        {
+            if (row.sample.blocks == 0 || row.ageMs > telemetryStalledMs)
+            {
+                ++stalled;
+                continue;
+            }
+
+            totalLoad += row.sample.cpuLoad;
+
+            if ((row.sample.flags & TelemetryFormat::silent) != 0)
+                ++silent;
+            else
+                ++active;
+        }
+
+        if (live)
+            std::cout << "\x1b[2J\x1b[H";
+
+        std::cout << "instances: " << rows.size() << " (" << active << " active, " << silent << " silent, "
+                  << stalled << " stalled or unprepared), summed load " << juce::String (100.0 * totalLoad, 1) << "%\n"
+                  << "     pid   id      sr    bs   cpu_us  load%   gr_db   in_db  out_db  os  state" << std::endl;
+
+        for (const auto& row : rows)
+        {
+            const auto& sample = row.sample;
+            std::cout << juce::String (static_cast<int> (row.pid)).paddedLeft (' ', 8)
+                      << juce::String (sample.instanceId).paddedLeft (' ', 5)
+                      << juce::String (static_cast<int> (sample.sampleRate)).paddedLeft (' ', 8)
+                      << juce::String (sample.blockSize).paddedLeft (' ', 6)
+                      << juce::String (sample.cpuUs, 1).paddedLeft (' ', 9)
+                      << juce::String (100.0f * sample.cpuLoad, 1).paddedLeft (' ', 7)
+                      << juce::String (sample.gainReductionDb, 1).paddedLeft (' ', 8)
+                      << juce::String (sample.inputDb, 1).paddedLeft (' ', 8)
+                      << juce::String (sample.outputDb, 1).paddedLeft (' ', 8)
+                      << (sample.osMode == 0 ? juce::String ("-") : juce::String (1 << sample.osMode) + "x").paddedLeft (' ', 4)
+                      << "  " << describeTelemetryState (row) << "\n";
+
+            if (csv != nullptr)
+                csv->writeText (juce::String (nowMs) + "," + juce::String (static_cast<juce::int64> (row.pid)) + "," + juce::String (sample.instanceId) + ","
+                                    + juce::String (sample.sampleRate, 0) + "," + juce::String (sample.blockSize) + ","
+                                    + juce::String (sample.cpuUs, 3) + "," + juce::String (sample.cpuLoad, 5) + ","
+                                    + juce::String (sample.gainReductionDb, 2) + "," + juce::String (sample.inputDb, 2) + ","
+                                    + juce::String (sample.outputDb, 2) + "," + juce::String (sample.osMode) + ","
+                                    + juce::String (static_cast<juce::int64> (sample.flags)) + ","
+                                    + juce::String (static_cast<juce::int64> (sample.blocks)) + "," + juce::String (row.ageMs) + "\n",
+                                false, false, nullptr);
+        }
+
+        std::cout << std::flush;
+
+        if (csv != nullptr)
+            csv->flush();
+    }
+
+    return 0;
+   #endif
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add (juce::String::fromUTF8 (argv[i]));
+
+    if (args.isEmpty() || args[0] == "--help" || args[0] == "-h")
+    {
+        printUsage();
+        return 0;
+    }
+
+    const auto command = args[0];
+    const auto options = parseOptions (args, 1);
+
+    if (options.error.isNotEmpty())
+    {
+        std::cerr << options.error << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    if (command == "dump-params")
+        return runDumpParams (options);
+
+    if (command == "render")
+        return runRender (options);
+
+    if (command == "analyze")
+        return runAnalyze (options);
+
+    if (command == "bench")
+        return runBench (options);
+
+    if (command == "prepare-bench")
+        return runPrepareBench (options);
+
+    if (command == "state-bench")
+        return runStateBench (options);
+
+    if (command == "preset-check")
+        return runPresetCheck (options);
+
+    if (command == "link-check")
+        return runLinkCheck (options);
+
+    if (command == "replay")
+        return runReplay (options);
+
+    if (command == "top")
+        return runTop (options);
 
     std::cerr << "Unknown command: " << command << std::endl;
     printUsage();